@@ -100,6 +100,104 @@ declare os: {
     clock: () -> number,
 }
 
+type MemoryStats = {
+    category: number,
+    name: string?,
+    bytes: number,
+    peak: number,
+    allocated: number,
+    rate: number,
+    softlimit: number,
+    hardlimit: number,
+    over: boolean,
+}
+
+type GCHistogram = {
+    count: number,
+    total: number,
+    max: number,
+    p50: number,
+    p90: number,
+    p99: number,
+}
+
+type GCMetrics = {
+    mark: GCHistogram,
+    atomic: GCHistogram,
+    sweep: GCHistogram,
+    minor: GCHistogram,
+    assist: GCHistogram,
+    explicit: GCHistogram,
+    heapgoal: GCHistogram,
+    assistwork: number,
+    explicitwork: number,
+    cycles: number,
+    goal: number,
+    bytes: number,
+}
+
+type GCPaceStats = {
+    ticks: number,
+    worked: number,
+    deferred: number,
+    overruns: number,
+    fallbacks: number,
+    lasttime: number,
+    maxtime: number,
+    required: number,
+}
+
+type ThreadPoolStats = {
+    created: number,
+    reused: number,
+    dropped: number,
+    pooled: number,
+    bytes: number,
+}
+
+declare memory: {
+    stats: ((category: number | string) -> MemoryStats) & (() -> { MemoryStats }),
+    category: (string) -> number?,
+    setlimit: (number | string, number?, number?) -> (),
+    snapshot: (string?) -> number,
+    gcmetrics: () -> GCMetrics,
+    resetgcmetrics: () -> (),
+    gcpace: (number, number?) -> (),
+    gctick: () -> (),
+    gcpacestats: () -> GCPaceStats,
+    threadpool: (number, number) -> (),
+    threadpoolstats: () -> ThreadPoolStats,
+}
+
+declare class buffer end
+
+declare buffer: {
+    create: (number) -> buffer,
+    fromstring: (string) -> buffer,
+    tostring: (buffer) -> string,
+    len: (buffer) -> number,
+    readi8: (buffer, number) -> number,
+    readu8: (buffer, number) -> number,
+    readi16: (buffer, number) -> number,
+    readu16: (buffer, number) -> number,
+    readi32: (buffer, number) -> number,
+    readu32: (buffer, number) -> number,
+    readf32: (buffer, number) -> number,
+    readf64: (buffer, number) -> number,
+    writei8: (buffer, number, number) -> (),
+    writeu8: (buffer, number, number) -> (),
+    writei16: (buffer, number, number) -> (),
+    writeu16: (buffer, number, number) -> (),
+    writei32: (buffer, number, number) -> (),
+    writeu32: (buffer, number, number) -> (),
+    writef32: (buffer, number, number) -> (),
+    writef64: (buffer, number, number) -> (),
+    readstring: (buffer, number, number) -> string,
+    writestring: (buffer, number, string, number?) -> (),
+    copy: (buffer, number, buffer, number?, number?) -> (),
+    fill: (buffer, number, number, number?) -> (),
+}
+
 declare function require(target: any): any
 
 declare function getfenv(target: any): { [string]: any }
@@ -108,6 +206,7 @@ declare _G: any
 declare _VERSION: string
 
 declare function gcinfo(): number
+declare function scratch<A..., R...>(f: (A...) -> R..., ...: A...): R...
 
 declare function print<T...>(...: T...)
 
@@ -160,9 +160,9 @@ namespace Luau {
         functionStack.reserve(8);
         functionStack.push_back(top);
 
-        nameSelf = names.addStatic("self");
-        nameNumber = names.addStatic("number");
-        nameError = names.addStatic(kParseNameError);
+        nameSelf = names.getOrAdd("self");
+        nameNumber = names.getOrAdd("number");
+        nameError = names.getOrAdd(kParseNameError);
         nameNil = names.getOrAdd("nil"); // nil is a reserved keyword
 
         matchRecoveryStopOnToken.assign(Lexeme::Type::Reserved_END, 0);
@@ -36,6 +36,37 @@
 //
 // Note that Luau runtime doesn't provide indefinite bytecode compatibility: support for older versions gets removed over time. As such, bytecode isn't a durable storage format and it's expected
 // that Luau users can recompile bytecode from source on Luau version upgrades if necessary.
+//
+// Version 3 aligns the instructions of each function to 4 bytes relative to the start of the bytecode and serializes inline caches separately (see
+// below); version 2 isn't supported by the runtime anymore.
+//
+// Version 4 adds memory categories: the string table is followed by the number of categories and a string reference with the name of each
+// category, and the header of each function is followed by a byte with the category (1-based, 0 for none) of the code that the function runs.
+// The compiler only emits it for programs that link modules, see # Memory categories.
+
+// # Inline caches
+// GETGLOBAL, SETGLOBAL, GETTABLEKS, SETTABLEKS, NAMECALL and GETTABLEKS_NAMECALL cache the hash slot of their key. The compiler predicts the slot based on
+// the hash of the key and places it into C; when serializing, C is replaced with an index into the inline cache array of the function, which follows the
+// instructions and holds the predicted slots. The runtime updates the array instead of the instructions, so bytecode can be executed in place from
+// read-only memory. Functions with more than 256 such instructions share the last cache entry between the rest of them.
+
+// # Compressed bytecode
+// Bytecode can be wrapped into a compressed container, which starts with LBC_COMPRESSED instead of the version byte, followed by the log2 of the window
+// size (a byte, LBC_COMPRESSED_WINDOWLOG_MIN..LBC_COMPRESSED_WINDOWLOG_MAX), the size of the bytecode (a varint) and the bytecode in LZ4 block format.
+// Matches never refer further back than the window size, so the runtime decodes the container as a stream while loading it and only keeps the window.
+
+// # Debug info sidecar
+// Line info and function names can be stripped from bytecode into a text sidecar that stays on the host (see BytecodeBuilder::setStripDebugInfo).
+// Errors in functions without line info then report @hash/id/pc instead of a line, where hash is the 32-bit FNV-1a hash of the bytecode as passed to
+// luau_load (compressed or not) in hex, id is the index of the function in the bytecode and pc is the index of the instruction. The sidecar is
+// a 'luau-debug 1 <hash> <source>' header followed by one 'f <id> <linedefined> <name> <count> <line>...' record per function, with a line for
+// each instruction word and '-' for anonymous functions.
+
+// # Memory categories
+// compileProgramOrThrow assigns a category to each linked module, named after the module. Objects created while a function of the module runs,
+// including the objects created by the library functions it calls, are attributed to the category; the runtime maps the names to categories
+// that are shared by all chunks loaded into the VM (see lua_getmemcatstats). Module bodies run as part of the main function, so the objects
+// they create are attributed to the category of the main function; functions that may create objects aren't inlined into other modules.
 
 // Bytecode opcode, part of the instruction header
 enum LuauOpcode {
@@ -72,13 +103,13 @@ enum LuauOpcode {
 
     // GETGLOBAL: load value from global table using constant string as a key
     // A: target register
-    // C: predicted slot index (based on hash)
+    // C: predicted slot index (based on hash); inline cache index in serialized bytecode
     // AUX: constant table index
     LOP_GETGLOBAL,
 
     // SETGLOBAL: set value in global table using constant string as a key
     // A: source register
-    // C: predicted slot index (based on hash)
+    // C: predicted slot index (based on hash); inline cache index in serialized bytecode
     // AUX: constant table index
     LOP_SETGLOBAL,
 
@@ -117,14 +148,14 @@ enum LuauOpcode {
     // GETTABLEKS: load value from table into target register using constant string as a key
     // A: target register
     // B: table register
-    // C: predicted slot index (based on hash)
+    // C: predicted slot index (based on hash); inline cache index in serialized bytecode
     // AUX: constant table index
     LOP_GETTABLEKS,
 
     // SETTABLEKS: store source register into table using constant string as a key
     // A: source register
     // B: table register
-    // C: predicted slot index (based on hash)
+    // C: predicted slot index (based on hash); inline cache index in serialized bytecode
     // AUX: constant table index
     LOP_SETTABLEKS,
 
@@ -148,7 +179,7 @@ enum LuauOpcode {
     // NAMECALL: prepare to call specified method by name by loading function from source register using constant index into target register and copying source register into target register + 1
     // A: target register
     // B: source register
-    // C: predicted slot index (based on hash)
+    // C: predicted slot index (based on hash); inline cache index in serialized bytecode
     // AUX: constant table index
     // Note that this instruction must be followed directly by CALL; it prepares the arguments
     // This instruction is roughly equivalent to GETTABLEKS + MOVE pair, but we need a special instruction to support custom __namecall metamethod
@@ -366,6 +397,53 @@ enum LuauOpcode {
     // D: jump offset (-32768..32767)
     LOP_FORGPREP,
 
+    // ADDN, SUBN, MULN, DIVN: compute arithmetic operation between two source registers and put the result into target register
+    // the compiler emits these when both operands are known to be numbers from type annotations; the VM checks this with a single branch
+    // and permanently replaces the instruction with its generic version (ADD, SUB, MUL, DIV) when the operands turn out to be of a different type
+    // A: target register
+    // B: source register 1
+    // C: source register 2
+    LOP_ADDN,
+    LOP_SUBN,
+    LOP_MULN,
+    LOP_DIVN,
+
+    // JUMPIFLEN, JUMPIFLTN, JUMPIFNOTLEN, JUMPIFNOTLTN: jumps to target offset if the comparison is true (or false, for NOT variants)
+    // the compiler emits these when both operands are known to be numbers; deoptimizes to JUMPIFLE etc. like ADDN
+    // A: source register 1
+    // D: jump offset (-32768..32767; 0 means "next instruction" aka "don't jump")
+    // AUX: source register 2
+    LOP_JUMPIFLEN,
+    LOP_JUMPIFLTN,
+    LOP_JUMPIFNOTLEN,
+    LOP_JUMPIFNOTLTN,
+
+    // Superinstructions: pairs of instructions fused by BytecodeBuilder::fuseInstructions
+    // the fused opcode replaces the opcode of the first instruction; both instructions keep their arguments and AUX words, so the
+    // second instruction remains valid on its own (e.g. as a jump target). The VM executes the first instruction and proceeds
+    // to the second one without going through dispatch.
+    // LOADN_*: LOADN followed by JUMPIFLT, JUMPIFLE, JUMPIFNOTLT, JUMPIFNOTLE or NAMECALL
+    LOP_LOADN_JUMPIFLT,
+    LOP_LOADN_JUMPIFLE,
+    LOP_LOADN_JUMPIFNOTLT,
+    LOP_LOADN_JUMPIFNOTLE,
+    LOP_LOADN_NAMECALL,
+
+    // GETTABLEKS_NAMECALL: GETTABLEKS followed by NAMECALL (which is always followed by CALL)
+    LOP_GETTABLEKS_NAMECALL,
+
+    // GETIMPORT_CALL: GETIMPORT followed by CALL
+    LOP_GETIMPORT_CALL,
+
+    // JUMPTABLE: jumps to the target of the table entry that matches the source register, or past the table if there's no match
+    // the table is made of B JUMPIFEQK instructions that follow JUMPTABLE; entries that can't match compare with nil and jump past the table.
+    // Since the entries are regular instructions, running them in order is equivalent to the table lookup; B=0 disables the lookup.
+    // A: source register
+    // B: number of entries
+    // C: 0 when entry i has integer key AUX+i, 1 when entry i has a string key with (hash >> AUX) & (B - 1) == i; B is a power of two
+    // AUX: smallest integer key or hash shift
+    LOP_JUMPTABLE,
+
     // Enum entry for number of opcodes, not a valid opcode by itself!
     LOP__COUNT
 };
@@ -388,9 +466,13 @@ enum LuauOpcode {
 // Bytecode tags, used internally for bytecode encoded as a string
 enum LuauBytecodeTag {
     // Bytecode version; runtime supports [MIN, MAX], compiler emits TARGET by default but may emit a higher version when flags are enabled
-    LBC_VERSION_MIN = 2,
-    LBC_VERSION_MAX = 2,
-    LBC_VERSION_TARGET = 2,
+    LBC_VERSION_MIN = 3,
+    LBC_VERSION_MAX = 4,
+    LBC_VERSION_TARGET = 3,
+    // Compressed bytecode container marker, see # Compressed bytecode; it's never a valid version since versions are 7-bit
+    LBC_COMPRESSED = 0xff,
+    LBC_COMPRESSED_WINDOWLOG_MIN = 8,
+    LBC_COMPRESSED_WINDOWLOG_MAX = 16,
     // Types of constant table entries
     LBC_CONSTANT_NIL = 0,
     LBC_CONSTANT_BOOLEAN,
@@ -490,6 +572,21 @@ enum LuauBuiltinFunction {
 
     // rawlen
     LBF_RAWLEN,
+
+    // buffer.read*/write*; signed and unsigned writes of the same width are the same function
+    LBF_BUFFER_READI8,
+    LBF_BUFFER_READU8,
+    LBF_BUFFER_WRITEU8,
+    LBF_BUFFER_READI16,
+    LBF_BUFFER_READU16,
+    LBF_BUFFER_WRITEU16,
+    LBF_BUFFER_READI32,
+    LBF_BUFFER_READU32,
+    LBF_BUFFER_WRITEU32,
+    LBF_BUFFER_READF32,
+    LBF_BUFFER_WRITEF32,
+    LBF_BUFFER_READF64,
+    LBF_BUFFER_WRITEF64,
 };
 
 // Capture type, used in LOP_CAPTURE
@@ -44,6 +44,12 @@ public:
         bool operator==(const TableShape& other) const;
     };
 
+    // static frequencies of adjacent opcode pairs, counted by fuseInstructions before fusion; used to pick the pairs worth fusing
+    struct OpcodePairHistogram
+    {
+        uint32_t counts[LOP__COUNT][LOP__COUNT] = {};
+    };
+
     BytecodeBuilder(BytecodeEncoder* encoder = 0);
 
     uint32_t beginFunction(uint8_t numparams, bool isvararg = false);
@@ -51,6 +57,10 @@ public:
 
     void setMainFunction(uint32_t fid);
 
+    // memory categories are numbered from 1 and have to be added before the first function; see # Memory categories in Bytecode.h
+    uint8_t addMemoryCategory(StringRef name);
+    void setFunctionMemoryCategory(uint8_t category);
+
     int32_t addConstantNil();
     int32_t addConstantBoolean(bool value);
     int32_t addConstantNumber(double value);
@@ -73,6 +83,7 @@ public:
 
     void foldJumps();
     void expandJumps();
+    void fuseInstructions();
 
     void setDebugFunctionName(StringRef name);
     void setDebugFunctionLineDefined(int line);
@@ -102,6 +113,17 @@ public:
 
     void setDumpSource(const std::string& source);
 
+    void setOpcodePairHistogram(OpcodePairHistogram* histogram)
+    {
+        opcodePairs = histogram;
+    }
+
+    // moves line info and function names out of the bytecode into the sidecar returned by getDebugSidecar; names of locals and upvalues are dropped
+    void setStripDebugInfo(bool enabled)
+    {
+        stripDebugInfo = enabled;
+    }
+
     const std::string& getBytecode() const
     {
         LUAU_ASSERT(!bytecode.empty()); // did you forget to call finalize?
@@ -117,8 +139,20 @@ public:
 
     static uint32_t getStringHash(StringRef key);
 
+    static std::string dumpOpcodePairs(const OpcodePairHistogram& histogram, size_t top);
+
     static std::string getError(const std::string& message);
 
+    // wraps bytecode into a compressed container that the runtime decodes while loading it, keeping only 1 << windowLog bytes of the
+    // decoded bytecode at a time; see # Compressed bytecode in Bytecode.h
+    static std::string compress(const std::string& bytecode, int windowLog = 12);
+
+    // returns the debug info stripped from the bytecode, keyed by the hash of the image that is loaded (which may be the compressed bytecode);
+    // see # Debug info sidecar in Bytecode.h
+    std::string getDebugSidecar(const std::string& image, const std::string& source) const;
+
+    static uint32_t getImageHash(const std::string& image);
+
     static uint8_t getVersion();
 
 private:
@@ -162,11 +196,13 @@ private:
     struct Function
     {
         std::string data;
+        size_t codeoffset = 0; // offset of the instructions in data; finalize pads the blob in front of them to align them to 4 bytes
 
         uint8_t maxstacksize = 0;
         uint8_t numparams = 0;
         uint8_t numupvalues = 0;
         bool isvararg = false;
+        uint8_t memcat = 0;
 
         unsigned int debugname = 0;
         int debuglinedefined = 0;
@@ -222,6 +258,8 @@ private:
 
     std::vector<TableShape> tableShapes;
 
+    std::vector<unsigned int> memoryCategories; // string table entries with the names of the categories
+
     bool hasLongJumps = false;
 
     DenseHashMap<ConstantKey, int32_t, ConstantKeyHash> constantMap;
@@ -246,13 +284,19 @@ private:
 
     std::string (BytecodeBuilder::*dumpFunctionPtr)() const = nullptr;
 
+    OpcodePairHistogram* opcodePairs = nullptr;
+
+    bool stripDebugInfo = false;
+    std::string debugSidecar;
+
     void validate() const;
 
     std::string dumpCurrentFunction() const;
     void dumpInstruction(const uint32_t* opcode, std::string& output, int targetLabel) const;
 
-    void writeFunction(std::string& ss, uint32_t id) const;
+    void writeFunction(std::string& ss, uint32_t id, size_t& codeoffset) const;
     void writeLineInfo(std::string& ss) const;
+    void writeDebugSidecar(std::string& ss, uint32_t id) const;
     void writeStringTable(std::string& ss) const;
 
     int32_t addConstant(const ConstantKey& key, const Constant& value);
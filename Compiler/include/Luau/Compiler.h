@@ -6,6 +6,9 @@
 #include "Luau/StringUtils.h"
 #include "Luau/Common.h"
 
+#include <optional>
+#include <string>
+
 namespace Luau
 {
 class AstNameTable;
@@ -13,6 +16,22 @@ struct ParseResult;
 class BytecodeBuilder;
 class BytecodeEncoder;
 
+// Note: this structure is duplicated in luacode.h, don't forget to change these in sync!
+struct CompileConstant
+{
+    // dotted path of a global, e.g. "config.drive.ratio"; reads of this exact path are replaced with the value
+    const char* name;
+
+    // 0 - nil
+    // 1 - boolean (valueNumber != 0)
+    // 2 - number (valueNumber)
+    // 3 - string (valueString, null-terminated)
+    int type;
+
+    double valueNumber;
+    const char* valueString;
+};
+
 // Note: this structure is duplicated in luacode.h, don't forget to change these in sync!
 struct CompileOptions
 {
@@ -37,6 +56,11 @@ struct CompileOptions
 
     // null-terminated array of globals that are mutable; disables the import optimization for fields accessed through these
     const char** mutableGlobals = nullptr;
+
+    // array of globals with values known at compile time, terminated by an entry with a null name; enables constant folding through these
+    // note: the paths are assumed to be read-only, writes to them are not tracked; reads that can't be folded, like indexing config with a
+    // variable, see frozen tables that the main chunk creates from these values
+    const CompileConstant* constantGlobals = nullptr;
 };
 
 class CompileError : public std::exception
@@ -61,6 +85,22 @@ private:
 void compileOrThrow(BytecodeBuilder& bytecode, const ParseResult& parseResult, const AstNameTable& names, const CompileOptions& options = {});
 void compileOrThrow(BytecodeBuilder& bytecode, const std::string& source, const CompileOptions& options = {}, const ParseOptions& parseOptions = {});
 
+// resolves modules for whole-program compilation
+struct CompileModuleResolver
+{
+    virtual ~CompileModuleResolver() {}
+
+    // returns the source of the module loaded with require(name)
+    virtual std::optional<std::string> readModule(const std::string& name) = 0;
+};
+
+// compiles source together with all modules it loads through top-level local x = require("name") statements into a single chunk; throws on errors
+// module bodies run once, in dependency order, before the source; on optimization level 2 this allows inlining of functions exported by modules
+// note: line information of module code refers to the lines in the module source
+// objects created by functions of a module are attributed to a memory category named after the module, see # Memory categories in Bytecode.h
+void compileProgramOrThrow(BytecodeBuilder& bytecode, const std::string& source, CompileModuleResolver& resolver, const CompileOptions& options = {},
+    const ParseOptions& parseOptions = {});
+
 // compiles bytecode into a bytecode blob, that either contains the valid bytecode or an encoded error that luau_load can decode
 std::string compile(
     const std::string& source, const CompileOptions& options = {}, const ParseOptions& parseOptions = {}, BytecodeEncoder* encoder = nullptr);
@@ -9,6 +9,22 @@
 #endif
 
 typedef struct lua_CompileOptions lua_CompileOptions;
+typedef struct lua_CompileConstant lua_CompileConstant;
+
+struct lua_CompileConstant
+{
+    // dotted path of a global, e.g. "config.drive.ratio"; reads of this exact path are replaced with the value
+    const char* name;
+
+    // 0 - nil
+    // 1 - boolean (valueNumber != 0)
+    // 2 - number (valueNumber)
+    // 3 - string (valueString, null-terminated)
+    int type;
+
+    double valueNumber;
+    const char* valueString;
+};
 
 struct lua_CompileOptions
 {
@@ -33,6 +49,11 @@ struct lua_CompileOptions
 
     // null-terminated array of globals that are mutable; disables the import optimization for fields accessed through these
     const char** mutableGlobals;
+
+    // array of globals with values known at compile time, terminated by an entry with a null name; enables constant folding through these
+    // note: the paths are assumed to be read-only, writes to them are not tracked; reads that can't be folded, like indexing config with a
+    // variable, see frozen tables that the main chunk creates from these values
+    const lua_CompileConstant* constantGlobals;
 };
 
 /* compile source to bytecode; when source compilation fails, the resulting bytecode contains the encoded error. use free() to destroy */
@@ -77,6 +77,13 @@ static int getOpLength(LuauOpcode op)
     case LOP_JUMPIFNOTEQK:
     case LOP_FASTCALL2:
     case LOP_FASTCALL2K:
+    case LOP_JUMPIFLEN:
+    case LOP_JUMPIFLTN:
+    case LOP_JUMPIFNOTLEN:
+    case LOP_JUMPIFNOTLTN:
+    case LOP_GETTABLEKS_NAMECALL:
+    case LOP_GETIMPORT_CALL:
+    case LOP_JUMPTABLE:
         return 2;
 
     default:
@@ -84,6 +91,24 @@ static int getOpLength(LuauOpcode op)
     }
 }
 
+// instructions that use C as an inline cache of the table slot of their key
+static bool hasInlineCache(LuauOpcode op)
+{
+    switch (op)
+    {
+    case LOP_GETGLOBAL:
+    case LOP_SETGLOBAL:
+    case LOP_GETTABLEKS:
+    case LOP_SETTABLEKS:
+    case LOP_NAMECALL:
+    case LOP_GETTABLEKS_NAMECALL:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
 inline bool isJumpD(LuauOpcode op)
 {
     switch (op)
@@ -108,6 +133,10 @@ inline bool isJumpD(LuauOpcode op)
     case LOP_JUMPBACK:
     case LOP_JUMPIFEQK:
     case LOP_JUMPIFNOTEQK:
+    case LOP_JUMPIFLEN:
+    case LOP_JUMPIFLTN:
+    case LOP_JUMPIFNOTLEN:
+    case LOP_JUMPIFNOTLTN:
         return true;
 
     default:
@@ -261,7 +290,10 @@ void BytecodeBuilder::endFunction(uint8_t maxstacksize, uint8_t numupvalues)
     // very approximate: 4 bytes per instruction for code, 1 byte for debug line, and 1-2 bytes for aux data like constants plus overhead
     func.data.reserve(32 + insns.size() * 7);
 
-    writeFunction(func.data, currentFunction);
+    writeFunction(func.data, currentFunction, func.codeoffset);
+
+    if (stripDebugInfo)
+        writeDebugSidecar(debugSidecar, currentFunction);
 
     currentFunction = ~0u;
 
@@ -294,6 +326,24 @@ void BytecodeBuilder::setMainFunction(uint32_t fid)
     mainFunction = fid;
 }
 
+uint8_t BytecodeBuilder::addMemoryCategory(StringRef name)
+{
+    // the category of each function is serialized with its header when the function ends
+    LUAU_ASSERT(functions.empty());
+    LUAU_ASSERT(memoryCategories.size() < 255);
+
+    memoryCategories.push_back(addStringTableEntry(name));
+
+    return uint8_t(memoryCategories.size());
+}
+
+void BytecodeBuilder::setFunctionMemoryCategory(uint8_t category)
+{
+    LUAU_ASSERT(category <= memoryCategories.size());
+
+    functions[currentFunction].memcat = category;
+}
+
 int32_t BytecodeBuilder::addConstant(const ConstantKey& key, const Constant& value)
 {
     if (int32_t* cache = constantMap.find(key))
@@ -508,6 +558,13 @@ bool BytecodeBuilder::patchSkipC(size_t jumpLabel, size_t targetLabel)
 
 void BytecodeBuilder::setDebugFunctionName(StringRef name)
 {
+    // stripped names only go to the sidecar, which is written from dumpname
+    if (stripDebugInfo)
+    {
+        functions[currentFunction].dumpname = std::string(name.data, name.length);
+        return;
+    }
+
     unsigned int index = addStringTableEntry(name);
 
     functions[currentFunction].debugname = index;
@@ -528,6 +585,9 @@ void BytecodeBuilder::setDebugLine(int line)
 
 void BytecodeBuilder::pushDebugLocal(StringRef name, uint8_t reg, uint32_t startpc, uint32_t endpc)
 {
+    if (stripDebugInfo)
+        return;
+
     unsigned int index = addStringTableEntry(name);
 
     DebugLocal local;
@@ -541,6 +601,9 @@ void BytecodeBuilder::pushDebugLocal(StringRef name, uint8_t reg, uint32_t start
 
 void BytecodeBuilder::pushDebugUpval(StringRef name)
 {
+    if (stripDebugInfo)
+        return;
+
     unsigned int index = addStringTableEntry(name);
 
     DebugUpval upval;
@@ -583,28 +646,41 @@ void BytecodeBuilder::finalize()
         capacity += p.first.length + 2;
 
     for (const Function& func : functions)
-        capacity += func.data.size();
+        capacity += func.data.size() + 3;
 
     bytecode.reserve(capacity);
 
-    // assemble final bytecode blob
-    uint8_t version = getVersion();
+    // assemble final bytecode blob; memory categories need version 4
+    uint8_t version = memoryCategories.empty() ? getVersion() : 4;
     LUAU_ASSERT(version >= LBC_VERSION_MIN && version <= LBC_VERSION_MAX);
 
     bytecode = char(version);
 
     writeStringTable(bytecode);
 
+    if (!memoryCategories.empty())
+    {
+        writeVarInt(bytecode, uint32_t(memoryCategories.size()));
+
+        for (unsigned int name : memoryCategories)
+            writeVarInt(bytecode, name);
+    }
+
     writeVarInt(bytecode, uint32_t(functions.size()));
 
     for (const Function& func : functions)
-        bytecode += func.data;
+    {
+        // instructions are aligned relative to the start of the blob, which lets the runtime execute them in place from an aligned image
+        bytecode.append(func.data, 0, func.codeoffset);
+        bytecode.append((4 - bytecode.size() % 4) % 4, '\0');
+        bytecode.append(func.data, func.codeoffset, std::string::npos);
+    }
 
     LUAU_ASSERT(mainFunction < functions.size());
     writeVarInt(bytecode, mainFunction);
 }
 
-void BytecodeBuilder::writeFunction(std::string& ss, uint32_t id) const
+void BytecodeBuilder::writeFunction(std::string& ss, uint32_t id, size_t& codeoffset) const
 {
     LUAU_ASSERT(id < functions.size());
     const Function& func = functions[id];
@@ -615,9 +691,17 @@ void BytecodeBuilder::writeFunction(std::string& ss, uint32_t id) const
     writeByte(ss, func.numupvalues);
     writeByte(ss, func.isvararg);
 
+    if (!memoryCategories.empty())
+        writeByte(ss, func.memcat);
+
     // instructions
     writeVarInt(ss, uint32_t(insns.size()));
 
+    codeoffset = ss.size();
+
+    // predicted slots of the inline caches; instructions refer to their cache by index, so that the code itself is never patched at runtime
+    std::string cache;
+
     for (size_t i = 0; i < insns.size();)
     {
         uint8_t op = LUAU_INSN_OP(insns[i]);
@@ -626,7 +710,18 @@ void BytecodeBuilder::writeFunction(std::string& ss, uint32_t id) const
         int oplen = getOpLength(LuauOpcode(op));
         uint8_t openc = encoder ? encoder->encodeOp(op) : op;
 
-        writeInt(ss, openc | (insns[i] & ~0xff));
+        uint32_t insn = insns[i];
+
+        if (hasInlineCache(LuauOpcode(op)))
+        {
+            // functions with more than 256 caches share the last one; the cached slot is a hint that is validated on every use
+            if (cache.size() < 256)
+                cache += char(LUAU_INSN_C(insn));
+
+            insn = (insn & 0x00ffffff) | (uint32_t(cache.size() - 1) << 24);
+        }
+
+        writeInt(ss, openc | (insn & ~0xff));
 
         for (int j = 1; j < oplen; ++j)
             writeInt(ss, insns[i + j]);
@@ -634,6 +729,9 @@ void BytecodeBuilder::writeFunction(std::string& ss, uint32_t id) const
         i += oplen;
     }
 
+    writeVarInt(ss, uint32_t(cache.size()));
+    ss += cache;
+
     // constants
     writeVarInt(ss, uint32_t(constants.size()));
 
@@ -692,10 +790,10 @@ void BytecodeBuilder::writeFunction(std::string& ss, uint32_t id) const
         writeVarInt(ss, child);
 
     // debug info
-    writeVarInt(ss, func.debuglinedefined);
+    writeVarInt(ss, stripDebugInfo ? 0 : func.debuglinedefined);
     writeVarInt(ss, func.debugname);
 
-    bool hasLines = true;
+    bool hasLines = !stripDebugInfo;
 
     for (int line : lines)
         if (line == 0)
@@ -744,6 +842,18 @@ void BytecodeBuilder::writeFunction(std::string& ss, uint32_t id) const
     }
 }
 
+void BytecodeBuilder::writeDebugSidecar(std::string& ss, uint32_t id) const
+{
+    const Function& func = functions[id];
+
+    formatAppend(ss, "f %u %d %s %u", id, func.debuglinedefined, func.dumpname.empty() ? "-" : func.dumpname.c_str(), unsigned(lines.size()));
+
+    for (int line : lines)
+        formatAppend(ss, " %d", line);
+
+    ss += '\n';
+}
+
 void BytecodeBuilder::writeLineInfo(std::string& ss) const
 {
     LUAU_ASSERT(!lines.empty());
@@ -954,6 +1064,25 @@ void BytecodeBuilder::expandJumps()
         return lhs.source < rhs.source;
     });
 
+    // jump tables find their entries by position, so we can't put trampolines in front of the entries; instead, tables with long entries
+    // are disabled which makes the VM run through the entries in order
+    for (size_t i = 0; i < insns.size();)
+    {
+        uint8_t op = LUAU_INSN_OP(insns[i]);
+
+        if (op == LOP_JUMPTABLE)
+        {
+            uint32_t first = uint32_t(i + 2);
+            uint32_t last = first + 2 * LUAU_INSN_B(insns[i]);
+
+            for (const Jump& jump : jumps)
+                if (jump.source >= first && jump.source < last && abs(int(jump.target) - int(jump.source) - 1) > kMaxJumpDistanceConservative)
+                    insns[i] &= ~0xff0000u;
+        }
+
+        i += getOpLength(LuauOpcode(op));
+    }
+
     // first, let's add jump thunks for every jump with a distance that's too big
     // we will create new instruction buffers, with remap table keeping track of the moves: remap[oldpc] = newpc
     std::vector<uint32_t> remap(insns.size());
@@ -1057,6 +1186,293 @@ void BytecodeBuilder::expandJumps()
     lines.swap(newlines);
 }
 
+static const char* getOpName(LuauOpcode op)
+{
+    switch (op)
+    {
+    case LOP_NOP:
+        return "NOP";
+    case LOP_BREAK:
+        return "BREAK";
+    case LOP_LOADNIL:
+        return "LOADNIL";
+    case LOP_LOADB:
+        return "LOADB";
+    case LOP_LOADN:
+        return "LOADN";
+    case LOP_LOADK:
+        return "LOADK";
+    case LOP_MOVE:
+        return "MOVE";
+    case LOP_GETGLOBAL:
+        return "GETGLOBAL";
+    case LOP_SETGLOBAL:
+        return "SETGLOBAL";
+    case LOP_GETUPVAL:
+        return "GETUPVAL";
+    case LOP_SETUPVAL:
+        return "SETUPVAL";
+    case LOP_CLOSEUPVALS:
+        return "CLOSEUPVALS";
+    case LOP_GETIMPORT:
+        return "GETIMPORT";
+    case LOP_GETTABLE:
+        return "GETTABLE";
+    case LOP_SETTABLE:
+        return "SETTABLE";
+    case LOP_GETTABLEKS:
+        return "GETTABLEKS";
+    case LOP_SETTABLEKS:
+        return "SETTABLEKS";
+    case LOP_GETTABLEN:
+        return "GETTABLEN";
+    case LOP_SETTABLEN:
+        return "SETTABLEN";
+    case LOP_NEWCLOSURE:
+        return "NEWCLOSURE";
+    case LOP_NAMECALL:
+        return "NAMECALL";
+    case LOP_CALL:
+        return "CALL";
+    case LOP_RETURN:
+        return "RETURN";
+    case LOP_JUMP:
+        return "JUMP";
+    case LOP_JUMPBACK:
+        return "JUMPBACK";
+    case LOP_JUMPIF:
+        return "JUMPIF";
+    case LOP_JUMPIFNOT:
+        return "JUMPIFNOT";
+    case LOP_JUMPIFEQ:
+        return "JUMPIFEQ";
+    case LOP_JUMPIFLE:
+        return "JUMPIFLE";
+    case LOP_JUMPIFLT:
+        return "JUMPIFLT";
+    case LOP_JUMPIFNOTEQ:
+        return "JUMPIFNOTEQ";
+    case LOP_JUMPIFNOTLE:
+        return "JUMPIFNOTLE";
+    case LOP_JUMPIFNOTLT:
+        return "JUMPIFNOTLT";
+    case LOP_ADD:
+        return "ADD";
+    case LOP_SUB:
+        return "SUB";
+    case LOP_MUL:
+        return "MUL";
+    case LOP_DIV:
+        return "DIV";
+    case LOP_MOD:
+        return "MOD";
+    case LOP_POW:
+        return "POW";
+    case LOP_ADDK:
+        return "ADDK";
+    case LOP_SUBK:
+        return "SUBK";
+    case LOP_MULK:
+        return "MULK";
+    case LOP_DIVK:
+        return "DIVK";
+    case LOP_MODK:
+        return "MODK";
+    case LOP_POWK:
+        return "POWK";
+    case LOP_AND:
+        return "AND";
+    case LOP_OR:
+        return "OR";
+    case LOP_ANDK:
+        return "ANDK";
+    case LOP_ORK:
+        return "ORK";
+    case LOP_CONCAT:
+        return "CONCAT";
+    case LOP_NOT:
+        return "NOT";
+    case LOP_MINUS:
+        return "MINUS";
+    case LOP_LENGTH:
+        return "LENGTH";
+    case LOP_NEWTABLE:
+        return "NEWTABLE";
+    case LOP_DUPTABLE:
+        return "DUPTABLE";
+    case LOP_SETLIST:
+        return "SETLIST";
+    case LOP_FORNPREP:
+        return "FORNPREP";
+    case LOP_FORNLOOP:
+        return "FORNLOOP";
+    case LOP_FORGLOOP:
+        return "FORGLOOP";
+    case LOP_FORGPREP_INEXT:
+        return "FORGPREP_INEXT";
+    case LOP_FORGLOOP_INEXT:
+        return "FORGLOOP_INEXT";
+    case LOP_FORGPREP_NEXT:
+        return "FORGPREP_NEXT";
+    case LOP_FORGLOOP_NEXT:
+        return "FORGLOOP_NEXT";
+    case LOP_GETVARARGS:
+        return "GETVARARGS";
+    case LOP_DUPCLOSURE:
+        return "DUPCLOSURE";
+    case LOP_PREPVARARGS:
+        return "PREPVARARGS";
+    case LOP_LOADKX:
+        return "LOADKX";
+    case LOP_JUMPX:
+        return "JUMPX";
+    case LOP_FASTCALL:
+        return "FASTCALL";
+    case LOP_COVERAGE:
+        return "COVERAGE";
+    case LOP_CAPTURE:
+        return "CAPTURE";
+    case LOP_JUMPIFEQK:
+        return "JUMPIFEQK";
+    case LOP_JUMPIFNOTEQK:
+        return "JUMPIFNOTEQK";
+    case LOP_FASTCALL1:
+        return "FASTCALL1";
+    case LOP_FASTCALL2:
+        return "FASTCALL2";
+    case LOP_FASTCALL2K:
+        return "FASTCALL2K";
+    case LOP_FORGPREP:
+        return "FORGPREP";
+    case LOP_ADDN:
+        return "ADDN";
+    case LOP_SUBN:
+        return "SUBN";
+    case LOP_MULN:
+        return "MULN";
+    case LOP_DIVN:
+        return "DIVN";
+    case LOP_JUMPIFLEN:
+        return "JUMPIFLEN";
+    case LOP_JUMPIFLTN:
+        return "JUMPIFLTN";
+    case LOP_JUMPIFNOTLEN:
+        return "JUMPIFNOTLEN";
+    case LOP_JUMPIFNOTLTN:
+        return "JUMPIFNOTLTN";
+    case LOP_LOADN_JUMPIFLT:
+        return "LOADN_JUMPIFLT";
+    case LOP_LOADN_JUMPIFLE:
+        return "LOADN_JUMPIFLE";
+    case LOP_LOADN_JUMPIFNOTLT:
+        return "LOADN_JUMPIFNOTLT";
+    case LOP_LOADN_JUMPIFNOTLE:
+        return "LOADN_JUMPIFNOTLE";
+    case LOP_LOADN_NAMECALL:
+        return "LOADN_NAMECALL";
+    case LOP_GETTABLEKS_NAMECALL:
+        return "GETTABLEKS_NAMECALL";
+    case LOP_GETIMPORT_CALL:
+        return "GETIMPORT_CALL";
+    case LOP_JUMPTABLE:
+        return "JUMPTABLE";
+
+    default:
+        LUAU_ASSERT(!"Unsupported opcode");
+        return "UNKNOWN";
+    }
+}
+
+static LuauOpcode getFusedOp(LuauOpcode first, LuauOpcode second)
+{
+    // the pairs below are the most frequent ones in the opcode pair histogram of our scripts that the VM doesn't already execute as
+    // one instruction (NAMECALL always continues into CALL without a dispatch, and arithmetic with a constant operand uses *K opcodes)
+    switch (first)
+    {
+    case LOP_LOADN:
+        switch (second)
+        {
+        case LOP_JUMPIFLT:
+            return LOP_LOADN_JUMPIFLT;
+        case LOP_JUMPIFLE:
+            return LOP_LOADN_JUMPIFLE;
+        case LOP_JUMPIFNOTLT:
+            return LOP_LOADN_JUMPIFNOTLT;
+        case LOP_JUMPIFNOTLE:
+            return LOP_LOADN_JUMPIFNOTLE;
+        case LOP_NAMECALL:
+            return LOP_LOADN_NAMECALL;
+        default:
+            return LOP__COUNT;
+        }
+
+    case LOP_GETTABLEKS:
+        return second == LOP_NAMECALL ? LOP_GETTABLEKS_NAMECALL : LOP__COUNT;
+
+    case LOP_GETIMPORT:
+        return second == LOP_CALL ? LOP_GETIMPORT_CALL : LOP__COUNT;
+
+    default:
+        return LOP__COUNT;
+    }
+}
+
+void BytecodeBuilder::fuseInstructions()
+{
+    for (size_t i = 0; i < insns.size();)
+    {
+        LuauOpcode op = LuauOpcode(LUAU_INSN_OP(insns[i]));
+        size_t next = i + getOpLength(op);
+
+        if (next >= insns.size())
+            break;
+
+        LuauOpcode nextop = LuauOpcode(LUAU_INSN_OP(insns[next]));
+
+        if (opcodePairs)
+            opcodePairs->counts[op][nextop]++;
+
+        // the second instruction doesn't go through dispatch, so a breakpoint or a debug step can't stop on it; the instructions have to
+        // be on the same line for this to be unobservable
+        LuauOpcode fused = getFusedOp(op, nextop);
+
+        if (fused != LOP__COUNT && lines[i] == lines[next])
+        {
+            insns[i] &= ~0xffu;
+            insns[i] |= fused;
+        }
+
+        i = next;
+    }
+}
+
+std::string BytecodeBuilder::dumpOpcodePairs(const OpcodePairHistogram& histogram, size_t top)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+
+    for (int first = 0; first < LOP__COUNT; ++first)
+        for (int second = 0; second < LOP__COUNT; ++second)
+            if (histogram.counts[first][second])
+                pairs.push_back(std::make_pair(histogram.counts[first][second], uint32_t(first * LOP__COUNT + second)));
+
+    std::sort(pairs.begin(), pairs.end(), [](const std::pair<uint32_t, uint32_t>& lhs, const std::pair<uint32_t, uint32_t>& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    std::string result;
+
+    for (size_t i = 0; i < pairs.size() && i < top; ++i)
+    {
+        LuauOpcode first = LuauOpcode(pairs[i].second / LOP__COUNT);
+        LuauOpcode second = LuauOpcode(pairs[i].second % LOP__COUNT);
+
+        formatAppend(result, "%8u %s %s%s\n", pairs[i].first, getOpName(first), getOpName(second),
+            getFusedOp(first, second) != LOP__COUNT ? " (fused)" : "");
+    }
+
+    return result;
+}
+
 std::string BytecodeBuilder::getError(const std::string& message)
 {
     // 0 acts as a special marker for error bytecode (it's equal to LBC_VERSION_TARGET for valid bytecode blobs)
@@ -1067,6 +1483,125 @@ std::string BytecodeBuilder::getError(const std::string& message)
     return result;
 }
 
+static void writeLength(std::string& ss, size_t length)
+{
+    // lengths of 15 and above spill from the token nibble into bytes that are added together until one is below 255
+    for (; length >= 255; length -= 255)
+        writeByte(ss, 255);
+
+    writeByte(ss, uint8_t(length));
+}
+
+static void writeSequence(std::string& ss, const char* literals, size_t literalCount, size_t matchOffset, size_t matchLength)
+{
+    size_t matchCode = matchLength ? matchLength - 4 : 0;
+
+    writeByte(ss, uint8_t((std::min(literalCount, size_t(15)) << 4) | std::min(matchCode, size_t(15))));
+
+    if (literalCount >= 15)
+        writeLength(ss, literalCount - 15);
+
+    ss.append(literals, literalCount);
+
+    // the last sequence has no match
+    if (matchLength == 0)
+        return;
+
+    writeByte(ss, uint8_t(matchOffset & 0xff));
+    writeByte(ss, uint8_t(matchOffset >> 8));
+
+    if (matchCode >= 15)
+        writeLength(ss, matchCode - 15);
+}
+
+std::string BytecodeBuilder::compress(const std::string& bytecode, int windowLog)
+{
+    LUAU_ASSERT(windowLog >= LBC_COMPRESSED_WINDOWLOG_MIN && windowLog <= LBC_COMPRESSED_WINDOWLOG_MAX);
+
+    // LZ4 block format constraints: matches are at least 4 bytes long, the last 5 bytes are always literals and the last match starts
+    // at least 12 bytes before the end, which lets LZ4 decoders copy in wide chunks; offsets are 16-bit and limited by the window
+    const size_t kMinMatch = 4;
+    const size_t kLastLiterals = 5;
+    const size_t kMatchLimit = 12;
+    const int kHashLog = 12;
+
+    size_t maxOffset = std::min(size_t(1) << windowLog, size_t(65535));
+
+    std::string result;
+    result.reserve(bytecode.size() / 2 + 16);
+
+    writeByte(result, LBC_COMPRESSED);
+    writeByte(result, uint8_t(windowLog));
+    writeVarInt(result, uint32_t(bytecode.size()));
+
+    const char* data = bytecode.data();
+    size_t size = bytecode.size();
+
+    // last position of each hashed 4-byte sequence, plus one
+    std::vector<size_t> positions(size_t(1) << kHashLog, 0);
+
+    auto hash = [&](size_t pos) {
+        uint32_t seq;
+        memcpy(&seq, data + pos, sizeof(seq));
+
+        return (seq * 2654435761u) >> (32 - kHashLog);
+    };
+
+    size_t anchor = 0;
+    size_t pos = 0;
+
+    while (pos + kMatchLimit < size)
+    {
+        uint32_t h = hash(pos);
+        size_t candidate = positions[h];
+        positions[h] = pos + 1;
+
+        if (candidate == 0 || pos - (candidate - 1) > maxOffset || memcmp(data + candidate - 1, data + pos, kMinMatch) != 0)
+        {
+            pos++;
+            continue;
+        }
+
+        size_t match = candidate - 1;
+        size_t length = kMinMatch;
+
+        while (pos + length < size - kLastLiterals && data[match + length] == data[pos + length])
+            length++;
+
+        writeSequence(result, data + anchor, pos - anchor, pos - match, length);
+
+        // positions inside the match are hashed as well, which finds more matches in repetitive code at little cost
+        for (size_t i = pos + 1; i < pos + length && i + kMatchLimit < size; ++i)
+            positions[hash(i)] = i + 1;
+
+        pos += length;
+        anchor = pos;
+    }
+
+    writeSequence(result, data + anchor, size - anchor, 0, 0);
+
+    return result;
+}
+
+std::string BytecodeBuilder::getDebugSidecar(const std::string& image, const std::string& source) const
+{
+    std::string result = format("luau-debug 1 %08x %s\n", getImageHash(image), source.c_str());
+    result += debugSidecar;
+
+    return result;
+}
+
+uint32_t BytecodeBuilder::getImageHash(const std::string& image)
+{
+    // FNV-1a, which the runtime computes while loading the image
+    uint32_t hash = 2166136261u;
+
+    for (char ch : image)
+        hash = (hash ^ uint8_t(ch)) * 16777619u;
+
+    return hash;
+}
+
 uint8_t BytecodeBuilder::getVersion()
 {
     // This function usually returns LBC_VERSION_TARGET but may sometimes return a higher number (within LBC_VERSION_MIN/MAX) under fast flags
@@ -1121,6 +1656,11 @@ void BytecodeBuilder::validate() const
             break;
 
         case LOP_LOADN:
+        case LOP_LOADN_JUMPIFLT:
+        case LOP_LOADN_JUMPIFLE:
+        case LOP_LOADN_JUMPIFNOTLT:
+        case LOP_LOADN_JUMPIFNOTLE:
+        case LOP_LOADN_NAMECALL:
             VREG(LUAU_INSN_A(insn));
             break;
 
@@ -1153,6 +1693,7 @@ void BytecodeBuilder::validate() const
             break;
 
         case LOP_GETIMPORT:
+        case LOP_GETIMPORT_CALL:
             VREG(LUAU_INSN_A(insn));
             VCONST(LUAU_INSN_D(insn), Import);
             // TODO: check insn[i + 1] for conformance with 10-bit import encoding
@@ -1167,6 +1708,7 @@ void BytecodeBuilder::validate() const
 
         case LOP_GETTABLEKS:
         case LOP_SETTABLEKS:
+        case LOP_GETTABLEKS_NAMECALL:
             VREG(LUAU_INSN_A(insn));
             VREG(LUAU_INSN_B(insn));
             VCONST(insns[i + 1], String);
@@ -1234,6 +1776,10 @@ void BytecodeBuilder::validate() const
         case LOP_JUMPIFNOTEQ:
         case LOP_JUMPIFNOTLE:
         case LOP_JUMPIFNOTLT:
+        case LOP_JUMPIFLEN:
+        case LOP_JUMPIFLTN:
+        case LOP_JUMPIFNOTLEN:
+        case LOP_JUMPIFNOTLTN:
             VREG(LUAU_INSN_A(insn));
             VREG(insns[i + 1]);
             VJUMP(LUAU_INSN_D(insn));
@@ -1246,12 +1792,28 @@ void BytecodeBuilder::validate() const
             VJUMP(LUAU_INSN_D(insn));
             break;
 
+        case LOP_JUMPTABLE:
+            VREG(LUAU_INSN_A(insn));
+            LUAU_ASSERT(LUAU_INSN_C(insn) <= 1);
+            LUAU_ASSERT(LUAU_INSN_C(insn) == 0 || (LUAU_INSN_B(insn) & (LUAU_INSN_B(insn) - 1)) == 0);
+            for (int j = 0; j < LUAU_INSN_B(insn); ++j)
+            {
+                LUAU_ASSERT(i + 2 + j * 2 < insns.size());
+                LUAU_ASSERT(LUAU_INSN_OP(insns[i + 2 + j * 2]) == LOP_JUMPIFEQK);
+                LUAU_ASSERT(LUAU_INSN_A(insns[i + 2 + j * 2]) == LUAU_INSN_A(insn));
+            }
+            break;
+
         case LOP_ADD:
         case LOP_SUB:
         case LOP_MUL:
         case LOP_DIV:
         case LOP_MOD:
         case LOP_POW:
+        case LOP_ADDN:
+        case LOP_SUBN:
+        case LOP_MULN:
+        case LOP_DIVN:
             VREG(LUAU_INSN_A(insn));
             VREG(LUAU_INSN_B(insn));
             VREG(LUAU_INSN_C(insn));
@@ -1779,6 +2341,71 @@ void BytecodeBuilder::dumpInstruction(const uint32_t* code, std::string& result,
         formatAppend(result, "JUMPIFNOTEQK R%d K%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
         break;
 
+    case LOP_ADDN:
+        formatAppend(result, "ADDN R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
+        break;
+
+    case LOP_SUBN:
+        formatAppend(result, "SUBN R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
+        break;
+
+    case LOP_MULN:
+        formatAppend(result, "MULN R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
+        break;
+
+    case LOP_DIVN:
+        formatAppend(result, "DIVN R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
+        break;
+
+    case LOP_JUMPIFLEN:
+        formatAppend(result, "JUMPIFLEN R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
+        break;
+
+    case LOP_JUMPIFLTN:
+        formatAppend(result, "JUMPIFLTN R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
+        break;
+
+    case LOP_JUMPIFNOTLEN:
+        formatAppend(result, "JUMPIFNOTLEN R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
+        break;
+
+    case LOP_JUMPIFNOTLTN:
+        formatAppend(result, "JUMPIFNOTLTN R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
+        break;
+
+    case LOP_LOADN_JUMPIFLT:
+        formatAppend(result, "LOADN_JUMPIFLT R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
+        break;
+
+    case LOP_LOADN_JUMPIFLE:
+        formatAppend(result, "LOADN_JUMPIFLE R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
+        break;
+
+    case LOP_LOADN_JUMPIFNOTLT:
+        formatAppend(result, "LOADN_JUMPIFNOTLT R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
+        break;
+
+    case LOP_LOADN_JUMPIFNOTLE:
+        formatAppend(result, "LOADN_JUMPIFNOTLE R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
+        break;
+
+    case LOP_LOADN_NAMECALL:
+        formatAppend(result, "LOADN_NAMECALL R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
+        break;
+
+    case LOP_GETTABLEKS_NAMECALL:
+        formatAppend(result, "GETTABLEKS_NAMECALL R%d R%d K%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), *code++);
+        break;
+
+    case LOP_GETIMPORT_CALL:
+        formatAppend(result, "GETIMPORT_CALL R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
+        code++; // AUX
+        break;
+
+    case LOP_JUMPTABLE:
+        formatAppend(result, "JUMPTABLE R%d %d %s %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn) ? "string" : "number", int32_t(*code++));
+        break;
+
     default:
         LUAU_ASSERT(!"Unsupported opcode");
     }
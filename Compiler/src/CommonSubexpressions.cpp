@@ -0,0 +1,349 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#include "CommonSubexpressions.h"
+
+#include <string.h>
+
+namespace Luau
+{
+namespace Compile
+{
+
+static AstExpr* skipGroups(AstExpr* node)
+{
+    while (AstExprGroup* expr = node->as<AstExprGroup>())
+        node = expr->expr;
+
+    return node;
+}
+
+static bool isArithmetic(AstExprBinary::Op op)
+{
+    switch (op)
+    {
+    case AstExprBinary::Add:
+    case AstExprBinary::Sub:
+    case AstExprBinary::Mul:
+    case AstExprBinary::Div:
+    case AstExprBinary::Mod:
+    case AstExprBinary::Pow:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static bool isConstantKey(AstExpr* node)
+{
+    return node->is<AstExprConstantNumber>() || node->is<AstExprConstantString>();
+}
+
+bool isSameExpr(AstExpr* a, AstExpr* b)
+{
+    a = skipGroups(a);
+    b = skipGroups(b);
+
+    if (AstExprLocal* ea = a->as<AstExprLocal>())
+    {
+        AstExprLocal* eb = b->as<AstExprLocal>();
+
+        return eb && ea->local == eb->local;
+    }
+    else if (AstExprGlobal* ea = a->as<AstExprGlobal>())
+    {
+        AstExprGlobal* eb = b->as<AstExprGlobal>();
+
+        return eb && ea->name == eb->name;
+    }
+    else if (AstExprConstantNumber* ea = a->as<AstExprConstantNumber>())
+    {
+        AstExprConstantNumber* eb = b->as<AstExprConstantNumber>();
+
+        // bitwise comparison keeps 0 and -0 apart
+        return eb && memcmp(&ea->value, &eb->value, sizeof(double)) == 0;
+    }
+    else if (AstExprConstantString* ea = a->as<AstExprConstantString>())
+    {
+        AstExprConstantString* eb = b->as<AstExprConstantString>();
+
+        return eb && ea->value.size == eb->value.size && memcmp(ea->value.data, eb->value.data, ea->value.size) == 0;
+    }
+    else if (AstExprIndexName* ea = a->as<AstExprIndexName>())
+    {
+        AstExprIndexName* eb = b->as<AstExprIndexName>();
+
+        return eb && ea->op == eb->op && ea->index == eb->index && isSameExpr(ea->expr, eb->expr);
+    }
+    else if (AstExprIndexExpr* ea = a->as<AstExprIndexExpr>())
+    {
+        AstExprIndexExpr* eb = b->as<AstExprIndexExpr>();
+
+        return eb && isSameExpr(ea->expr, eb->expr) && isSameExpr(ea->index, eb->index);
+    }
+    else if (AstExprUnary* ea = a->as<AstExprUnary>())
+    {
+        AstExprUnary* eb = b->as<AstExprUnary>();
+
+        return eb && ea->op == eb->op && isSameExpr(ea->expr, eb->expr);
+    }
+    else if (AstExprBinary* ea = a->as<AstExprBinary>())
+    {
+        AstExprBinary* eb = b->as<AstExprBinary>();
+
+        return eb && ea->op == eb->op && isSameExpr(ea->left, eb->left) && isSameExpr(ea->right, eb->right);
+    }
+
+    return false;
+}
+
+static size_t hashExpr(AstExpr* node)
+{
+    node = skipGroups(node);
+
+    if (AstExprLocal* expr = node->as<AstExprLocal>())
+        return DenseHashPointer()(expr->local);
+    else if (AstExprGlobal* expr = node->as<AstExprGlobal>())
+        return DenseHashPointer()(expr->name.value);
+    else if (AstExprConstantNumber* expr = node->as<AstExprConstantNumber>())
+    {
+        uint64_t bits;
+        memcpy(&bits, &expr->value, sizeof(bits));
+
+        return size_t(bits ^ (bits >> 32));
+    }
+    else if (AstExprConstantString* expr = node->as<AstExprConstantString>())
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261;
+
+        for (size_t i = 0; i < expr->value.size; ++i)
+            hash = (hash ^ uint8_t(expr->value.data[i])) * 16777619;
+
+        return hash;
+    }
+    else if (AstExprIndexName* expr = node->as<AstExprIndexName>())
+        return hashExpr(expr->expr) * 31 ^ DenseHashPointer()(expr->index.value);
+    else if (AstExprIndexExpr* expr = node->as<AstExprIndexExpr>())
+        return hashExpr(expr->expr) * 31 ^ hashExpr(expr->index);
+    else if (AstExprUnary* expr = node->as<AstExprUnary>())
+        return hashExpr(expr->expr) * 31 + expr->op;
+    else if (AstExprBinary* expr = node->as<AstExprBinary>())
+        return (hashExpr(expr->left) * 31 ^ hashExpr(expr->right)) * 31 + expr->op;
+
+    return node->classIndex;
+}
+
+struct ExprKey
+{
+    AstExpr* expr;
+
+    bool operator==(const ExprKey& other) const
+    {
+        return expr == other.expr || (expr && other.expr && isSameExpr(expr, other.expr));
+    }
+};
+
+struct ExprKeyHash
+{
+    size_t operator()(const ExprKey& key) const
+    {
+        return key.expr ? hashExpr(key.expr) : 0;
+    }
+};
+
+struct ExprClass
+{
+    unsigned int count = 0;     // number of occurrences in the run, including nested ones
+    size_t index = ~size_t(0);  // index of the matched expression
+};
+
+static bool isStraightLine(AstStat* stat)
+{
+    return stat->is<AstStatLocal>() || stat->is<AstStatAssign>() || stat->is<AstStatCompoundAssign>() || stat->is<AstStatExpr>();
+}
+
+size_t getStatementRun(AstStatBlock* block, size_t start)
+{
+    size_t end = start;
+
+    while (end < block->body.size && isStraightLine(block->body.data[end]))
+        end++;
+
+    return end < block->body.size ? end + 1 : end;
+}
+
+// visits expressions of the run that are evaluated before any branch is taken
+static void visitRun(AstVisitor* visitor, AstStatBlock* block, size_t start, size_t end)
+{
+    for (size_t i = start; i < end; ++i)
+    {
+        AstStat* stat = block->body.data[i];
+
+        if (isStraightLine(stat))
+            stat->visit(visitor);
+        else if (AstStatIf* ifs = stat->as<AstStatIf>())
+            ifs->condition->visit(visitor);
+        else if (AstStatReturn* ret = stat->as<AstStatReturn>())
+            for (size_t j = 0; j < ret->list.size; ++j)
+                ret->list.data[j]->visit(visitor);
+    }
+}
+
+struct CommonExprVisitor : AstVisitor
+{
+    std::vector<CommonExpr>& exprs;
+    DenseHashMap<AstExpr*, size_t>& occurrences;
+
+    const DenseHashMap<AstName, Global>& globals;
+    const DenseHashMap<AstLocal*, Variable>& variables;
+    const TableWrites& writes;
+
+    DenseHashMap<ExprKey, ExprClass, ExprKeyHash> classes;
+
+    bool matching = false;         // false while counting occurrences, true while matching expressions that occur more than once
+    unsigned int conditional = 0; // are we inside an expression that may not be evaluated?
+
+    CommonExprVisitor(std::vector<CommonExpr>& exprs, DenseHashMap<AstExpr*, size_t>& occurrences, const DenseHashMap<AstName, Global>& globals,
+        const DenseHashMap<AstLocal*, Variable>& variables, const TableWrites& writes)
+        : exprs(exprs)
+        , occurrences(occurrences)
+        , globals(globals)
+        , variables(variables)
+        , writes(writes)
+        , classes(ExprKey{nullptr})
+    {
+    }
+
+    bool isPure(AstExpr* node)
+    {
+        node = skipGroups(node);
+
+        bool loads = !writes.calls && !writes.dynamic;
+
+        if (node->is<AstExprConstantNumber>() || node->is<AstExprConstantString>() || node->is<AstExprConstantBool>() || node->is<AstExprConstantNil>())
+            return true;
+        else if (AstExprLocal* expr = node->as<AstExprLocal>())
+        {
+            const Variable* var = variables.find(expr->local);
+
+            return !var || !var->written;
+        }
+        else if (AstExprGlobal* expr = node->as<AstExprGlobal>())
+            return loads && getGlobalState(globals, expr->name) == Global::Default;
+        else if (AstExprIndexName* expr = node->as<AstExprIndexName>())
+            return loads && expr->op == '.' && !writes.fields.contains(expr->index) && isPure(expr->expr);
+        else if (AstExprIndexExpr* expr = node->as<AstExprIndexExpr>())
+            return loads && isConstantKey(expr->index) && isPure(expr->expr);
+        else if (AstExprUnary* expr = node->as<AstExprUnary>())
+            return expr->op == AstExprUnary::Minus && isPure(expr->expr);
+        else if (AstExprBinary* expr = node->as<AstExprBinary>())
+            return isArithmetic(expr->op) && isPure(expr->left) && isPure(expr->right);
+
+        return false;
+    }
+
+    bool visit(AstExpr* node) override
+    {
+        if (!(node->is<AstExprIndexName>() || node->is<AstExprIndexExpr>() || node->is<AstExprUnary>() || node->is<AstExprBinary>()))
+            return true;
+
+        if (!isPure(node))
+            return true;
+
+        if (!matching)
+        {
+            classes[{node}].count++;
+            return true;
+        }
+
+        ExprClass* ec = classes.find({node});
+        LUAU_ASSERT(ec);
+
+        if (ec->count < 2)
+            return true;
+
+        if (ec->index == ~size_t(0))
+        {
+            ec->index = exprs.size();
+            exprs.push_back({});
+        }
+
+        CommonExpr& ce = exprs[ec->index];
+
+        ce.count++;
+
+        if (!ce.first && conditional == 0)
+            ce.first = node;
+
+        occurrences[node] = ec->index;
+
+        // nested expressions are computed as part of this one
+        return false;
+    }
+
+    bool visit(AstExprFunction* node) override
+    {
+        return false;
+    }
+
+    bool visit(AstExprBinary* node) override
+    {
+        if (node->op == AstExprBinary::And || node->op == AstExprBinary::Or)
+        {
+            node->left->visit(this);
+
+            conditional++;
+            node->right->visit(this);
+            conditional--;
+
+            return false;
+        }
+
+        return visit(static_cast<AstExpr*>(node));
+    }
+
+    bool visit(AstExprIfElse* node) override
+    {
+        node->condition->visit(this);
+
+        conditional++;
+        node->trueExpr->visit(this);
+        node->falseExpr->visit(this);
+        conditional--;
+
+        return false;
+    }
+};
+
+void findCommonExprs(std::vector<CommonExpr>& exprs, DenseHashMap<AstExpr*, size_t>& occurrences, const DenseHashMap<AstName, Global>& globals,
+    const DenseHashMap<AstLocal*, Variable>& variables, const DenseHashMap<AstExprCall*, int>& builtins, AstStatBlock* block, size_t start,
+    size_t end)
+{
+    TableWrites writes;
+
+    for (size_t i = start; i < end; ++i)
+    {
+        AstStat* stat = block->body.data[i];
+
+        if (AstStatIf* ifs = stat->as<AstStatIf>())
+            trackTableWrites(writes, builtins, ifs->condition);
+        else
+            trackTableWrites(writes, builtins, stat);
+    }
+
+    size_t oldExprs = exprs.size();
+
+    CommonExprVisitor visitor{exprs, occurrences, globals, variables, writes};
+    visitRun(&visitor, block, start, end);
+
+    visitor.matching = true;
+    visitRun(&visitor, block, start, end);
+
+    // expressions that end up with a single match, e.g. because other occurrences are nested in a match, are not worth a register
+    for (size_t i = oldExprs; i < exprs.size(); ++i)
+        if (exprs[i].count < 2)
+            exprs[i].first = nullptr;
+}
+
+} // namespace Compile
+} // namespace Luau
@@ -0,0 +1,42 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#pragma once
+
+#include "Luau/Ast.h"
+#include "Luau/DenseHash.h"
+
+#include "ValueTracking.h"
+
+#include <vector>
+
+namespace Luau
+{
+namespace Compile
+{
+
+struct CommonExpr
+{
+    AstExpr* first = nullptr; // occurrence that computes the value; it's evaluated whenever the run is, before all other occurrences
+    unsigned int count = 0;   // number of occurrences in the run
+
+    uint8_t reg = 0;     // register that holds the value; filled by the compiler
+    bool filled = false; // has the compiler emitted the code that computes the value? filled by the compiler
+};
+
+// returns the index past the run of statements starting at start that runs in order without branching
+// note: the last statement of a run may be an if or a return, since its condition or values are evaluated before any branch is taken
+size_t getStatementRun(AstStatBlock* block, size_t start);
+
+// finds arithmetic and constant-key field reads that are evaluated more than once in statements [start, end) of the block, where all
+// variables involved are never assigned; field reads and globals are only considered if the run doesn't write fields with the same name
+// and doesn't call functions other than builtins
+// occurrences maps each occurrence to its index in exprs; nested expressions are only matched outside of the matched ones
+// note: metamethods aren't taken into account; the caller must only reuse expressions that are known to produce numbers
+void findCommonExprs(std::vector<CommonExpr>& exprs, DenseHashMap<AstExpr*, size_t>& occurrences, const DenseHashMap<AstName, Global>& globals,
+    const DenseHashMap<AstLocal*, Variable>& variables, const DenseHashMap<AstExprCall*, int>& builtins, AstStatBlock* block, size_t start,
+    size_t end);
+
+// returns true if both expressions compute the same value when the variables involved aren't modified
+bool isSameExpr(AstExpr* a, AstExpr* b);
+
+} // namespace Compile
+} // namespace Luau
@@ -7,9 +7,14 @@
 #include "Luau/TimeTrace.h"
 
 #include "Builtins/Builtins.h"
+#include "CommonSubexpressions.h"
 #include "ConstantFolding.h"
 #include "CostModel.h"
+#include "EscapeAnalysis.h"
+#include "LoopInvariants.h"
+#include "RequireGraph.h"
 #include "TableShape.h"
+#include "TreeShaking.h"
 #include "ValueTracking.h"
 
 #include <algorithm>
@@ -38,6 +43,12 @@ static const uint32_t kMaxRegisterCount = 255;
 static const uint32_t kMaxUpvalueCount = 200;
 static const uint32_t kMaxLocalCount = 200;
 
+static const size_t kJumpTableMinCases = 4;
+static const uint32_t kJumpTableMaxEntries = 128;
+
+static const size_t kMaxHoistedLoads = 8;
+static const size_t kMaxCommonExprs = 8;
+
 CompileError::CompileError(const Location& location, const std::string& message)
     : location(location)
     , message(message)
@@ -100,6 +111,15 @@ struct Compiler
         , locstants(nullptr)
         , tableShapes(nullptr)
         , builtins(nullptr)
+        , constantGlobals(std::string())
+        , fields(TableField{nullptr, AstName()})
+        , assignedFields(nullptr)
+        , numberLocals(nullptr)
+        , scalarTables(nullptr)
+        , scalarTableRegs(nullptr)
+        , commonExprOccurrences(nullptr)
+        , moduleCategories(nullptr)
+        , moduleFunctions(nullptr)
     {
         // preallocate some buffers that are very likely to grow anyway; this works around std::vector's inefficient growth policy for small arrays
         localStack.reserve(16);
@@ -176,10 +196,42 @@ struct Compiler
             return getFunctionExpr(expr->expr);
         else if (AstExprTypeAssertion* expr = node->as<AstExprTypeAssertion>())
             return getFunctionExpr(expr->expr);
+        else if (AstExprIndexName* expr = node->as<AstExprIndexName>(); expr && expr->op == '.' && !fields.empty())
+            return getFieldFunctionExpr(expr);
         else
             return node->as<AstExprFunction>();
     }
 
+    // resolves M.f to the function assigned to the field, following local aliases of M; see trackFields
+    AstExprFunction* getFieldFunctionExpr(AstExprIndexName* expr)
+    {
+        AstExprLocal* le = expr->expr->as<AstExprLocal>();
+
+        while (le)
+        {
+            if (const FieldValue* fv = fields.find({le->local, expr->index}))
+            {
+                if (!fv->value || fields.contains({le->local, AstName()}))
+                    return nullptr;
+
+                // the field might not be assigned yet if the assignment is in the function we're compiling and comes later
+                if (fv->assignment && le->local->functionDepth == functionDepth && !assignedFields.contains(fv->assignment))
+                    return nullptr;
+
+                return getFunctionExpr(fv->value);
+            }
+
+            Variable* lv = variables.find(le->local);
+
+            if (!lv || lv->written || !lv->init)
+                return nullptr;
+
+            le = lv->init->as<AstExprLocal>();
+        }
+
+        return nullptr;
+    }
+
     uint32_t compileFunction(AstExprFunction* func)
     {
         LUAU_TIMETRACE_SCOPE("Compiler::compileFunction", "Compiler");
@@ -192,9 +244,20 @@ struct Compiler
 
         RegScope rs(this);
 
+        functionDepth = func->functionDepth;
+
         bool self = func->self != 0;
         uint32_t fid = bytecode.beginFunction(uint8_t(self + func->args.size), func->vararg);
 
+        const uint8_t* category = moduleCategories.find(func);
+        functionCategory = category ? *category : 0;
+
+        if (functionCategory)
+            bytecode.setFunctionMemoryCategory(functionCategory);
+
+        const Compile::LinkedModule* const* module = moduleFunctions.find(func);
+        functionModule = module ? *module : nullptr;
+
         setDebugLine(func);
 
         if (func->vararg)
@@ -208,10 +271,13 @@ struct Compiler
         for (size_t i = 0; i < func->args.size; ++i)
             pushLocal(func->args.data[i], uint8_t(args + self + i));
 
+        // the main chunk creates the constant globals that are read without folding before any code that reads them runs
+        if (func->functionDepth == 0)
+            compileUnfoldedGlobals(func);
+
         AstStatBlock* stat = func->body;
 
-        for (size_t i = 0; i < stat->body.size; ++i)
-            compileStat(stat->body.data[i]);
+        compileStats(stat);
 
         // valid function bytecode must always end with RETURN
         // we elide this if we're guaranteed to hit a RETURN statement regardless of the control flow
@@ -243,6 +309,9 @@ struct Compiler
 
         bytecode.expandJumps();
 
+        if (options.optimizationLevel >= 1)
+            bytecode.fuseInstructions();
+
         popLocals(0);
 
         bytecode.endFunction(uint8_t(stackSize), uint8_t(upvals.size()));
@@ -520,6 +589,29 @@ struct Compiler
                 return false;
             }
 
+        // objects created by inlined code would be attributed to the memory category of the caller
+        const uint8_t* category = moduleCategories.find(func);
+
+        if ((category ? *category : 0) != functionCategory && Compile::mayAllocate(func))
+        {
+            bytecode.addDebugRemark("inlining failed: function allocates in another memory category");
+            return false;
+        }
+
+        // inlined code captures the upvalues of the function again, which only works for locals of the main chunk when the function comes
+        // from another module; the main chunk declares module values before any code that can call module functions
+        const Compile::LinkedModule* const* module = moduleFunctions.find(func);
+
+        if ((module ? *module : nullptr) != functionModule)
+        {
+            for (AstLocal* uv : fi->upvals)
+                if (uv->functionDepth != 0 && getLocalReg(uv) < 0)
+                {
+                    bytecode.addDebugRemark("inlining failed: function captures locals of another module");
+                    return false;
+                }
+        }
+
         // we can't inline multret functions because the caller expects L->top to be adjusted:
         // - inlined return compiles to a JUMP, and we don't have an instruction that adjusts L->top arbitrarily
         // - even if we did, right now all L->top adjustments are immediately consumed by the next instruction, and for now we want to preserve that
@@ -642,7 +734,7 @@ struct Compiler
         }
 
         // fold constant values updated above into expressions in the function body
-        foldConstants(constants, variables, locstants, builtinsFold, func->body);
+        foldConstants(constants, variables, locstants, builtinsFold, constantGlobalsFold, func->body);
 
         bool usedFallthrough = false;
 
@@ -683,7 +775,7 @@ struct Compiler
             if (Constant* var = locstants.find(func->args.data[i]))
                 var->type = Constant::Type_Unknown;
 
-        foldConstants(constants, variables, locstants, builtinsFold, func->body);
+        foldConstants(constants, variables, locstants, builtinsFold, constantGlobalsFold, func->body);
     }
 
     void compileExprCall(AstExprCall* expr, uint8_t target, uint8_t targetCount, bool targetTop = false, bool multRet = false)
@@ -947,21 +1039,21 @@ struct Compiler
         }
     }
 
-    LuauOpcode getBinaryOpArith(AstExprBinary::Op op, bool k = false)
+    LuauOpcode getBinaryOpArith(AstExprBinary::Op op, bool k = false, bool number = false)
     {
         switch (op)
         {
         case AstExprBinary::Add:
-            return k ? LOP_ADDK : LOP_ADD;
+            return k ? LOP_ADDK : number ? LOP_ADDN : LOP_ADD;
 
         case AstExprBinary::Sub:
-            return k ? LOP_SUBK : LOP_SUB;
+            return k ? LOP_SUBK : number ? LOP_SUBN : LOP_SUB;
 
         case AstExprBinary::Mul:
-            return k ? LOP_MULK : LOP_MUL;
+            return k ? LOP_MULK : number ? LOP_MULN : LOP_MUL;
 
         case AstExprBinary::Div:
-            return k ? LOP_DIVK : LOP_DIV;
+            return k ? LOP_DIVK : number ? LOP_DIVN : LOP_DIV;
 
         case AstExprBinary::Mod:
             return k ? LOP_MODK : LOP_MOD;
@@ -975,6 +1067,89 @@ struct Compiler
         }
     }
 
+    LuauOpcode getJumpOpCompareNumber(LuauOpcode op)
+    {
+        switch (op)
+        {
+        case LOP_JUMPIFLT:
+            return LOP_JUMPIFLTN;
+
+        case LOP_JUMPIFLE:
+            return LOP_JUMPIFLEN;
+
+        case LOP_JUMPIFNOTLT:
+            return LOP_JUMPIFNOTLTN;
+
+        case LOP_JUMPIFNOTLE:
+            return LOP_JUMPIFNOTLEN;
+
+        default:
+            return op;
+        }
+    }
+
+    static bool isNumberType(AstType* type)
+    {
+        AstTypeReference* ref = type ? type->as<AstTypeReference>() : nullptr;
+
+        return ref && !ref->prefix && !ref->hasParameterList && ref->name == "number";
+    }
+
+    // returns true if the expression is known to produce a number based on type annotations and numeric for loops
+    // note: annotations are verified by the type checker but values typed as any can still violate them; the VM checks specialized instructions
+    bool isNumberExpr(AstExpr* node)
+    {
+        if (options.optimizationLevel < 1)
+            return false;
+
+        if (const Constant* cv = constants.find(node); cv && cv->type != Constant::Type_Unknown)
+            return cv->type == Constant::Type_Number;
+
+        if (AstExprGroup* expr = node->as<AstExprGroup>())
+            return isNumberExpr(expr->expr);
+
+        if (AstExprTypeAssertion* expr = node->as<AstExprTypeAssertion>())
+            return isNumberType(expr->annotation) || isNumberExpr(expr->expr);
+
+        if (AstExprLocal* expr = node->as<AstExprLocal>())
+        {
+            if (isNumberType(expr->local->annotation))
+                return true;
+
+            Variable* lv = variables.find(expr->local);
+
+            if (lv && lv->written)
+                return false;
+
+            if (numberLocals.contains(expr->local))
+                return true;
+
+            return lv && lv->init && isNumberExpr(lv->init);
+        }
+
+        if (AstExprUnary* expr = node->as<AstExprUnary>())
+            return expr->op == AstExprUnary::Minus && isNumberExpr(expr->expr);
+
+        if (AstExprBinary* expr = node->as<AstExprBinary>())
+        {
+            switch (expr->op)
+            {
+            case AstExprBinary::Add:
+            case AstExprBinary::Sub:
+            case AstExprBinary::Mul:
+            case AstExprBinary::Div:
+            case AstExprBinary::Mod:
+            case AstExprBinary::Pow:
+                return isNumberExpr(expr->left) && isNumberExpr(expr->right);
+
+            default:
+                return false;
+            }
+        }
+
+        return false;
+    }
+
     LuauOpcode getJumpOpCompare(AstExprBinary::Op op, bool not_ = false)
     {
         switch (op)
@@ -1044,6 +1219,10 @@ struct Compiler
                 std::swap(left, right);
         }
 
+        // Optimization: number comparisons don't need to check operand types and metamethods
+        if (!isEq && isNumberExpr(left) && isNumberExpr(right))
+            opc = getJumpOpCompareNumber(opc);
+
         uint8_t rl = compileExprAuto(left, rs);
         int32_t rr = -1;
 
@@ -1392,7 +1571,9 @@ struct Compiler
                 uint8_t rl = compileExprAuto(expr->left, rs);
                 uint8_t rr = compileExprAuto(expr->right, rs);
 
-                bytecode.emitABC(getBinaryOpArith(expr->op), target, rl, rr);
+                bool number = isNumberExpr(expr->left) && isNumberExpr(expr->right);
+
+                bytecode.emitABC(getBinaryOpArith(expr->op, /* k= */ false, number), target, rl, rr);
             }
         }
         break;
@@ -1668,6 +1849,18 @@ struct Compiler
     {
         setDebugLine(expr); // normally compileExpr sets up line info, but compileExprIndexName can be called directly
 
+        if (int reg = getScalarFieldReg(expr); reg >= 0)
+        {
+            bytecode.emitABC(LOP_MOVE, target, uint8_t(reg), 0);
+            return;
+        }
+
+        if (int reg = getHoistedLoadReg(expr); reg >= 0)
+        {
+            bytecode.emitABC(LOP_MOVE, target, uint8_t(reg), 0);
+            return;
+        }
+
         // Optimization: index chains that start from global variables can be compiled into GETIMPORT statement
         AstExprGlobal* importRoot = 0;
         AstExprIndexName* import1 = 0;
@@ -1764,6 +1957,12 @@ struct Compiler
 
     void compileExprGlobal(AstExprGlobal* expr, uint8_t target)
     {
+        if (int reg = getHoistedLoadReg(expr); reg >= 0)
+        {
+            bytecode.emitABC(LOP_MOVE, target, uint8_t(reg), 0);
+            return;
+        }
+
         // Optimization: builtin globals can be retrieved using GETIMPORT
         if (canImport(expr))
         {
@@ -1844,6 +2043,94 @@ struct Compiler
         }
     }
 
+    static bool isConstantGlobalPath(const char* name, const char* path, size_t length)
+    {
+        return strncmp(name, path, length) == 0 && (name[length] == '.' || name[length] == 0);
+    }
+
+    // loads the value of a constant global; paths that only prefix other constant globals, like config.drive, are loaded as tables that
+    // are frozen since constant globals are assumed to be read-only
+    void compileConstantGlobal(AstExpr* node, const char* path, size_t length, uint8_t target)
+    {
+        for (const CompileConstant* ptr = options.constantGlobals; ptr->name; ++ptr)
+            if (strlen(ptr->name) == length && isConstantGlobalPath(ptr->name, path, length))
+            {
+                Constant cv = getConstantGlobal(*ptr);
+
+                if (cv.type != Constant::Type_Unknown)
+                    compileExprConstant(node, &cv, target);
+                else
+                    bytecode.emitABC(LOP_LOADNIL, target, 0, 0);
+                return;
+            }
+
+        bytecode.emitABC(LOP_NEWTABLE, target, 0, 0);
+        bytecode.emitAux(0);
+
+        for (const CompileConstant* ptr = options.constantGlobals; ptr->name; ++ptr)
+        {
+            if (strlen(ptr->name) <= length || !isConstantGlobalPath(ptr->name, path, length))
+                continue;
+
+            const char* key = ptr->name + length + 1;
+            const char* dot = strchr(key, '.');
+            size_t keyLength = dot ? dot - key : strlen(key);
+
+            // each field is created by the first constant global under it
+            bool created = false;
+
+            for (const CompileConstant* prev = options.constantGlobals; prev != ptr && !created; ++prev)
+                created = isConstantGlobalPath(prev->name, ptr->name, length + 1 + keyLength);
+
+            if (created)
+                continue;
+
+            RegScope rs(this);
+            uint8_t reg = allocReg(node, 1);
+
+            compileConstantGlobal(node, ptr->name, length + 1 + keyLength, reg);
+
+            LValue lv = {LValue::Kind_IndexName};
+            lv.reg = target;
+            lv.name = {key, keyLength};
+            lv.location = node->location;
+
+            compileLValueUse(lv, reg, /* set= */ true);
+        }
+
+        RegScope rs(this);
+        uint8_t regs = allocReg(node, 2);
+
+        int32_t id0 = bytecode.addConstantString({"table", 5});
+        int32_t id1 = bytecode.addConstantString({"freeze", 6});
+        int32_t cid = (id0 >= 0 && id1 >= 0 && id0 < 1024 && id1 < 1024) ? bytecode.addImport(BytecodeBuilder::getImportId(id0, id1)) : -1;
+
+        if (cid < 0 || cid >= 32768)
+            CompileError::raise(node->location, "Exceeded constant limit; simplify the code to compile");
+
+        bytecode.emitAD(LOP_GETIMPORT, regs, int16_t(cid));
+        bytecode.emitAux(BytecodeBuilder::getImportId(id0, id1));
+        bytecode.emitABC(LOP_MOVE, uint8_t(regs + 1), target, 0);
+        bytecode.emitABC(LOP_CALL, regs, 2, 1);
+    }
+
+    void compileUnfoldedGlobals(AstExprFunction* func)
+    {
+        for (AstName name : unfoldedGlobals)
+        {
+            RegScope rs(this);
+            uint8_t reg = allocReg(func, 1);
+
+            compileConstantGlobal(func, name.value, strlen(name.value), reg);
+
+            LValue lv = {LValue::Kind_Global};
+            lv.name = sref(name);
+            lv.location = func->location;
+
+            compileLValueUse(lv, reg, /* set= */ true);
+        }
+    }
+
     void compileExpr(AstExpr* node, uint8_t target, bool targetTemp = false)
     {
         setDebugLine(node);
@@ -1860,6 +2147,32 @@ struct Compiler
             return;
         }
 
+        // Optimization: if expression was computed earlier in the same run of statements, we can reuse its value; see compileCommonExprs
+        if (int index = getCommonExpr(node); index >= 0)
+        {
+            uint8_t reg = commonExprs[index].reg;
+
+            if (commonExprs[index].filled)
+            {
+                bytecode.emitABC(LOP_MOVE, target, reg, 0);
+                return;
+            }
+
+            if (commonExprs[index].first == node)
+            {
+                // note: the vector may be reallocated while compiling the expression, so we can't keep a reference to the element
+                commonExprs[index].first = nullptr;
+                compileExpr(node, reg);
+                commonExprs[index].first = node;
+                commonExprs[index].filled = true;
+
+                if (reg != target)
+                    bytecode.emitABC(LOP_MOVE, target, reg, 0);
+
+                return;
+            }
+        }
+
         if (AstExprGroup* expr = node->as<AstExprGroup>())
         {
             compileExpr(expr->expr, target, targetTemp);
@@ -1968,6 +2281,16 @@ struct Compiler
         if (int reg = getExprLocalReg(node); reg >= 0)
             return uint8_t(reg);
 
+        // Optimization: compute common subexpressions directly into their register
+        if (int index = getCommonExpr(node); index >= 0 && commonExprs[index].first == node)
+        {
+            uint8_t reg = commonExprs[index].reg;
+
+            compileExpr(node, reg);
+
+            return reg;
+        }
+
         // note: the register is owned by the parent scope
         uint8_t reg = allocReg(node, 1);
 
@@ -2123,6 +2446,15 @@ struct Compiler
         }
         else if (AstExprIndexName* expr = node->as<AstExprIndexName>())
         {
+            if (int reg = getScalarFieldReg(expr); reg >= 0)
+            {
+                LValue result = {LValue::Kind_Local};
+                result.reg = uint8_t(reg);
+                result.location = node->location;
+
+                return result;
+            }
+
             LValue result = {LValue::Kind_IndexName};
             result.reg = compileExprAuto(expr->expr, rs);
             result.name = sref(expr->index);
@@ -2222,121 +2554,579 @@ struct Compiler
 
             return l && l->allocated ? l->reg : -1;
         }
+        else if (AstExprIndexName* expr = node->as<AstExprIndexName>())
+        {
+            if (int reg = getScalarFieldReg(expr); reg >= 0)
+                return reg;
+
+            if (int reg = getHoistedLoadReg(expr); reg >= 0)
+                return reg;
+
+            return getCommonExprReg(expr);
+        }
+        else if (AstExprGlobal* expr = node->as<AstExprGlobal>())
+            return getHoistedLoadReg(expr);
         else
-            return -1;
+            return getCommonExprReg(node);
     }
 
-    bool isStatBreak(AstStat* node)
+    // fields of tables replaced with registers behave like locals; see compileStatLocal
+    int getScalarFieldReg(AstExprIndexName* expr)
     {
-        if (AstStatBlock* stat = node->as<AstStatBlock>())
-            return stat->body.size == 1 && stat->body.data[0]->is<AstStatBreak>();
+        AstExprLocal* table = expr->expr->as<AstExprLocal>();
+        if (!table)
+            return -1;
 
-        return node->is<AstStatBreak>();
+        const uint8_t* reg = scalarTableRegs.find(table->local);
+        if (!reg)
+            return -1;
+
+        const ScalarTable* st = scalarTables.find(table->local);
+        LUAU_ASSERT(st && !st->escapes);
+
+        int field = getScalarTableField(st->table, expr->index);
+        LUAU_ASSERT(field >= 0);
+
+        return *reg + field;
     }
 
-    AstStatContinue* extractStatContinue(AstStatBlock* block)
+    // loads computed before the enclosing loops behave like locals; see compileLoopInvariants
+    int getHoistedLoadReg(AstExpr* expr)
     {
-        if (block->body.size == 1)
-            return block->body.data[0]->as<AstStatContinue>();
-        else
-            return nullptr;
+        for (const HoistedLoad& load : hoistedLoads)
+            if (isSameLoad(load.expr, expr))
+                return load.reg;
+
+        return -1;
     }
 
-    void compileStatIf(AstStatIf* stat)
+    // Optimization: loads that produce the same value on every iteration are computed once before the loop
+    void getLoopInvariants(std::vector<AstExpr*>& loads, AstStatBlock* body, AstExpr* condition, bool fields)
     {
-        // Optimization: condition is always false => we only need the else body
-        if (isConstantFalse(stat->condition))
-        {
-            if (stat->elsebody)
-                compileStat(stat->elsebody);
+        if (options.optimizationLevel < 1 || getfenvUsed || setfenvUsed)
             return;
-        }
-
-        // Optimization: body is a "break" statement with no "else" => we can directly break out of the loop in "then" case
-        if (!stat->elsebody && isStatBreak(stat->thenbody) && !areLocalsCaptured(loops.back().localOffset))
-        {
-            // fallthrough = continue with the loop as usual
-            std::vector<size_t> elseJump;
-            compileConditionValue(stat->condition, nullptr, elseJump, true);
 
-            for (size_t jump : elseJump)
-                loopJumps.push_back({LoopJump::Break, jump});
-            return;
-        }
+        // field loads may invoke __index a different number of times, so unlike imports they are only hoisted on level 2
+        findLoopInvariants(loads, globals, variables, builtins, body, condition, fields && options.optimizationLevel >= 2);
 
-        AstStat* continueStatement = extractStatContinue(stat->thenbody);
+        size_t count = 0;
 
-        // Optimization: body is a "continue" statement with no "else" => we can directly continue in "then" case
-        if (!stat->elsebody && continueStatement != nullptr && !areLocalsCaptured(loops.back().localOffset))
+        for (AstExpr* load : loads)
         {
-            if (loops.back().untilCondition)
-                validateContinueUntil(continueStatement, loops.back().untilCondition);
-
-            // fallthrough = proceed with the loop body as usual
-            std::vector<size_t> elseJump;
-            compileConditionValue(stat->condition, nullptr, elseJump, true);
-
-            for (size_t jump : elseJump)
-                loopJumps.push_back({LoopJump::Continue, jump});
-            return;
-        }
+            if (count == kMaxHoistedLoads)
+                break;
 
-        std::vector<size_t> elseJump;
-        compileConditionValue(stat->condition, nullptr, elseJump, false);
+            // loads hoisted by enclosing loops are reused as is
+            if (getHoistedLoadReg(load) >= 0)
+                continue;
 
-        compileStat(stat->thenbody);
+            if (const Constant* cv = constants.find(load); cv && cv->type != Constant::Type_Unknown)
+                continue;
 
-        if (stat->elsebody && elseJump.size() > 0)
-        {
-            // we don't need to skip past "else" body if "then" ends with return
-            // this is important because, if "else" also ends with return, we may *not* have any statement to skip to!
-            if (allPathsEndWithReturn(stat->thenbody))
+            if (AstExprLocal* root = getLoadRoot(load))
             {
-                size_t elseLabel = bytecode.emitLabel();
+                // the root must already be in scope; locals declared in the body are allocated later
+                const Local* l = locals.find(root->local);
 
-                compileStat(stat->elsebody);
+                if (!(l && l->allocated) && !root->upvalue)
+                    continue;
 
-                patchJumps(stat, elseJump, elseLabel);
+                if (scalarTableRegs.contains(root->local))
+                    continue;
             }
-            else
-            {
-                size_t thenLabel = bytecode.emitLabel();
-
-                bytecode.emitAD(LOP_JUMP, 0, 0);
-
-                size_t elseLabel = bytecode.emitLabel();
 
-                compileStat(stat->elsebody);
+            loads[count++] = load;
+        }
 
-                size_t endLabel = bytecode.emitLabel();
+        // every hoisted load takes a register for the duration of the loop, so we leave most of the frame to the body
+        loads.resize(regTop + count > kMaxRegisterCount / 2 ? 0 : count);
+    }
 
-                patchJumps(stat, elseJump, elseLabel);
-                patchJump(stat, thenLabel, endLabel);
-            }
-        }
-        else
+    // note: the caller must only run this code if the loop body runs at least once, see findLoopInvariants
+    void compileLoopInvariants(const std::vector<AstExpr*>& loads, uint8_t regs)
+    {
+        for (size_t i = 0; i < loads.size(); ++i)
         {
-            size_t endLabel = bytecode.emitLabel();
+            compileExpr(loads[i], uint8_t(regs + i));
 
-            patchJumps(stat, elseJump, endLabel);
+            hoistedLoads.push_back({loads[i], uint8_t(regs + i)});
         }
     }
 
-    void compileStatWhile(AstStatWhile* stat)
+    // expressions computed earlier in the same run of statements behave like locals; see compileCommonExprs
+    int getCommonExprReg(AstExpr* node)
     {
-        // Optimization: condition is always false => there's no loop!
-        if (isConstantFalse(stat->condition))
-            return;
+        int index = getCommonExpr(node);
+
+        return index >= 0 && commonExprs[index].filled ? commonExprs[index].reg : -1;
+    }
+
+    int getCommonExpr(AstExpr* node)
+    {
+        const size_t* index = commonExprOccurrences.find(node);
+
+        // occurrences from runs that were already compiled may refer to entries that have since been reused
+        if (!index || *index >= commonExprs.size())
+            return -1;
+
+        const CommonExpr& ce = commonExprs[*index];
+
+        return ce.first && isSameExpr(ce.first, node) ? int(*index) : -1;
+    }
+
+    // Optimization: expressions that are evaluated more than once in a run of statements are computed once into a register
+    void compileCommonExprs(AstStatBlock* block, size_t start, size_t end)
+    {
+        if (options.optimizationLevel < 1 || getfenvUsed || setfenvUsed)
+            return;
+
+        size_t oldExprs = commonExprs.size();
+
+        findCommonExprs(commonExprs, commonExprOccurrences, globals, variables, builtins, block, start, end);
+
+        size_t count = 0;
+
+        for (size_t i = oldExprs; i < commonExprs.size(); ++i)
+        {
+            CommonExpr& ce = commonExprs[i];
+
+            if (!ce.first)
+                continue;
+
+            bool skip = false;
+
+            if (const Constant* cv = constants.find(ce.first); cv && cv->type != Constant::Type_Unknown)
+                skip = true;
+
+            // expressions that already live in a register, like hoisted loads, don't need another one
+            if (getExprLocalReg(ce.first) >= 0)
+                skip = true;
+
+            // field reads and arithmetic on values that aren't known to be numbers may invoke metamethods, which can have side effects or
+            // return a new object every time, e.g. a vector __add, so these are never reused
+            if (!isNumberExpr(ce.first))
+                skip = true;
+
+            if (count == kMaxCommonExprs)
+                skip = true;
+
+            if (skip)
+                ce.first = nullptr;
+            else
+                count++;
+        }
+
+        // every common expression takes a register for the rest of the run, so we leave most of the frame to the statements
+        if (count == 0 || regTop + count > kMaxRegisterCount / 2)
+        {
+            commonExprs.resize(oldExprs);
+            return;
+        }
+
+        uint8_t regs = allocReg(block->body.data[start], unsigned(count));
+
+        for (size_t i = oldExprs; i < commonExprs.size(); ++i)
+            if (commonExprs[i].first)
+                commonExprs[i].reg = regs++;
+    }
+
+    void compileStats(AstStatBlock* block)
+    {
+        for (size_t start = 0; start < block->body.size;)
+        {
+            size_t end = getStatementRun(block, start);
+
+            size_t oldExprs = commonExprs.size();
+            size_t oldLocals = localStack.size();
+            size_t oldScalarTables = scalarTableRegs.size();
+            unsigned int oldTop = regTop;
+
+            compileCommonExprs(block, start, end);
+
+            for (size_t i = start; i < end; ++i)
+                compileStat(block->body.data[i]);
+
+            commonExprs.resize(oldExprs);
+
+            // registers of common expressions are released unless locals or scalar replaced tables declared in the run were allocated above them
+            if (localStack.size() == oldLocals && scalarTableRegs.size() == oldScalarTables)
+                regTop = oldTop;
+
+            start = end;
+        }
+    }
+
+    bool isStatBreak(AstStat* node)
+    {
+        if (AstStatBlock* stat = node->as<AstStatBlock>())
+            return stat->body.size == 1 && stat->body.data[0]->is<AstStatBreak>();
+
+        return node->is<AstStatBreak>();
+    }
+
+    AstStatContinue* extractStatContinue(AstStatBlock* block)
+    {
+        if (block->body.size == 1)
+            return block->body.data[0]->as<AstStatContinue>();
+        else
+            return nullptr;
+    }
+
+    // matches "local == constant" and "constant == local"
+    AstExprLocal* getCompareEqualConstant(AstExpr* node, Constant& key)
+    {
+        AstExprBinary* expr = node->as<AstExprBinary>();
+        if (!expr || expr->op != AstExprBinary::CompareEq)
+            return nullptr;
+
+        AstExpr* left = expr->left;
+        AstExpr* right = expr->right;
+
+        if (isConstant(left))
+            std::swap(left, right);
+
+        AstExprLocal* local = getExprLocal(left);
+        if (!local || !isConstant(right))
+            return nullptr;
+
+        key = getConstant(right);
+        return local;
+    }
+
+    // finds a shift that maps string hashes to distinct slots in a table of the given size
+    static bool findJumpTableHash(const std::vector<uint32_t>& hashes, uint32_t size, uint32_t& shift)
+    {
+        for (shift = 0; (1ull << shift) * size <= (1ull << 32); ++shift)
+        {
+            bool used[kJumpTableMaxEntries] = {};
+            bool collision = false;
+
+            for (uint32_t h : hashes)
+            {
+                uint32_t slot = (h >> shift) & (size - 1);
+
+                if (used[slot])
+                {
+                    collision = true;
+                    break;
+                }
+
+                used[slot] = true;
+            }
+
+            if (!collision)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Optimization: chains of "if x == K1 then ... elseif x == K2 then ..." over number or string constants dispatch through a jump table
+    bool tryCompileJumpTable(AstStatIf* stat)
+    {
+        AstExprLocal* var = nullptr;
+        std::vector<std::pair<Constant, AstStat*>> cases;
+
+        // the chain ends at the first condition that doesn't fit; the rest of the chain becomes the default case
+        AstStat* rest = stat;
+
+        while (AstStatIf* current = rest ? rest->as<AstStatIf>() : nullptr)
+        {
+            Constant key;
+            AstExprLocal* expr = getCompareEqualConstant(current->condition, key);
+
+            if (!expr || (var && expr->local != var->local))
+                break;
+
+            if (key.type != Constant::Type_Number && key.type != Constant::Type_String)
+                break;
+
+            if (!cases.empty() && key.type != cases[0].first.type)
+                break;
+
+            var = expr;
+            cases.push_back(std::make_pair(key, current->thenbody));
+            rest = current->elsebody;
+        }
+
+        if (cases.size() < kJumpTableMinCases)
+            return false;
+
+        bool isString = cases[0].first.type == Constant::Type_String;
+
+        // entry index for every case
+        std::vector<uint32_t> slots;
+        uint32_t entries = 0;
+        uint32_t aux = 0;
+
+        if (isString)
+        {
+            std::vector<uint32_t> hashes;
+
+            for (auto& c : cases)
+            {
+                // compiler string hash only matches the VM for short strings
+                if (c.first.stringLength >= 32)
+                    return false;
+
+                hashes.push_back(BytecodeBuilder::getStringHash(sref(c.first.getString())));
+            }
+
+            entries = 1;
+            while (entries < cases.size())
+                entries *= 2;
+
+            while (entries <= kJumpTableMaxEntries && !findJumpTableHash(hashes, entries, aux))
+                entries *= 2;
+
+            // identical strings have identical hashes, so this also rejects duplicate cases
+            if (entries > kJumpTableMaxEntries)
+                return false;
+
+            for (uint32_t h : hashes)
+                slots.push_back((h >> aux) & (entries - 1));
+        }
+        else
+        {
+            double min = cases[0].first.valueNumber;
+            double max = min;
+
+            for (auto& c : cases)
+            {
+                double v = c.first.valueNumber;
+
+                if (!(v >= -2147483648.0 && v <= 2147483647.0) || double(int32_t(v)) != v)
+                    return false;
+
+                min = std::min(min, v);
+                max = std::max(max, v);
+            }
+
+            // sparse tables waste space and cache lines for little benefit over the compare chain
+            if (max - min + 1 > kJumpTableMaxEntries || max - min + 1 > cases.size() * 2)
+                return false;
+
+            entries = uint32_t(max - min + 1);
+            aux = uint32_t(int32_t(min));
+
+            std::vector<bool> used(entries);
+
+            for (auto& c : cases)
+            {
+                uint32_t slot = uint32_t(c.first.valueNumber - min);
+
+                if (used[slot])
+                    return false;
+
+                used[slot] = true;
+                slots.push_back(slot);
+            }
+        }
+
+        // entries that no case maps to compare with nil and jump to the default case
+        std::vector<int32_t> keys(entries, -1);
+        std::vector<size_t> entryLabels(entries);
+
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            keys[slots[i]] = isString ? bytecode.addConstantString(sref(cases[i].first.getString()))
+                                      : bytecode.addConstantNumber(cases[i].first.valueNumber);
+
+            if (keys[slots[i]] < 0)
+                CompileError::raise(stat->location, "Exceeded constant limit; simplify the code to compile");
+        }
+
+        {
+            RegScope rs(this);
+            uint8_t reg = compileExprAuto(var, rs);
+
+            int32_t nilKey = bytecode.addConstantNil();
+            if (nilKey < 0)
+                CompileError::raise(stat->location, "Exceeded constant limit; simplify the code to compile");
+
+            bytecode.emitABC(LOP_JUMPTABLE, reg, uint8_t(entries), isString ? 1 : 0);
+            bytecode.emitAux(aux);
+
+            for (uint32_t i = 0; i < entries; ++i)
+            {
+                entryLabels[i] = bytecode.emitLabel();
+                bytecode.emitAD(LOP_JUMPIFEQK, reg, 0);
+                bytecode.emitAux(keys[i] >= 0 ? keys[i] : nilKey);
+            }
+        }
+
+        std::vector<size_t> endJumps;
+
+        size_t defaultLabel = bytecode.emitLabel();
+
+        if (rest)
+            compileStat(rest);
+
+        if (!rest || !allPathsEndWithReturn(rest))
+        {
+            endJumps.push_back(bytecode.emitLabel());
+            bytecode.emitAD(LOP_JUMP, 0, 0);
+        }
+
+        std::vector<size_t> caseLabels;
+
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            caseLabels.push_back(bytecode.emitLabel());
+
+            compileStat(cases[i].second);
+
+            if (i + 1 < cases.size() && !allPathsEndWithReturn(cases[i].second))
+            {
+                endJumps.push_back(bytecode.emitLabel());
+                bytecode.emitAD(LOP_JUMP, 0, 0);
+            }
+        }
+
+        size_t endLabel = bytecode.emitLabel();
+
+        std::vector<size_t> entryTargets(entries, defaultLabel);
+
+        for (size_t i = 0; i < cases.size(); ++i)
+            entryTargets[slots[i]] = caseLabels[i];
+
+        for (uint32_t i = 0; i < entries; ++i)
+            patchJump(stat, entryLabels[i], entryTargets[i]);
+
+        patchJumps(stat, endJumps, endLabel);
+
+        return true;
+    }
+
+    void compileStatIf(AstStatIf* stat)
+    {
+        // Optimization: condition is always false => we only need the else body
+        if (isConstantFalse(stat->condition))
+        {
+            if (stat->elsebody)
+                compileStat(stat->elsebody);
+            return;
+        }
+
+        if (options.optimizationLevel >= 1 && tryCompileJumpTable(stat))
+            return;
+
+        // Optimization: body is a "break" statement with no "else" => we can directly break out of the loop in "then" case
+        if (!stat->elsebody && isStatBreak(stat->thenbody) && !areLocalsCaptured(loops.back().localOffset))
+        {
+            // fallthrough = continue with the loop as usual
+            std::vector<size_t> elseJump;
+            compileConditionValue(stat->condition, nullptr, elseJump, true);
+
+            for (size_t jump : elseJump)
+                loopJumps.push_back({LoopJump::Break, jump});
+            return;
+        }
+
+        AstStat* continueStatement = extractStatContinue(stat->thenbody);
+
+        // Optimization: body is a "continue" statement with no "else" => we can directly continue in "then" case
+        if (!stat->elsebody && continueStatement != nullptr && !areLocalsCaptured(loops.back().localOffset))
+        {
+            if (loops.back().untilCondition)
+                validateContinueUntil(continueStatement, loops.back().untilCondition);
+
+            // fallthrough = proceed with the loop body as usual
+            std::vector<size_t> elseJump;
+            compileConditionValue(stat->condition, nullptr, elseJump, true);
+
+            for (size_t jump : elseJump)
+                loopJumps.push_back({LoopJump::Continue, jump});
+            return;
+        }
+
+        std::vector<size_t> elseJump;
+        compileConditionValue(stat->condition, nullptr, elseJump, false);
+
+        compileStat(stat->thenbody);
+
+        if (stat->elsebody && elseJump.size() > 0)
+        {
+            // we don't need to skip past "else" body if "then" ends with return
+            // this is important because, if "else" also ends with return, we may *not* have any statement to skip to!
+            if (allPathsEndWithReturn(stat->thenbody))
+            {
+                size_t elseLabel = bytecode.emitLabel();
+
+                compileStat(stat->elsebody);
+
+                patchJumps(stat, elseJump, elseLabel);
+            }
+            else
+            {
+                size_t thenLabel = bytecode.emitLabel();
+
+                bytecode.emitAD(LOP_JUMP, 0, 0);
+
+                size_t elseLabel = bytecode.emitLabel();
+
+                compileStat(stat->elsebody);
+
+                size_t endLabel = bytecode.emitLabel();
+
+                patchJumps(stat, elseJump, elseLabel);
+                patchJump(stat, thenLabel, endLabel);
+            }
+        }
+        else
+        {
+            size_t endLabel = bytecode.emitLabel();
+
+            patchJumps(stat, elseJump, endLabel);
+        }
+    }
+
+    void compileStatWhile(AstStatWhile* stat)
+    {
+        // Optimization: condition is always false => there's no loop!
+        if (isConstantFalse(stat->condition))
+            return;
+
+        RegScope rs(this);
 
         size_t oldJumps = loopJumps.size();
         size_t oldLocals = localStack.size();
+        size_t oldLoads = hoistedLoads.size();
 
         loops.push_back({oldLocals, nullptr});
 
-        size_t loopLabel = bytecode.emitLabel();
+        std::vector<AstExpr*> invariants;
+        getLoopInvariants(invariants, stat->body, stat->condition, /* fields= */ true);
 
         std::vector<size_t> elseJump;
-        compileConditionValue(stat->condition, nullptr, elseJump, false);
+        size_t loopLabel;
+
+        if (!invariants.empty() && !isConstantTrue(stat->condition))
+        {
+            // the first iteration checks the condition before the hoisted loads so that they only run if the body does
+            compileConditionValue(stat->condition, nullptr, elseJump, false);
+            compileLoopInvariants(invariants, allocReg(stat, unsigned(invariants.size())));
+
+            size_t entryLabel = bytecode.emitLabel();
+            bytecode.emitAD(LOP_JUMP, 0, 0);
+
+            loopLabel = bytecode.emitLabel();
+
+            compileConditionValue(stat->condition, nullptr, elseJump, false);
+
+            size_t bodyLabel = bytecode.emitLabel();
+
+            patchJump(stat, entryLabel, bodyLabel);
+        }
+        else
+        {
+            if (!invariants.empty())
+                compileLoopInvariants(invariants, allocReg(stat, unsigned(invariants.size())));
+
+            loopLabel = bytecode.emitLabel();
+
+            compileConditionValue(stat->condition, nullptr, elseJump, false);
+        }
 
         compileStat(stat->body);
 
@@ -2357,6 +3147,7 @@ struct Compiler
 
         patchLoopJumps(stat, oldJumps, endLabel, contLabel);
         loopJumps.resize(oldJumps);
+        hoistedLoads.resize(oldLoads);
 
         loops.pop_back();
     }
@@ -2365,19 +3156,26 @@ struct Compiler
     {
         size_t oldJumps = loopJumps.size();
         size_t oldLocals = localStack.size();
+        size_t oldLoads = hoistedLoads.size();
 
         loops.push_back({oldLocals, stat->condition});
 
-        size_t loopLabel = bytecode.emitLabel();
-
         // note: we "inline" compileStatBlock here so that we can close/pop locals after evaluating condition
         // this is necessary because condition can access locals declared inside the repeat..until body
         AstStatBlock* body = stat->body;
 
         RegScope rs(this);
 
-        for (size_t i = 0; i < body->body.size; ++i)
-            compileStat(body->body.data[i]);
+        // the body of repeat..until always runs at least once
+        std::vector<AstExpr*> invariants;
+        getLoopInvariants(invariants, body, stat->condition, /* fields= */ true);
+
+        if (!invariants.empty())
+            compileLoopInvariants(invariants, allocReg(stat, unsigned(invariants.size())));
+
+        size_t loopLabel = bytecode.emitLabel();
+
+        compileStats(body);
 
         size_t contLabel = bytecode.emitLabel();
 
@@ -2421,6 +3219,7 @@ struct Compiler
 
         patchLoopJumps(stat, oldJumps, endLabel, contLabel);
         loopJumps.resize(oldJumps);
+        hoistedLoads.resize(oldLoads);
 
         loops.pop_back();
     }
@@ -2523,6 +3322,24 @@ struct Compiler
             }
         }
 
+        // Optimization: tables that never escape are replaced with a register per field, and field accesses become register accesses
+        if (options.optimizationLevel >= 2 && stat->vars.size == 1 && stat->values.size == 1)
+        {
+            if (const ScalarTable* st = scalarTables.find(stat->vars.data[0]); st && !st->escapes)
+            {
+                LUAU_ASSERT(st->table == stat->values.data[0]);
+
+                // note: allocReg in this case allocates into parent block register - note that we don't have RegScope here
+                uint8_t regs = allocReg(stat, unsigned(st->table->items.size));
+
+                for (size_t i = 0; i < st->table->items.size; ++i)
+                    compileExprTemp(st->table->items.data[i].value, uint8_t(regs + i));
+
+                scalarTableRegs[stat->vars.data[0]] = regs;
+                return;
+            }
+        }
+
         // note: allocReg in this case allocates into parent block register - note that we don't have RegScope here
         uint8_t vars = allocReg(stat, unsigned(stat->vars.size));
 
@@ -2602,7 +3419,7 @@ struct Compiler
             locstants[var].type = Constant::Type_Number;
             locstants[var].valueNumber = from + iv * step;
 
-            foldConstants(constants, variables, locstants, builtinsFold, stat);
+            foldConstants(constants, variables, locstants, builtinsFold, constantGlobalsFold, stat);
 
             size_t iterJumps = loopJumps.size();
 
@@ -2630,7 +3447,7 @@ struct Compiler
         // clean up fold state in case we need to recompile - normally we compile the loop body once, but due to inlining we may need to do it again
         locstants[var].type = Constant::Type_Unknown;
 
-        foldConstants(constants, variables, locstants, builtinsFold, stat);
+        foldConstants(constants, variables, locstants, builtinsFold, constantGlobalsFold, stat);
     }
 
     void compileStatFor(AstStatFor* stat)
@@ -2671,6 +3488,15 @@ struct Compiler
 
         bytecode.emitAD(LOP_FORNPREP, regs, 0);
 
+        // FORNPREP skips the loop if it has no iterations, which guards the hoisted loads
+        size_t oldLoads = hoistedLoads.size();
+
+        std::vector<AstExpr*> invariants;
+        getLoopInvariants(invariants, stat->body, nullptr, /* fields= */ true);
+
+        if (!invariants.empty())
+            compileLoopInvariants(invariants, allocReg(stat, unsigned(invariants.size())));
+
         size_t loopLabel = bytecode.emitLabel();
 
         if (varreg != regs + 2)
@@ -2678,6 +3504,9 @@ struct Compiler
 
         pushLocal(stat->var, varreg);
 
+        // numeric for loop variables are numbers unless the body assigns them
+        numberLocals.insert(stat->var);
+
         compileStat(stat->body);
 
         closeLocals(oldLocals);
@@ -2698,6 +3527,7 @@ struct Compiler
 
         patchLoopJumps(stat, oldJumps, endLabel, contLabel);
         loopJumps.resize(oldJumps);
+        hoistedLoads.resize(oldLoads);
 
         loops.pop_back();
     }
@@ -2711,22 +3541,12 @@ struct Compiler
 
         loops.push_back({oldLocals, nullptr});
 
-        // register layout: generator, state, index, variables...
-        uint8_t regs = allocReg(stat, 3);
-
-        // this puts initial values of (generator, state, index) into the loop registers
-        compileExprListTemp(stat->values, regs, 3, /* targetTop= */ true);
-
-        // note that we reserve at least 2 variables; this allows our fast path to assume that we need 2 variables instead of 1 or 2
-        uint8_t vars = allocReg(stat, std::max(unsigned(stat->vars.size), 2u));
-        LUAU_ASSERT(vars == regs + 3);
-
         LuauOpcode skipOp = LOP_FORGPREP;
         LuauOpcode loopOp = LOP_FORGLOOP;
 
         // Optimization: when we iterate via pairs/ipairs, we generate special bytecode that optimizes the traversal using internal iteration index
         // These instructions dynamically check if generator is equal to next/inext and bail out
-        // They assume that the generator produces 2 variables, which is why we allocate at least 2 above (see vars assignment)
+        // They assume that the generator produces 2 variables, which is why we allocate at least 2 below (see vars assignment)
         if (options.optimizationLevel >= 1 && stat->vars.size <= 2)
         {
             if (stat->values.size == 1 && stat->values.data[0]->is<AstExprCall>())
@@ -2756,12 +3576,36 @@ struct Compiler
             }
         }
 
+        // pairs/ipairs/next don't run user code, but other generators can modify any table
+        size_t oldLoads = hoistedLoads.size();
+
+        std::vector<AstExpr*> invariants;
+        getLoopInvariants(invariants, stat->body, nullptr, /* fields= */ skipOp != LOP_FORGPREP);
+
+        // hoisted loads are placed below the loop registers since FORGLOOP uses the stack past the index as the generator's frame
+        uint8_t hoisted = invariants.empty() ? 0 : allocReg(stat, unsigned(invariants.size()));
+
+        // register layout: generator, state, index, variables...
+        uint8_t regs = allocReg(stat, 3);
+
+        // this puts initial values of (generator, state, index) into the loop registers
+        compileExprListTemp(stat->values, regs, 3, /* targetTop= */ true);
+
+        // note that we reserve at least 2 variables; this allows our fast path to assume that we need 2 variables instead of 1 or 2
+        uint8_t vars = allocReg(stat, std::max(unsigned(stat->vars.size), 2u));
+        LUAU_ASSERT(vars == regs + 3);
+
         // first iteration jumps into FORGLOOP instruction, but for ipairs/pairs it does extra preparation that makes the cost of an extra instruction
         // worthwhile
         size_t skipLabel = bytecode.emitLabel();
 
         bytecode.emitAD(skipOp, regs, 0);
 
+        size_t hoistLabel = bytecode.emitLabel();
+
+        if (!invariants.empty())
+            compileLoopInvariants(invariants, hoisted);
+
         size_t loopLabel = bytecode.emitLabel();
 
         for (size_t i = 0; i < stat->vars.size; ++i)
@@ -2778,6 +3622,44 @@ struct Compiler
 
         size_t backLabel = bytecode.emitLabel();
 
+        compileForInLoop(stat, skipOp, loopOp, regs);
+
+        size_t endLabel;
+
+        if (invariants.empty())
+        {
+            endLabel = bytecode.emitLabel();
+
+            patchJump(stat, skipLabel, backLabel);
+        }
+        else
+        {
+            // the first iteration goes through a separate copy of the loop instruction that enters the loop through the hoisted loads
+            size_t exitLabel = bytecode.emitLabel();
+            bytecode.emitAD(LOP_JUMP, 0, 0);
+
+            size_t entryLabel = bytecode.emitLabel();
+
+            compileForInLoop(stat, skipOp, loopOp, regs);
+
+            endLabel = bytecode.emitLabel();
+
+            patchJump(stat, skipLabel, entryLabel);
+            patchJump(stat, entryLabel, hoistLabel);
+            patchJump(stat, exitLabel, endLabel);
+        }
+
+        patchJump(stat, backLabel, loopLabel);
+
+        patchLoopJumps(stat, oldJumps, endLabel, contLabel);
+        loopJumps.resize(oldJumps);
+        hoistedLoads.resize(oldLoads);
+
+        loops.pop_back();
+    }
+
+    void compileForInLoop(AstStatForIn* stat, LuauOpcode skipOp, LuauOpcode loopOp, uint8_t regs)
+    {
         bytecode.emitAD(loopOp, regs, 0);
 
         if (FFlag::LuauCompileNoIpairs)
@@ -2791,16 +3673,6 @@ struct Compiler
         // note: FORGLOOP needs variable count encoded in AUX field, other loop instructions assume a fixed variable count
         else if (loopOp == LOP_FORGLOOP)
             bytecode.emitAux(uint32_t(stat->vars.size));
-
-        size_t endLabel = bytecode.emitLabel();
-
-        patchJump(stat, skipLabel, backLabel);
-        patchJump(stat, backLabel, loopLabel);
-
-        patchLoopJumps(stat, oldJumps, endLabel, contLabel);
-        loopJumps.resize(oldJumps);
-
-        loops.pop_back();
     }
 
     void resolveAssignConflicts(AstStat* stat, std::vector<LValue>& vars)
@@ -2938,7 +3810,9 @@ struct Compiler
             {
                 uint8_t rr = compileExprAuto(stat->value, rs);
 
-                bytecode.emitABC(getBinaryOpArith(stat->op), target, target, rr);
+                bool number = isNumberExpr(stat->var) && isNumberExpr(stat->value);
+
+                bytecode.emitABC(getBinaryOpArith(stat->op, /* k= */ false, number), target, target, rr);
             }
         }
         break;
@@ -3002,8 +3876,7 @@ struct Compiler
 
             size_t oldLocals = localStack.size();
 
-            for (size_t i = 0; i < stat->body.size; ++i)
-                compileStat(stat->body.data[i]);
+            compileStats(stat);
 
             closeLocals(oldLocals);
 
@@ -3090,6 +3963,9 @@ struct Compiler
         else if (AstStatAssign* stat = node->as<AstStatAssign>())
         {
             compileStatAssign(stat);
+
+            if (!fields.empty())
+                assignedFields.insert(stat);
         }
         else if (AstStatCompoundAssign* stat = node->as<AstStatCompoundAssign>())
         {
@@ -3098,6 +3974,9 @@ struct Compiler
         else if (AstStatFunction* stat = node->as<AstStatFunction>())
         {
             compileStatFunction(stat);
+
+            if (!fields.empty())
+                assignedFields.insert(stat);
         }
         else if (AstStatLocalFunction* stat = node->as<AstStatLocalFunction>())
         {
@@ -3531,6 +4410,12 @@ struct Compiler
         AstExpr* untilCondition;
     };
 
+    struct HoistedLoad
+    {
+        AstExpr* expr;
+        uint8_t reg;
+    };
+
     struct InlineFrame
     {
         AstExprFunction* func;
@@ -3562,9 +4447,24 @@ struct Compiler
     DenseHashMap<AstExprTable*, TableShape> tableShapes;
     DenseHashMap<AstExprCall*, int> builtins;
     const DenseHashMap<AstExprCall*, int>* builtinsFold = nullptr;
+    DenseHashMap<std::string, Constant> constantGlobals;
+    const DenseHashMap<std::string, Constant>* constantGlobalsFold = nullptr;
+    DenseHashMap<TableField, FieldValue, TableFieldHash> fields;
+    DenseHashSet<AstStat*> assignedFields;
+    DenseHashSet<AstLocal*> numberLocals;
+    DenseHashMap<AstLocal*, ScalarTable> scalarTables;
+    DenseHashMap<AstLocal*, uint8_t> scalarTableRegs;
+    DenseHashMap<AstExpr*, size_t> commonExprOccurrences;
+    DenseHashMap<AstExprFunction*, uint8_t> moduleCategories;
+    DenseHashMap<AstExprFunction*, const Compile::LinkedModule*> moduleFunctions;
 
     unsigned int regTop = 0;
     unsigned int stackSize = 0;
+    size_t functionDepth = 0;
+    uint8_t functionCategory = 0;
+    const Compile::LinkedModule* functionModule = nullptr;
+
+    std::vector<AstName> unfoldedGlobals;
 
     bool getfenvUsed = false;
     bool setfenvUsed = false;
@@ -3574,10 +4474,13 @@ struct Compiler
     std::vector<LoopJump> loopJumps;
     std::vector<Loop> loops;
     std::vector<InlineFrame> inlineFrames;
+    std::vector<HoistedLoad> hoistedLoads;
+    std::vector<CommonExpr> commonExprs;
     std::vector<Capture> captures;
 };
 
-void compileOrThrow(BytecodeBuilder& bytecode, const ParseResult& parseResult, const AstNameTable& names, const CompileOptions& inputOptions)
+static void compileModules(BytecodeBuilder& bytecode, const ParseResult& parseResult, const AstNameTable& names, const CompileOptions& inputOptions,
+    const std::vector<Compile::LinkedModule>& modules)
 {
     LUAU_TIMETRACE_SCOPE("compileOrThrow", "Compiler");
 
@@ -3594,34 +4497,67 @@ void compileOrThrow(BytecodeBuilder& bytecode, const ParseResult& parseResult, c
 
     Compiler compiler(bytecode, options);
 
+    // functions of linked modules allocate in the memory categories of their modules; categories have to be added before the first function
+    Compile::assignModuleCategories(compiler.moduleCategories, bytecode, modules);
+    Compile::assignModuleFunctions(compiler.moduleFunctions, modules);
+
     // since access to some global objects may result in values that change over time, we block imports from non-readonly tables
     assignMutable(compiler.globals, names, options.mutableGlobals);
 
     // this pass analyzes mutability of locals/globals and associates locals with their initial values
     trackValues(compiler.globals, compiler.variables, root);
+    Compile::aliasModuleValues(compiler.variables, modules);
+
+    // this pass tracks functions stored in local tables, which allows inlining calls like M.f() on optimization level 2
+    if (options.optimizationLevel >= 2)
+    {
+        DenseHashSet<AstLocal*> escaped(nullptr);
+        findEscapedTables(escaped, compiler.variables, root);
+
+        trackFields(compiler.fields, compiler.variables, escaped, names, root);
+    }
+
+    // this visitor tracks calls to getfenv/setfenv and disables some optimizations when they are found
+    if (options.optimizationLevel >= 1 && (names.get("getfenv").value || names.get("setfenv").value))
+    {
+        Compiler::FenvVisitor fenvVisitor(compiler.getfenvUsed, compiler.setfenvUsed);
+        root->visit(&fenvVisitor);
+    }
 
     // builtin folding is enabled on optimization level 2 since we can't deoptimize folding at runtime
     if (options.optimizationLevel >= 2 && FFlag::LuauCompileFoldBuiltins)
         compiler.builtinsFold = &compiler.builtins;
 
+    // constant globals are folded unless the environment can be replaced at runtime
+    if (options.optimizationLevel >= 1 && options.constantGlobals && !compiler.getfenvUsed && !compiler.setfenvUsed)
+    {
+        assignConstantGlobals(compiler.constantGlobals, compiler.globals, names, options.constantGlobals);
+
+        if (!compiler.constantGlobals.empty())
+            compiler.constantGlobalsFold = &compiler.constantGlobals;
+    }
+
     if (options.optimizationLevel >= 1)
     {
         // this pass tracks which calls are builtins and can be compiled more efficiently
         analyzeBuiltins(compiler.builtins, compiler.globals, compiler.variables, options, root);
 
         // this pass analyzes constantness of expressions
-        foldConstants(compiler.constants, compiler.variables, compiler.locstants, compiler.builtinsFold, root);
+        foldConstants(compiler.constants, compiler.variables, compiler.locstants, compiler.builtinsFold, compiler.constantGlobalsFold, root);
+
+        // this pass removes dead branches, unused local functions and unused fields of local tables, including unused module exports
+        removeUnusedCode(compiler.constants, compiler.variables, names, root);
 
         // this pass analyzes table assignments to estimate table shapes for initially empty tables
         predictTableShapes(compiler.tableShapes, root);
     }
 
-    // this visitor tracks calls to getfenv/setfenv and disables some optimizations when they are found
-    if (options.optimizationLevel >= 1 && (names.get("getfenv").value || names.get("setfenv").value))
-    {
-        Compiler::FenvVisitor fenvVisitor(compiler.getfenvUsed, compiler.setfenvUsed);
-        root->visit(&fenvVisitor);
-    }
+    // constant globals that can't be folded everywhere they are read are created at runtime, see compileUnfoldedGlobals
+    findUnfoldedGlobals(compiler.unfoldedGlobals, compiler.constants, compiler.globals, names, options.constantGlobals, root);
+
+    // this pass finds local tables that can be replaced with registers; the table disappears from the debugger, hence level 2
+    if (options.optimizationLevel >= 2)
+        analyzeEscapes(compiler.scalarTables, root);
 
     // gathers all functions with the invariant that all function references are to functions earlier in the list
     // for example, function foo() return function() end end will result in two vector entries, [0] = anonymous and [1] = foo
@@ -3630,7 +4566,21 @@ void compileOrThrow(BytecodeBuilder& bytecode, const ParseResult& parseResult, c
     root->visit(&functionVisitor);
 
     for (AstExprFunction* expr : functions)
-        compiler.compileFunction(expr);
+    {
+        try
+        {
+            compiler.compileFunction(expr);
+        }
+        catch (CompileError& e)
+        {
+            const Compile::LinkedModule* const* module = compiler.moduleFunctions.find(expr);
+
+            if (!module)
+                throw;
+
+            CompileError::raise(e.getLocation(), "Error compiling module %s: %s", (*module)->name.value, e.what());
+        }
+    }
 
     AstExprFunction main(root->location, /*generics= */ AstArray<AstGenericType>(), /*genericPacks= */ AstArray<AstGenericTypePack>(),
         /* self= */ nullptr, AstArray<AstLocal*>(), /* vararg= */ Luau::Location(), root, /* functionDepth= */ 0, /* debugname= */ AstName());
@@ -3643,6 +4593,11 @@ void compileOrThrow(BytecodeBuilder& bytecode, const ParseResult& parseResult, c
     bytecode.finalize();
 }
 
+void compileOrThrow(BytecodeBuilder& bytecode, const ParseResult& parseResult, const AstNameTable& names, const CompileOptions& inputOptions)
+{
+    compileModules(bytecode, parseResult, names, inputOptions, {});
+}
+
 void compileOrThrow(BytecodeBuilder& bytecode, const std::string& source, const CompileOptions& options, const ParseOptions& parseOptions)
 {
     Allocator allocator;
@@ -3655,6 +4610,22 @@ void compileOrThrow(BytecodeBuilder& bytecode, const std::string& source, const
     compileOrThrow(bytecode, result, names, options);
 }
 
+void compileProgramOrThrow(BytecodeBuilder& bytecode, const std::string& source, CompileModuleResolver& resolver, const CompileOptions& options,
+    const ParseOptions& parseOptions)
+{
+    Allocator allocator;
+    AstNameTable names(allocator);
+    ParseResult result = Parser::parse(source.c_str(), source.size(), names, allocator, parseOptions);
+
+    if (!result.errors.empty())
+        throw ParseErrors(result.errors);
+
+    std::vector<Compile::LinkedModule> modules;
+    result.root = Compile::linkModules(result.root, resolver, names, allocator, parseOptions, modules);
+
+    compileModules(bytecode, result, names, options, modules);
+}
+
 std::string compile(const std::string& source, const CompileOptions& options, const ParseOptions& parseOptions, BytecodeEncoder* encoder)
 {
     LUAU_TIMETRACE_SCOPE("compile", "Compiler");
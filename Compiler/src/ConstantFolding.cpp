@@ -3,7 +3,13 @@
 
 #include "BuiltinFolding.h"
 
+#include "Luau/Compiler.h"
+#include "Luau/Lexer.h"
+
+#include <algorithm>
+
 #include <math.h>
+#include <string.h>
 
 namespace Luau
 {
@@ -189,6 +195,27 @@ static void foldBinary(Constant& result, AstExprBinary::Op op, const Constant& l
     }
 }
 
+// computes the dotted path for global field chains like config.drive.ratio
+static bool getGlobalPath(AstExpr* node, std::string& result)
+{
+    if (AstExprGlobal* expr = node->as<AstExprGlobal>())
+    {
+        result = expr->name.value;
+        return true;
+    }
+    else if (AstExprIndexName* expr = node->as<AstExprIndexName>(); expr && expr->op == '.')
+    {
+        if (!getGlobalPath(expr->expr, result))
+            return false;
+
+        result += '.';
+        result += expr->index.value;
+        return true;
+    }
+
+    return false;
+}
+
 struct ConstantVisitor : AstVisitor
 {
     DenseHashMap<AstExpr*, Constant>& constants;
@@ -196,17 +223,21 @@ struct ConstantVisitor : AstVisitor
     DenseHashMap<AstLocal*, Constant>& locals;
 
     const DenseHashMap<AstExprCall*, int>* builtins;
+    const DenseHashMap<std::string, Constant>* constantGlobals;
 
     bool wasEmpty = false;
 
     std::vector<Constant> builtinArgs;
+    std::string globalPath;
 
     ConstantVisitor(DenseHashMap<AstExpr*, Constant>& constants, DenseHashMap<AstLocal*, Variable>& variables,
-        DenseHashMap<AstLocal*, Constant>& locals, const DenseHashMap<AstExprCall*, int>* builtins)
+        DenseHashMap<AstLocal*, Constant>& locals, const DenseHashMap<AstExprCall*, int>* builtins,
+        const DenseHashMap<std::string, Constant>* constantGlobals)
         : constants(constants)
         , variables(variables)
         , locals(locals)
         , builtins(builtins)
+        , constantGlobals(constantGlobals)
     {
         // since we do a single pass over the tree, if the initial state was empty we don't need to clear out old entries
         wasEmpty = constants.empty() && locals.empty();
@@ -248,9 +279,11 @@ struct ConstantVisitor : AstVisitor
             if (l)
                 result = *l;
         }
-        else if (node->is<AstExprGlobal>())
+        else if (AstExprGlobal* expr = node->as<AstExprGlobal>())
         {
-            // nope
+            if (constantGlobals)
+                if (const Constant* c = constantGlobals->find(expr->name.value))
+                    result = *c;
         }
         else if (node->is<AstExprVarargs>())
         {
@@ -295,6 +328,10 @@ struct ConstantVisitor : AstVisitor
         else if (AstExprIndexName* expr = node->as<AstExprIndexName>())
         {
             analyze(expr->expr);
+
+            if (constantGlobals && getGlobalPath(expr, globalPath))
+                if (const Constant* c = constantGlobals->find(globalPath))
+                    result = *c;
         }
         else if (AstExprIndexExpr* expr = node->as<AstExprIndexExpr>())
         {
@@ -430,10 +467,121 @@ struct ConstantVisitor : AstVisitor
     }
 };
 
+struct UnfoldedGlobalVisitor : AstVisitor
+{
+    const DenseHashMap<AstExpr*, Constant>& constants;
+    const DenseHashSet<AstName>& roots;
+    std::vector<AstName>& result;
+
+    UnfoldedGlobalVisitor(const DenseHashMap<AstExpr*, Constant>& constants, const DenseHashSet<AstName>& roots, std::vector<AstName>& result)
+        : constants(constants)
+        , roots(roots)
+        , result(result)
+    {
+    }
+
+    bool visit(AstExpr* node) override
+    {
+        // folded expressions don't read the globals they refer to at runtime
+        const Constant* cv = constants.find(node);
+
+        return !cv || cv->type == Constant::Type_Unknown;
+    }
+
+    bool visit(AstExprGlobal* node) override
+    {
+        if (visit(static_cast<AstExpr*>(node)) && roots.contains(node->name))
+            if (std::find(result.begin(), result.end(), node->name) == result.end())
+                result.push_back(node->name);
+
+        return false;
+    }
+};
+
+// globals that aren't mentioned in the source can't be read, and globals that are assigned to don't have a value we can reason about
+static AstName getConstantGlobalRoot(const DenseHashMap<AstName, Global>& globals, const AstNameTable& names, const char* path)
+{
+    const char* dot = strchr(path, '.');
+    std::string root = dot ? std::string(path, dot - path) : std::string(path);
+
+    AstName name = names.get(root.c_str());
+
+    return name.value && getGlobalState(globals, name) != Global::Written ? name : AstName();
+}
+
+Constant getConstantGlobal(const CompileConstant& constant)
+{
+    Constant value;
+
+    switch (constant.type)
+    {
+    case 0:
+        value.type = Constant::Type_Nil;
+        break;
+
+    case 1:
+        value.type = Constant::Type_Boolean;
+        value.valueBoolean = constant.valueNumber != 0;
+        break;
+
+    case 2:
+        value.type = Constant::Type_Number;
+        value.valueNumber = constant.valueNumber;
+        break;
+
+    case 3:
+        LUAU_ASSERT(constant.valueString);
+        value.type = Constant::Type_String;
+        value.valueString = constant.valueString;
+        value.stringLength = unsigned(strlen(constant.valueString));
+        break;
+
+    default:
+        LUAU_ASSERT(!"Unknown constant type");
+    }
+
+    return value;
+}
+
+void assignConstantGlobals(DenseHashMap<std::string, Constant>& result, const DenseHashMap<AstName, Global>& globals, const AstNameTable& names,
+    const CompileConstant* constantGlobals)
+{
+    if (!constantGlobals)
+        return;
+
+    for (const CompileConstant* ptr = constantGlobals; ptr->name; ++ptr)
+    {
+        if (!getConstantGlobalRoot(globals, names, ptr->name).value)
+            continue;
+
+        Constant value = getConstantGlobal(*ptr);
+
+        if (value.type != Constant::Type_Unknown)
+            result[ptr->name] = value;
+    }
+}
+
+void findUnfoldedGlobals(std::vector<AstName>& result, const DenseHashMap<AstExpr*, Constant>& constants,
+    const DenseHashMap<AstName, Global>& globals, const AstNameTable& names, const CompileConstant* constantGlobals, AstNode* root)
+{
+    if (!constantGlobals)
+        return;
+
+    DenseHashSet<AstName> roots{AstName()};
+
+    for (const CompileConstant* ptr = constantGlobals; ptr->name; ++ptr)
+        if (AstName name = getConstantGlobalRoot(globals, names, ptr->name); name.value)
+            roots.insert(name);
+
+    UnfoldedGlobalVisitor visitor{constants, roots, result};
+    root->visit(&visitor);
+}
+
 void foldConstants(DenseHashMap<AstExpr*, Constant>& constants, DenseHashMap<AstLocal*, Variable>& variables,
-    DenseHashMap<AstLocal*, Constant>& locals, const DenseHashMap<AstExprCall*, int>* builtins, AstNode* root)
+    DenseHashMap<AstLocal*, Constant>& locals, const DenseHashMap<AstExprCall*, int>* builtins,
+    const DenseHashMap<std::string, Constant>* constantGlobals, AstNode* root)
 {
-    ConstantVisitor visitor{constants, variables, locals, builtins};
+    ConstantVisitor visitor{constants, variables, locals, builtins, constantGlobals};
     root->visit(&visitor);
 }
 
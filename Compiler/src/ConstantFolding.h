@@ -3,6 +3,14 @@
 
 #include "ValueTracking.h"
 
+#include <string>
+#include <vector>
+
+namespace Luau
+{
+struct CompileConstant;
+}
+
 namespace Luau
 {
 namespace Compile
@@ -42,8 +50,19 @@ struct Constant
     }
 };
 
+// converts a constant global passed in CompileOptions to the representation used for folding
+Constant getConstantGlobal(const CompileConstant& constant);
+
+void assignConstantGlobals(DenseHashMap<std::string, Constant>& result, const DenseHashMap<AstName, Global>& globals, const AstNameTable& names,
+    const CompileConstant* constantGlobals);
 void foldConstants(DenseHashMap<AstExpr*, Constant>& constants, DenseHashMap<AstLocal*, Variable>& variables,
-    DenseHashMap<AstLocal*, Constant>& locals, const DenseHashMap<AstExprCall*, int>* builtins, AstNode* root);
+    DenseHashMap<AstLocal*, Constant>& locals, const DenseHashMap<AstExprCall*, int>* builtins,
+    const DenseHashMap<std::string, Constant>* constantGlobals, AstNode* root);
+
+// finds the constant globals that are read without being folded, like config in local drive = config.drive or in any read when folding is
+// disabled; must run after foldConstants when it runs at all
+void findUnfoldedGlobals(std::vector<AstName>& result, const DenseHashMap<AstExpr*, Constant>& constants,
+    const DenseHashMap<AstName, Global>& globals, const AstNameTable& names, const CompileConstant* constantGlobals, AstNode* root);
 
 } // namespace Compile
 } // namespace Luau
@@ -0,0 +1,115 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#include "EscapeAnalysis.h"
+
+#include <string.h>
+
+namespace Luau
+{
+namespace Compile
+{
+
+// every field gets a register for the lifetime of the local, so we only replace small tables
+static const size_t kMaxScalarTableFields = 16;
+
+static bool isScalarConstructor(AstExprTable* table)
+{
+    if (table->items.size == 0 || table->items.size > kMaxScalarTableFields)
+        return false;
+
+    for (size_t i = 0; i < table->items.size; ++i)
+    {
+        const AstExprTable::Item& item = table->items.data[i];
+
+        if (item.kind == AstExprTable::Item::List)
+            return false;
+
+        AstExprConstantString* key = item.key->as<AstExprConstantString>();
+        if (!key)
+            return false;
+
+        // duplicate keys would need to evaluate both values and keep the last one
+        for (size_t j = 0; j < i; ++j)
+        {
+            AstExprConstantString* other = table->items.data[j].key->as<AstExprConstantString>();
+
+            if (other->value.size == key->value.size && memcmp(other->value.data, key->value.data, key->value.size) == 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int getScalarTableField(AstExprTable* table, AstName name)
+{
+    size_t length = strlen(name.value);
+
+    for (size_t i = 0; i < table->items.size; ++i)
+    {
+        AstExprConstantString* key = table->items.data[i].key->as<AstExprConstantString>();
+        LUAU_ASSERT(key);
+
+        if (key->value.size == length && memcmp(key->value.data, name.value, length) == 0)
+            return int(i);
+    }
+
+    return -1;
+}
+
+struct EscapeVisitor : AstVisitor
+{
+    DenseHashMap<AstLocal*, ScalarTable>& tables;
+
+    EscapeVisitor(DenseHashMap<AstLocal*, ScalarTable>& tables)
+        : tables(tables)
+    {
+    }
+
+    bool visit(AstStatLocal* node) override
+    {
+        if (node->vars.size == 1 && node->values.size == 1)
+        {
+            AstExprTable* table = node->values.data[0]->as<AstExprTable>();
+
+            if (table && isScalarConstructor(table))
+                tables[node->vars.data[0]].table = table;
+        }
+
+        return true;
+    }
+
+    bool visit(AstExprIndexName* node) override
+    {
+        if (AstExprLocal* expr = node->expr->as<AstExprLocal>())
+        {
+            if (ScalarTable* st = tables.find(expr->local))
+            {
+                // method calls pass the table as an argument, and fields can't be kept in registers of another function
+                if (node->op != '.' || expr->upvalue || getScalarTableField(st->table, node->index) < 0)
+                    st->escapes = true;
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool visit(AstExprLocal* node) override
+    {
+        // any other use of the local, including assignments to it, needs the table object
+        if (ScalarTable* st = tables.find(node->local))
+            st->escapes = true;
+
+        return false;
+    }
+};
+
+void analyzeEscapes(DenseHashMap<AstLocal*, ScalarTable>& tables, AstNode* root)
+{
+    EscapeVisitor visitor{tables};
+    root->visit(&visitor);
+}
+
+} // namespace Compile
+} // namespace Luau
@@ -0,0 +1,26 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#pragma once
+
+#include "Luau/Ast.h"
+#include "Luau/DenseHash.h"
+
+namespace Luau
+{
+namespace Compile
+{
+
+struct ScalarTable
+{
+    AstExprTable* table = nullptr; // constructor that initializes the local; all keys are distinct constant strings
+    bool escapes = false;          // is the table used as a value, or through fields that the constructor doesn't define?
+};
+
+// finds locals initialized with table constructors that are only used to read and write the constructor's fields within the declaring
+// function, e.g. local p = {x = a, y = b} return p.x * p.y; such tables can be replaced with a register per field
+void analyzeEscapes(DenseHashMap<AstLocal*, ScalarTable>& tables, AstNode* root);
+
+// returns the index of the constructor item that defines the field, or -1 if the constructor doesn't define it
+int getScalarTableField(AstExprTable* table, AstName name);
+
+} // namespace Compile
+} // namespace Luau
@@ -0,0 +1,268 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#include "LoopInvariants.h"
+
+#include <string.h>
+
+namespace Luau
+{
+namespace Compile
+{
+
+// import chains are limited to 3 components by GETIMPORT encoding; see Compiler::compileExprIndexName
+static bool isImportChain(AstExpr* node, const DenseHashMap<AstName, Global>& globals)
+{
+    if (AstExprGlobal* expr = node->as<AstExprGlobal>())
+        return getGlobalState(globals, expr->name) != Global::Written;
+
+    AstExprIndexName* index = node->as<AstExprIndexName>();
+    if (!index || index->op != '.')
+        return false;
+
+    AstExprGlobal* root = index->expr->as<AstExprGlobal>();
+
+    if (AstExprIndexName* inner = index->expr->as<AstExprIndexName>(); inner && inner->op == '.')
+        root = inner->expr->as<AstExprGlobal>();
+
+    return root && getGlobalState(globals, root->name) == Global::Default;
+}
+
+AstExprLocal* getLoadRoot(AstExpr* load)
+{
+    AstExprIndexName* index = load->as<AstExprIndexName>();
+    if (!index || index->op != '.')
+        return nullptr;
+
+    while (AstExprIndexName* inner = index->expr->as<AstExprIndexName>())
+    {
+        if (inner->op != '.')
+            return nullptr;
+
+        index = inner;
+    }
+
+    return index->expr->as<AstExprLocal>();
+}
+
+bool isSameLoad(AstExpr* a, AstExpr* b)
+{
+    if (AstExprIndexName* ia = a->as<AstExprIndexName>())
+    {
+        AstExprIndexName* ib = b->as<AstExprIndexName>();
+
+        return ib && ia->op == ib->op && ia->index == ib->index && isSameLoad(ia->expr, ib->expr);
+    }
+    else if (AstExprGlobal* ga = a->as<AstExprGlobal>())
+    {
+        AstExprGlobal* gb = b->as<AstExprGlobal>();
+
+        return gb && ga->name == gb->name;
+    }
+    else if (AstExprLocal* la = a->as<AstExprLocal>())
+    {
+        AstExprLocal* lb = b->as<AstExprLocal>();
+
+        return lb && la->local == lb->local;
+    }
+
+    return false;
+}
+
+struct LoopLoadVisitor : AstVisitor
+{
+    std::vector<AstExpr*>& loads;
+
+    const DenseHashMap<AstName, Global>& globals;
+    const DenseHashMap<AstLocal*, Variable>& variables;
+    const TableWrites& writes;
+
+    bool imports;
+    bool chains;
+    bool fields;
+
+    LoopLoadVisitor(std::vector<AstExpr*>& loads, const DenseHashMap<AstName, Global>& globals, const DenseHashMap<AstLocal*, Variable>& variables,
+        const TableWrites& writes, bool imports, bool chains, bool fields)
+        : loads(loads)
+        , globals(globals)
+        , variables(variables)
+        , writes(writes)
+        , imports(imports)
+        , chains(chains)
+        , fields(fields)
+    {
+    }
+
+    void add(AstExpr* load)
+    {
+        for (AstExpr* other : loads)
+            if (isSameLoad(other, load))
+                return;
+
+        loads.push_back(load);
+    }
+
+    bool isWritten(AstExprIndexName* chain)
+    {
+        AstExprIndexName* index = chain;
+
+        while (!writes.fields.contains(index->index))
+        {
+            AstExprIndexName* inner = index->expr->as<AstExprIndexName>();
+
+            if (!inner)
+            {
+                // _G.math = t changes the value of import chains that start from math
+                AstExprGlobal* root = index->expr->as<AstExprGlobal>();
+
+                return root && writes.fields.contains(root->name);
+            }
+
+            index = inner;
+        }
+
+        return true;
+    }
+
+    bool visit(AstExprFunction* node) override
+    {
+        // nested functions have their own registers
+        return false;
+    }
+
+    bool visit(AstExprCall* node) override
+    {
+        // the function is moved into the call frame either way, and builtin calls skip loading it on the fast path
+        if (isImportChain(node->func, globals))
+        {
+            for (size_t i = 0; i < node->args.size; ++i)
+                node->args.data[i]->visit(this);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    bool visit(AstExprGlobal* node) override
+    {
+        if (imports && isImportChain(node, globals) && !writes.fields.contains(node->name))
+            add(node);
+
+        return false;
+    }
+
+    bool visit(AstExprIndexName* node) override
+    {
+        if (chains && isImportChain(node, globals) && !isWritten(node))
+        {
+            add(node);
+            return false;
+        }
+
+        if (fields)
+        {
+            if (AstExprLocal* root = getLoadRoot(node))
+            {
+                const Variable* var = variables.find(root->local);
+
+                if ((!var || !var->written) && !isWritten(node))
+                {
+                    add(node);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+};
+
+// only visits expressions that are always evaluated when the enclosing expression is
+struct UnconditionalLoadVisitor : LoopLoadVisitor
+{
+    using LoopLoadVisitor::LoopLoadVisitor;
+
+    bool visit(AstExprBinary* node) override
+    {
+        if (node->op == AstExprBinary::And || node->op == AstExprBinary::Or)
+        {
+            node->left->visit(this);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool visit(AstExprIfElse* node) override
+    {
+        node->condition->visit(this);
+        return false;
+    }
+};
+
+// finds references to globals that can be used to modify the environment that imports are resolved in
+struct EnvironmentVisitor : AstVisitor
+{
+    bool used = false;
+
+    bool visit(AstExprGlobal* node) override
+    {
+        if (strcmp(node->name.value, "_G") == 0 || strcmp(node->name.value, "getfenv") == 0 || strcmp(node->name.value, "setfenv") == 0)
+            used = true;
+
+        return false;
+    }
+};
+
+void findLoopInvariants(std::vector<AstExpr*>& loads, const DenseHashMap<AstName, Global>& globals,
+    const DenseHashMap<AstLocal*, Variable>& variables, const DenseHashMap<AstExprCall*, int>& builtins, AstStatBlock* body, AstExpr* condition,
+    bool fields)
+{
+    TableWrites writes;
+    trackTableWrites(writes, builtins, body);
+
+    if (condition)
+        trackTableWrites(writes, builtins, condition);
+
+    EnvironmentVisitor environment;
+    body->visit(&environment);
+
+    if (condition)
+        condition->visit(&environment);
+
+    // GETIMPORT looks the global up again unless the value resolved at load time is not nil and the environment is safe, so imports are only
+    // invariant if the loop can't modify the environment; functions that we don't know anything about could, for example through _G
+    bool stable = !writes.calls && !writes.dynamic;
+    bool imports = stable && !environment.used;
+
+    if (imports)
+    {
+        LoopLoadVisitor anywhere{loads, globals, variables, writes, imports, /* chains= */ false, /* fields= */ false};
+        body->visit(&anywhere);
+
+        if (condition)
+            condition->visit(&anywhere);
+    }
+
+    UnconditionalLoadVisitor prefix{loads, globals, variables, writes, imports, /* chains= */ imports, /* fields= */ fields && stable};
+
+    for (size_t i = 0; i < body->body.size; ++i)
+    {
+        AstStat* stat = body->body.data[i];
+
+        if (stat->is<AstStatLocal>() || stat->is<AstStatAssign>() || stat->is<AstStatCompoundAssign>() || stat->is<AstStatExpr>())
+        {
+            stat->visit(&prefix);
+        }
+        else
+        {
+            // the condition is evaluated before the branches, everything after it may not run on the first iteration
+            if (AstStatIf* ifs = stat->as<AstStatIf>())
+                ifs->condition->visit(&prefix);
+
+            break;
+        }
+    }
+}
+
+} // namespace Compile
+} // namespace Luau
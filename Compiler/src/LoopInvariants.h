@@ -0,0 +1,39 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#pragma once
+
+#include "Luau/Ast.h"
+#include "Luau/DenseHash.h"
+
+#include "ValueTracking.h"
+
+#include <vector>
+
+namespace Luau
+{
+namespace Compile
+{
+
+// finds loads that produce the same value on every iteration of a loop, in the order of their first use:
+// - imports of a global like print; these can be collected from anywhere in the loop since reading a global can't fail
+// - import chains like math.sin; indexing the global can fail, so these are only collected from expressions that the first iteration
+//   evaluates unconditionally, so that computing them before the loop can't raise an error that the loop itself wouldn't
+// - GETIMPORT looks imports up again on every execution unless the value resolved at load time is not nil and the environment is safe, so
+//   imports are only collected when the loop can't modify the environment: it doesn't call functions other than builtins, doesn't assign
+//   through computed keys, doesn't assign a field with the name of the global or any name in the chain, and doesn't reference _G, getfenv
+//   or setfenv
+// - field chains like self.config.kP that start from a local that is never assigned, when the loop doesn't write a field with any of the
+//   names in the chain and doesn't call functions other than builtins; like import chains, these are only collected unconditionally
+// condition is evaluated on every iteration together with the body and may be nullptr; fields enables collection of field chains
+// note: like trackFields, this assumes that metamethods don't modify tables
+void findLoopInvariants(std::vector<AstExpr*>& loads, const DenseHashMap<AstName, Global>& globals,
+    const DenseHashMap<AstLocal*, Variable>& variables, const DenseHashMap<AstExprCall*, int>& builtins, AstStatBlock* body, AstExpr* condition,
+    bool fields);
+
+// returns true if both expressions are the same import or field chain
+bool isSameLoad(AstExpr* a, AstExpr* b);
+
+// returns the root local of a field chain, or nullptr for imports
+AstExprLocal* getLoadRoot(AstExpr* load);
+
+} // namespace Compile
+} // namespace Luau
@@ -0,0 +1,321 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#include "RequireGraph.h"
+
+#include "Luau/BytecodeBuilder.h"
+#include "Luau/Compiler.h"
+#include "Luau/Parser.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <string.h>
+
+namespace Luau
+{
+namespace Compile
+{
+
+// the value of a module is tracked through the local it returns, so the only return a module can have is the one that produces its value
+struct ModuleReturnVisitor : AstVisitor
+{
+    const std::string& name;
+    AstStat* result;
+
+    ModuleReturnVisitor(const std::string& name, AstStat* result)
+        : name(name)
+        , result(result)
+    {
+    }
+
+    bool visit(AstExprFunction* node) override
+    {
+        return false;
+    }
+
+    bool visit(AstStatReturn* node) override
+    {
+        if (node != result)
+            CompileError::raise(node->location, "Module %s can only return at the end of the module", name.c_str());
+
+        return false;
+    }
+};
+
+// module bodies run in functions of the main chunk, so everything in them is one function level deeper than it was parsed
+struct ModuleDepthVisitor : AstVisitor
+{
+    bool visit(AstExprFunction* node) override
+    {
+        node->functionDepth++;
+
+        if (node->self)
+            node->self->functionDepth++;
+
+        for (AstLocal* arg : node->args)
+            arg->functionDepth++;
+
+        return true;
+    }
+
+    bool visit(AstStatLocal* node) override
+    {
+        for (AstLocal* var : node->vars)
+            var->functionDepth++;
+
+        return true;
+    }
+
+    bool visit(AstStatLocalFunction* node) override
+    {
+        node->name->functionDepth++;
+
+        return true;
+    }
+
+    bool visit(AstStatFor* node) override
+    {
+        node->var->functionDepth++;
+
+        return true;
+    }
+
+    bool visit(AstStatForIn* node) override
+    {
+        for (AstLocal* var : node->vars)
+            var->functionDepth++;
+
+        return true;
+    }
+};
+
+template<typename T>
+struct ModuleFunctionVisitor : AstVisitor
+{
+    DenseHashMap<AstExprFunction*, T>& functions;
+    T value;
+
+    ModuleFunctionVisitor(DenseHashMap<AstExprFunction*, T>& functions, T value)
+        : functions(functions)
+        , value(value)
+    {
+    }
+
+    bool visit(AstExprFunction* node) override
+    {
+        functions[node] = value;
+
+        return true;
+    }
+};
+
+struct AllocationVisitor : AstVisitor
+{
+    bool result = false;
+
+    bool visit(AstExpr* node) override
+    {
+        if (node->is<AstExprCall>() || node->is<AstExprTable>() || node->is<AstExprFunction>())
+            result = true;
+
+        if (AstExprBinary* expr = node->as<AstExprBinary>(); expr && expr->op == AstExprBinary::Concat)
+            result = true;
+
+        return !result;
+    }
+};
+
+struct ModuleLinker
+{
+    CompileModuleResolver& resolver;
+    AstNameTable& names;
+    Allocator& allocator;
+    const ParseOptions& parseOptions;
+
+    // maps module names to the locals that hold their values; nullptr while the module is being linked
+    std::unordered_map<std::string, AstLocal*> modules;
+
+    std::vector<AstStat*> body;
+    std::vector<LinkedModule>& linked;
+
+    ModuleLinker(CompileModuleResolver& resolver, AstNameTable& names, Allocator& allocator, const ParseOptions& parseOptions,
+        std::vector<LinkedModule>& linked)
+        : resolver(resolver)
+        , names(names)
+        , allocator(allocator)
+        , parseOptions(parseOptions)
+        , linked(linked)
+    {
+    }
+
+    template<typename T>
+    AstArray<T> copy(const T* data, size_t size)
+    {
+        AstArray<T> result;
+
+        result.data = size ? static_cast<T*>(allocator.allocate(sizeof(T) * size)) : nullptr;
+        result.size = size;
+
+        for (size_t i = 0; i < size; ++i)
+            result.data[i] = data[i];
+
+        return result;
+    }
+
+    static AstExprConstantString* getRequire(AstExpr* node)
+    {
+        AstExprCall* call = node->as<AstExprCall>();
+
+        if (!call || call->self || call->args.size != 1)
+            return nullptr;
+
+        AstExprGlobal* func = call->func->as<AstExprGlobal>();
+
+        if (!func || func->name != "require")
+            return nullptr;
+
+        return call->args.data[0]->as<AstExprConstantString>();
+    }
+
+    // replaces top-level local x = require("name") initializers with the locals of linked modules; the locals are declared in the main
+    // chunk, so they are upvalues in the functions that run module bodies
+    void resolveRequires(AstStatBlock* block, bool upvalue)
+    {
+        for (AstStat* stat : block->body)
+            if (AstStatLocal* local = stat->as<AstStatLocal>())
+                for (size_t i = 0; i < local->values.size; ++i)
+                    if (AstExprConstantString* name = getRequire(local->values.data[i]))
+                    {
+                        AstLocal* module = link(std::string(name->value.data, name->value.size), local->values.data[i]->location);
+
+                        local->values.data[i] = allocator.alloc<AstExprLocal>(local->values.data[i]->location, module, upvalue);
+                    }
+    }
+
+    AstLocal* link(const std::string& name, const Location& location)
+    {
+        if (auto it = modules.find(name); it != modules.end())
+        {
+            if (!it->second)
+                CompileError::raise(location, "Module %s is required recursively", name.c_str());
+
+            return it->second;
+        }
+
+        modules[name] = nullptr;
+
+        std::optional<std::string> source = resolver.readModule(name);
+        if (!source)
+            CompileError::raise(location, "Module %s could not be found", name.c_str());
+
+        ParseResult result = Parser::parse(source->c_str(), source->size(), names, allocator, parseOptions);
+
+        if (!result.errors.empty())
+        {
+            const ParseError& error = result.errors.front();
+            CompileError::raise(location, "Error parsing module %s at line %d: %s", name.c_str(), error.getLocation().begin.line + 1, error.what());
+        }
+
+        AstStatBlock* root = result.root;
+        AstStatReturn* ret = root->body.size ? root->body.data[root->body.size - 1]->as<AstStatReturn>() : nullptr;
+
+        if (!ret || ret->list.size != 1)
+            CompileError::raise(location, "Module %s must return exactly one value", name.c_str());
+
+        ModuleReturnVisitor visitor(name, ret);
+        root->visit(&visitor);
+
+        // dependencies are linked first so that their bodies run before the body of this module
+        resolveRequires(root, /* upvalue= */ true);
+
+        std::string localName = "module " + name;
+
+        // module values are tracked through the locals they are returned from, so other values like table constructors get a local
+        if (!ret->list.data[0]->is<AstExprLocal>())
+        {
+            AstLocal* value = allocator.alloc<AstLocal>(names.getOrAdd(localName.c_str()), ret->location, /* shadow= */ nullptr,
+                /* functionDepth= */ 0, /* loopDepth= */ 0, /* annotation= */ nullptr);
+
+            std::vector<AstStat*> stats(root->body.begin(), root->body.end());
+            stats.insert(stats.end() - 1, allocator.alloc<AstStatLocal>(ret->location, copy(&value, 1), copy(ret->list.data, 1), std::nullopt));
+
+            ret->list.data[0] = allocator.alloc<AstExprLocal>(ret->location, value, /* upvalue= */ false);
+            root->body = copy(stats.data(), stats.size());
+        }
+
+        ModuleDepthVisitor depthVisitor;
+        root->visit(&depthVisitor);
+
+        // each module body runs in its own function, which gives the module its own registers and keeps its locals out of other modules
+        AstName moduleName = names.getOrAdd(name.c_str());
+        AstExprFunction* func = allocator.alloc<AstExprFunction>(root->location, AstArray<AstGenericType>(), AstArray<AstGenericTypePack>(),
+            /* self= */ nullptr, AstArray<AstLocal*>(), /* vararg= */ root->location, root, /* functionDepth= */ 1, /* debugname= */ moduleName);
+        AstExpr* call = allocator.alloc<AstExprCall>(root->location, func, AstArray<AstExpr*>(), /* self= */ false, root->location);
+
+        AstLocal* local = allocator.alloc<AstLocal>(names.getOrAdd(localName.c_str()), ret->location, /* shadow= */ nullptr,
+            /* functionDepth= */ 0, /* loopDepth= */ 0, /* annotation= */ nullptr);
+
+        body.push_back(allocator.alloc<AstStatLocal>(ret->location, copy(&local, 1), copy(&call, 1), std::nullopt));
+
+        linked.push_back({moduleName, func, local, ret->list.data[0]});
+
+        modules[name] = local;
+        return local;
+    }
+};
+
+AstStatBlock* linkModules(AstStatBlock* root, CompileModuleResolver& resolver, AstNameTable& names, Allocator& allocator,
+    const ParseOptions& parseOptions, std::vector<LinkedModule>& modules)
+{
+    ModuleLinker linker(resolver, names, allocator, parseOptions, modules);
+    linker.resolveRequires(root, /* upvalue= */ false);
+
+    if (linker.body.empty())
+        return root;
+
+    for (AstStat* stat : root->body)
+        linker.body.push_back(stat);
+
+    return allocator.alloc<AstStatBlock>(root->location, linker.copy(linker.body.data(), linker.body.size()));
+}
+
+bool mayAllocate(AstExprFunction* func)
+{
+    AllocationVisitor visitor;
+    func->body->visit(&visitor);
+
+    return visitor.result;
+}
+
+void assignModuleCategories(
+    DenseHashMap<AstExprFunction*, uint8_t>& categories, BytecodeBuilder& bytecode, const std::vector<LinkedModule>& modules)
+{
+    for (size_t i = 0; i < modules.size() && i < 255; ++i)
+    {
+        // names come from the name table, so they outlive the builder like the rest of the AST
+        AstName name = modules[i].name;
+        uint8_t category = bytecode.addMemoryCategory({name.value, strlen(name.value)});
+
+        // this includes the function that runs the module body, so objects created by top-level code of the module are in its category too
+        ModuleFunctionVisitor<uint8_t> visitor(categories, category);
+        modules[i].func->visit(&visitor);
+    }
+}
+
+void assignModuleFunctions(DenseHashMap<AstExprFunction*, const LinkedModule*>& functions, const std::vector<LinkedModule>& modules)
+{
+    for (const LinkedModule& module : modules)
+    {
+        ModuleFunctionVisitor<const LinkedModule*> visitor(functions, &module);
+        module.func->visit(&visitor);
+    }
+}
+
+void aliasModuleValues(DenseHashMap<AstLocal*, Variable>& variables, const std::vector<LinkedModule>& modules)
+{
+    for (const LinkedModule& module : modules)
+        variables[module.local].init = module.value;
+}
+
+} // namespace Compile
+} // namespace Luau
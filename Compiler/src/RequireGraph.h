@@ -0,0 +1,57 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#pragma once
+
+#include "Luau/Ast.h"
+#include "Luau/DenseHash.h"
+#include "Luau/ParseOptions.h"
+
+#include "ValueTracking.h"
+
+#include <vector>
+
+namespace Luau
+{
+class Allocator;
+class AstNameTable;
+class BytecodeBuilder;
+struct CompileModuleResolver;
+} // namespace Luau
+
+namespace Luau
+{
+namespace Compile
+{
+
+struct LinkedModule
+{
+    AstName name;
+    AstExprFunction* func; // runs the body of the module and returns its value
+    AstLocal* local;       // main chunk local that holds the value of the module
+    AstExpr* value;        // expression returned at the end of the module body
+};
+
+// returns a block that runs the bodies of all modules required by root in dependency order, followed by root itself
+// each module body runs in its own function, which is called once by the main chunk to initialize the local that holds the module value
+// note: calls to module functions are only inlined on optimization level 2, like all other calls
+AstStatBlock* linkModules(AstStatBlock* root, CompileModuleResolver& resolver, AstNameTable& names, Allocator& allocator,
+    const ParseOptions& parseOptions, std::vector<LinkedModule>& modules);
+
+// adds a memory category named after each linked module to the bytecode and maps the functions of the module to it, including the
+// function that runs the module body
+// modules after the 255th don't get a category; see # Memory categories in Bytecode.h
+void assignModuleCategories(
+    DenseHashMap<AstExprFunction*, uint8_t>& categories, BytecodeBuilder& bytecode, const std::vector<LinkedModule>& modules);
+
+// maps the functions of each linked module, including the function that runs the module body, to the module
+void assignModuleFunctions(DenseHashMap<AstExprFunction*, const LinkedModule*>& functions, const std::vector<LinkedModule>& modules);
+
+// makes the locals that hold module values aliases of the values returned by module bodies, so that value tracking sees through require
+// must run after trackValues
+void aliasModuleValues(DenseHashMap<AstLocal*, Variable>& variables, const std::vector<LinkedModule>& modules);
+
+// returns false if the body of the function can't create objects, which allows inlining it into functions of other categories
+// note: calls are assumed to create objects
+bool mayAllocate(AstExprFunction* func);
+
+} // namespace Compile
+} // namespace Luau
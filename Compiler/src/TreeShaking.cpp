@@ -0,0 +1,335 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#include "TreeShaking.h"
+
+#include "Luau/Lexer.h"
+
+#include <vector>
+
+namespace Luau
+{
+namespace Compile
+{
+
+// resolves aliases like local util = M to the local initialized with the table constructor
+static AstLocal* getTable(const DenseHashMap<AstLocal*, Variable>& variables, AstLocal* local)
+{
+    while (local)
+    {
+        const Variable* v = variables.find(local);
+
+        if (!v || v->written || !v->init)
+            return nullptr;
+
+        if (v->init->is<AstExprTable>())
+            return local;
+
+        AstExprLocal* expr = v->init->as<AstExprLocal>();
+        local = expr ? expr->local : nullptr;
+    }
+
+    return nullptr;
+}
+
+// values that can be dropped together with the field they are assigned to
+static bool isPure(AstExpr* node)
+{
+    return node->is<AstExprFunction>() || node->is<AstExprLocal>() || node->is<AstExprConstantNil>() || node->is<AstExprConstantBool>() ||
+           node->is<AstExprConstantNumber>() || node->is<AstExprConstantString>();
+}
+
+struct DeadBranchVisitor : AstVisitor
+{
+    const DenseHashMap<AstExpr*, Constant>& constants;
+
+    DeadBranchVisitor(const DenseHashMap<AstExpr*, Constant>& constants)
+        : constants(constants)
+    {
+    }
+
+    bool visit(AstStatIf* node) override
+    {
+        const Constant* cv = constants.find(node->condition);
+
+        // compileStatIf skips the same branch; the condition is still evaluated
+        if (cv && cv->type != Constant::Type_Unknown)
+        {
+            if (cv->isTruthful())
+                node->elsebody = nullptr;
+            else
+                node->thenbody->body.size = 0;
+        }
+
+        return true;
+    }
+};
+
+struct ReferenceVisitor : AstVisitor
+{
+    const DenseHashMap<AstLocal*, Variable>& variables;
+
+    DenseHashSet<AstLocal*> referenced{nullptr};
+    DenseHashSet<AstLocal*> escaped{nullptr};
+    DenseHashSet<TableField, TableFieldHash> reads{TableField{nullptr, AstName()}};
+
+    // values that are also the initial values of locals; module bodies return them to the locals that hold module values
+    DenseHashSet<AstExpr*> aliases{nullptr};
+
+    // local functions that are being visited; recursive calls don't keep a function alive
+    std::vector<AstLocal*> functions;
+
+    ReferenceVisitor(const DenseHashMap<AstLocal*, Variable>& variables)
+        : variables(variables)
+    {
+        for (const auto& [local, v] : variables)
+            if (v.init && v.init->is<AstExprLocal>())
+                aliases.insert(v.init);
+    }
+
+    void reference(AstLocal* local)
+    {
+        for (AstLocal* function : functions)
+            if (function == local)
+                return;
+
+        referenced.insert(local);
+    }
+
+    void write(AstExpr* var)
+    {
+        // writing a field doesn't read the table
+        AstExprIndexName* index = var->as<AstExprIndexName>();
+
+        if (AstExprLocal* expr = index ? index->expr->as<AstExprLocal>() : nullptr)
+            reference(expr->local);
+        else
+            var->visit(this);
+    }
+
+    bool visit(AstExprLocal* node) override
+    {
+        reference(node->local);
+
+        // the table is used as a value, so any of its fields can be read
+        if (AstLocal* table = getTable(variables, node->local))
+            escaped.insert(table);
+
+        return false;
+    }
+
+    bool visit(AstExprIndexName* node) override
+    {
+        AstExprLocal* expr = node->expr->as<AstExprLocal>();
+
+        if (!expr)
+            return true;
+
+        reference(expr->local);
+
+        if (AstLocal* table = getTable(variables, expr->local))
+        {
+            reads.insert({table, node->index});
+
+            // methods get the table as self
+            if (node->op == ':')
+                escaped.insert(table);
+        }
+
+        return false;
+    }
+
+    bool visit(AstStatLocal* node) override
+    {
+        for (size_t i = 0; i < node->values.size; ++i)
+        {
+            AstExprLocal* expr = node->values.data[i]->as<AstExprLocal>();
+
+            // aliases of the table are resolved by getTable, so they are tracked like the table itself
+            if (expr && i < node->vars.size && getTable(variables, node->vars.data[i]))
+                reference(expr->local);
+            else
+                node->values.data[i]->visit(this);
+        }
+
+        return false;
+    }
+
+    bool visit(AstStatReturn* node) override
+    {
+        for (AstExpr* value : node->list)
+        {
+            AstExprLocal* expr = value->as<AstExprLocal>();
+
+            // returning a module value makes the module local an alias of the table, which getTable resolves
+            if (expr && aliases.contains(expr))
+                reference(expr->local);
+            else
+                value->visit(this);
+        }
+
+        return false;
+    }
+
+    bool visit(AstStatAssign* node) override
+    {
+        for (size_t i = 0; i < node->vars.size; ++i)
+            write(node->vars.data[i]);
+
+        for (size_t i = 0; i < node->values.size; ++i)
+            node->values.data[i]->visit(this);
+
+        return false;
+    }
+
+    bool visit(AstStatFunction* node) override
+    {
+        write(node->name);
+        node->func->visit(this);
+
+        return false;
+    }
+
+    bool visit(AstStatLocalFunction* node) override
+    {
+        functions.push_back(node->name);
+        node->func->visit(this);
+        functions.pop_back();
+
+        return false;
+    }
+};
+
+struct UnusedCodeVisitor : AstVisitor
+{
+    const DenseHashMap<AstLocal*, Variable>& variables;
+    const AstNameTable& names;
+    const ReferenceVisitor& references;
+
+    bool changed = false;
+
+    UnusedCodeVisitor(const DenseHashMap<AstLocal*, Variable>& variables, const AstNameTable& names, const ReferenceVisitor& references)
+        : variables(variables)
+        , names(names)
+        , references(references)
+    {
+    }
+
+    bool isUnusedTable(AstLocal* table)
+    {
+        return table && !references.escaped.contains(table);
+    }
+
+    bool isUnusedField(AstExpr* var)
+    {
+        AstExprIndexName* index = var->as<AstExprIndexName>();
+        AstExprLocal* expr = index && index->op == '.' ? index->expr->as<AstExprLocal>() : nullptr;
+        AstLocal* table = expr ? getTable(variables, expr->local) : nullptr;
+
+        return isUnusedTable(table) && !references.reads.contains({table, index->index});
+    }
+
+    bool isUnused(AstStat* node)
+    {
+        if (AstStatLocalFunction* stat = node->as<AstStatLocalFunction>())
+            return !references.referenced.contains(stat->name);
+
+        if (AstStatLocal* stat = node->as<AstStatLocal>())
+            return stat->vars.size == 1 && stat->values.size == 1 && stat->values.data[0]->is<AstExprFunction>() &&
+                   !references.referenced.contains(stat->vars.data[0]);
+
+        if (AstStatFunction* stat = node->as<AstStatFunction>())
+            return isUnusedField(stat->name);
+
+        if (AstStatAssign* stat = node->as<AstStatAssign>())
+            return stat->vars.size == 1 && stat->values.size == 1 && isUnusedField(stat->vars.data[0]) && isPure(stat->values.data[0]);
+
+        return false;
+    }
+
+    bool visit(AstStatBlock* node) override
+    {
+        size_t count = 0;
+
+        for (size_t i = 0; i < node->body.size; ++i)
+        {
+            AstStat* stat = node->body.data[i];
+
+            if (isUnused(stat))
+                changed = true;
+            else
+                node->body.data[count++] = stat;
+        }
+
+        node->body.size = count;
+
+        return true;
+    }
+
+    bool visit(AstStatLocal* node) override
+    {
+        for (size_t i = 0; i < node->vars.size && i < node->values.size; ++i)
+        {
+            AstLocal* local = node->vars.data[i];
+            AstExprTable* table = node->values.data[i]->as<AstExprTable>();
+
+            if (!table || getTable(variables, local) != local || !isUnusedTable(local))
+                continue;
+
+            size_t count = 0;
+
+            for (size_t j = 0; j < table->items.size; ++j)
+            {
+                const AstExprTable::Item& item = table->items.data[j];
+
+                if (item.kind == AstExprTable::Item::Record && isPure(item.value))
+                {
+                    // strings that aren't in the name table can't be read through expr.name
+                    AstExprConstantString* key = item.key->as<AstExprConstantString>();
+                    AstName name = names.get(key->value.data);
+
+                    if (!name.value || !references.reads.contains({local, name}))
+                    {
+                        changed = true;
+                        continue;
+                    }
+                }
+
+                table->items.data[count++] = item;
+            }
+
+            table->items.size = count;
+        }
+
+        return true;
+    }
+};
+
+void removeUnusedCode(const DenseHashMap<AstExpr*, Constant>& constants, const DenseHashMap<AstLocal*, Variable>& variables,
+    const AstNameTable& names, AstStatBlock* root)
+{
+    DeadBranchVisitor branches(constants);
+    root->visit(&branches);
+
+    // removing code can make the functions and fields it referenced unused as well
+    for (bool changed = true; changed;)
+    {
+        ReferenceVisitor references(variables);
+        root->visit(&references);
+
+        UnusedCodeVisitor unused(variables, names, references);
+        root->visit(&unused);
+
+        changed = unused.changed;
+    }
+}
+
+void findEscapedTables(DenseHashSet<AstLocal*>& escaped, const DenseHashMap<AstLocal*, Variable>& variables, AstNode* root)
+{
+    ReferenceVisitor references(variables);
+    root->visit(&references);
+
+    for (AstLocal* table : references.escaped)
+        escaped.insert(table);
+}
+
+} // namespace Compile
+} // namespace Luau
@@ -0,0 +1,34 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+#pragma once
+
+#include "Luau/Ast.h"
+#include "Luau/DenseHash.h"
+
+#include "ConstantFolding.h"
+#include "ValueTracking.h"
+
+namespace Luau
+{
+class AstNameTable;
+}
+
+namespace Luau
+{
+namespace Compile
+{
+
+// removes code that can't affect the program from the AST, repeating until nothing else becomes unused:
+// - branches of if statements with constant conditions, which would otherwise still be emitted as functions and keep their references alive
+// - local functions that are never referenced outside of their own bodies
+// - fields of local tables that are never read, when the table is only used through its locals and aliases; since linkModules turns
+//   module values into locals, this removes the exports of required modules that the program doesn't use
+// must run after foldConstants; note: like trackFields, this assumes that metamethods don't read tables
+void removeUnusedCode(const DenseHashMap<AstExpr*, Constant>& constants, const DenseHashMap<AstLocal*, Variable>& variables,
+    const AstNameTable& names, AstStatBlock* root);
+
+// finds local tables that are used as values (call arguments and method self, values stored in other tables, returned values), whose
+// fields can be read and written through references that don't go through the local or its aliases
+void findEscapedTables(DenseHashSet<AstLocal*>& escaped, const DenseHashMap<AstLocal*, Variable>& variables, AstNode* root);
+
+} // namespace Compile
+} // namespace Luau
@@ -1,6 +1,7 @@
 // This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
 #include "ValueTracking.h"
 
+#include "Luau/Bytecode.h"
 #include "Luau/Lexer.h"
 
 namespace Luau
@@ -82,6 +83,205 @@ struct ValueVisitor : AstVisitor
     }
 };
 
+struct FieldVisitor : AstVisitor
+{
+    DenseHashMap<TableField, FieldValue, TableFieldHash>& fields;
+    const DenseHashMap<AstLocal*, Variable>& variables;
+    const DenseHashSet<AstLocal*>& escaped;
+    const AstNameTable& names;
+
+    // block that declares each tracked table; fields can only be defined at the top level of that block
+    DenseHashMap<AstLocal*, AstStatBlock*> tables;
+    AstStatBlock* block = nullptr;
+
+    FieldVisitor(DenseHashMap<TableField, FieldValue, TableFieldHash>& fields, const DenseHashMap<AstLocal*, Variable>& variables,
+        const DenseHashSet<AstLocal*>& escaped, const AstNameTable& names)
+        : fields(fields)
+        , variables(variables)
+        , escaped(escaped)
+        , names(names)
+        , tables(nullptr)
+    {
+    }
+
+    // resolves aliases like local util = M to the table local
+    AstLocal* getTable(AstExpr* node)
+    {
+        AstExprLocal* expr = node->as<AstExprLocal>();
+
+        while (expr)
+        {
+            if (tables.contains(expr->local))
+                return expr->local;
+
+            const Variable* v = variables.find(expr->local);
+
+            if (!v || v->written || !v->init)
+                return nullptr;
+
+            expr = v->init->as<AstExprLocal>();
+        }
+
+        return nullptr;
+    }
+
+    // returns false for keys that can't alias any named field
+    bool getName(AstExpr* key, AstName& name)
+    {
+        if (AstExprConstantString* expr = key->as<AstExprConstantString>())
+        {
+            name = names.get(expr->value.data);
+
+            // strings that aren't in the name table can't be referenced through expr.name
+            return name.value != nullptr;
+        }
+
+        name = AstName();
+
+        return !key->is<AstExprConstantNumber>() && !key->is<AstExprConstantBool>();
+    }
+
+    void record(AstLocal* table, AstName name, AstExpr* value, AstStat* assignment)
+    {
+        FieldValue& fv = fields[{table, name}];
+
+        fv.value = (fv.writes == 0 && name.value) ? value : nullptr;
+        fv.assignment = assignment;
+        fv.writes++;
+    }
+
+    void assign(AstExpr* var, AstExpr* value, AstStat* assignment)
+    {
+        if (AstExprIndexName* expr = var->as<AstExprIndexName>())
+        {
+            if (AstLocal* table = getTable(expr->expr))
+                record(table, expr->index, *tables.find(table) == block ? value : nullptr, assignment);
+        }
+        else if (AstExprIndexExpr* expr = var->as<AstExprIndexExpr>())
+        {
+            AstName name;
+
+            if (AstLocal* table = getTable(expr->expr); table && getName(expr->index, name))
+                record(table, name, nullptr, assignment);
+        }
+    }
+
+    bool visit(AstStatBlock* node) override
+    {
+        AstStatBlock* oldBlock = block;
+        block = node;
+
+        for (size_t i = 0; i < node->body.size; ++i)
+            node->body.data[i]->visit(this);
+
+        block = oldBlock;
+
+        return false;
+    }
+
+    bool visit(AstStatLocal* node) override
+    {
+        for (size_t i = 0; i < node->vars.size && i < node->values.size; ++i)
+        {
+            AstLocal* local = node->vars.data[i];
+            AstExprTable* table = node->values.data[i]->as<AstExprTable>();
+            const Variable* v = variables.find(local);
+
+            // fields of tables used as values can be replaced through other references, e.g. by a function the table is passed to
+            if (!table || !v || v->written || escaped.contains(local))
+                continue;
+
+            tables[local] = block;
+
+            for (const AstExprTable::Item& item : table->items)
+            {
+                AstName name;
+
+                if (item.kind != AstExprTable::Item::List && getName(item.key, name))
+                    record(local, name, item.kind == AstExprTable::Item::Record ? item.value : nullptr, nullptr);
+            }
+        }
+
+        return true;
+    }
+
+    bool visit(AstStatFunction* node) override
+    {
+        // methods get an extra self argument so they can't be called through the field directly
+        assign(node->name, node->func->self ? nullptr : node->func, node);
+
+        return true;
+    }
+
+    bool visit(AstStatAssign* node) override
+    {
+        for (size_t i = 0; i < node->vars.size; ++i)
+            assign(node->vars.data[i], node->vars.size == node->values.size ? node->values.data[i] : nullptr, node);
+
+        return true;
+    }
+
+    bool visit(AstStatCompoundAssign* node) override
+    {
+        assign(node->var, nullptr, node);
+
+        return true;
+    }
+};
+
+struct TableWriteVisitor : AstVisitor
+{
+    TableWrites& writes;
+    const DenseHashMap<AstExprCall*, int>& builtins;
+
+    TableWriteVisitor(TableWrites& writes, const DenseHashMap<AstExprCall*, int>& builtins)
+        : writes(writes)
+        , builtins(builtins)
+    {
+    }
+
+    void assign(AstExpr* var)
+    {
+        if (AstExprIndexName* expr = var->as<AstExprIndexName>())
+            writes.fields.insert(expr->index);
+        else if (var->is<AstExprIndexExpr>())
+            writes.dynamic = true;
+    }
+
+    bool visit(AstStatAssign* node) override
+    {
+        for (size_t i = 0; i < node->vars.size; ++i)
+            assign(node->vars.data[i]);
+
+        return true;
+    }
+
+    bool visit(AstStatCompoundAssign* node) override
+    {
+        assign(node->var);
+
+        return true;
+    }
+
+    bool visit(AstStatFunction* node) override
+    {
+        assign(node->name);
+
+        return true;
+    }
+
+    bool visit(AstExprCall* node) override
+    {
+        const int* bfid = builtins.find(node);
+
+        // rawset and table.insert are the only builtins that modify tables
+        if (!bfid || *bfid == LBF_RAWSET || *bfid == LBF_TABLE_INSERT)
+            writes.calls = true;
+
+        return true;
+    }
+};
+
 void assignMutable(DenseHashMap<AstName, Global>& globals, const AstNameTable& names, const char** mutableGlobals)
 {
     if (AstName name = names.get("_G"); name.value)
@@ -99,5 +299,18 @@ void trackValues(DenseHashMap<AstName, Global>& globals, DenseHashMap<AstLocal*,
     root->visit(&visitor);
 }
 
+void trackFields(DenseHashMap<TableField, FieldValue, TableFieldHash>& fields, const DenseHashMap<AstLocal*, Variable>& variables,
+    const DenseHashSet<AstLocal*>& escaped, const AstNameTable& names, AstNode* root)
+{
+    FieldVisitor visitor{fields, variables, escaped, names};
+    root->visit(&visitor);
+}
+
+void trackTableWrites(TableWrites& writes, const DenseHashMap<AstExprCall*, int>& builtins, AstNode* root)
+{
+    TableWriteVisitor visitor{writes, builtins};
+    root->visit(&visitor);
+}
+
 } // namespace Compile
 } // namespace Luau
@@ -28,9 +28,50 @@ struct Variable
     bool constant = false;   // is the variable's value a compile-time constant? filled by constantFold
 };
 
+struct TableField
+{
+    AstLocal* table; // local initialized with a table constructor
+    AstName name;    // field name; AstName() is used to mark tables that are written through dynamic keys
+
+    bool operator==(const TableField& other) const
+    {
+        return table == other.table && name == other.name;
+    }
+};
+
+struct TableFieldHash
+{
+    size_t operator()(const TableField& field) const
+    {
+        return DenseHashPointer()(field.table) ^ DenseHashPointer()(field.name.value);
+    }
+};
+
+struct FieldValue
+{
+    AstExpr* value = nullptr;      // value of the field if it's assigned exactly once; filled by trackFields
+    AstStat* assignment = nullptr; // statement that assigns the value, or nullptr if the value comes from the table constructor
+    unsigned int writes = 0;       // number of times the field is written to
+};
+
+struct TableWrites
+{
+    DenseHashSet<AstName> fields{AstName()}; // names of fields that are assigned through expr.name
+    bool dynamic = false;                    // is a table assigned through a computed key?
+    bool calls = false;                      // is a function other than a builtin that doesn't modify tables called?
+};
+
 void assignMutable(DenseHashMap<AstName, Global>& globals, const AstNameTable& names, const char** mutableGlobals);
 void trackValues(DenseHashMap<AstName, Global>& globals, DenseHashMap<AstLocal*, Variable>& variables, AstNode* root);
 
+// tracks fields of local tables that are defined next to the table, e.g. local M = {} function M.f() end; must run after trackValues
+// tables in escaped (see findEscapedTables) are not tracked since they can be modified through references that don't go through the local
+void trackFields(DenseHashMap<TableField, FieldValue, TableFieldHash>& fields, const DenseHashMap<AstLocal*, Variable>& variables,
+    const DenseHashSet<AstLocal*>& escaped, const AstNameTable& names, AstNode* root);
+
+// tracks table writes and calls in a fragment of code, including nested functions; builtins is the result of analyzeBuiltins
+void trackTableWrites(TableWrites& writes, const DenseHashMap<AstExprCall*, int>& builtins, AstNode* root);
+
 inline Global getGlobalState(const DenseHashMap<AstName, Global>& globals, AstName name)
 {
     const Global* it = globals.find(name);
@@ -14,6 +14,7 @@ char* luau_compile(const char* source, size_t size, lua_CompileOptions* options,
     if (options)
     {
         static_assert(sizeof(lua_CompileOptions) == sizeof(Luau::CompileOptions), "C and C++ interface must match");
+        static_assert(sizeof(lua_CompileConstant) == sizeof(Luau::CompileConstant), "C and C++ interface must match");
         memcpy(static_cast<void*>(&opts), options, sizeof(opts));
     }
 
@@ -33,7 +33,8 @@ const std::string header = R"(
     #include "main.h"
 
     const size_t BYTECODE_SIZE = %d;
-    const char BYTECODE[] = {
+    // aligned so that the runtime can execute the code in place
+    alignas(4) const char BYTECODE[] = {
 )""\n\t";
 
 const std::string footer = "\n\t};\n\t#endif";
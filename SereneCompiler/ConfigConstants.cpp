@@ -0,0 +1,70 @@
+#include "ConfigConstants.h"
+
+#include "FileUtils.h"
+#include "TOML.h"
+
+#include <iostream>
+
+#include <string.h>
+
+static const char *keep(ConfigConstants &result, std::string value) {
+    result.storage.push_back(std::move(value));
+    return result.storage.back().c_str();
+}
+
+static void flatten(const toml::table &table, const std::string &prefix, ConfigConstants &result) {
+    for (auto &&[key, node]: table) {
+        std::string path = prefix + "." + std::string(key.str());
+
+        if (const toml::table *sub = node.as_table())
+            flatten(*sub, path, result);
+        else if (const toml::value<int64_t> *v = node.as_integer())
+            result.entries.push_back({keep(result, path), 2, double(v->get()), nullptr});
+        else if (const toml::value<double> *v = node.as_floating_point())
+            result.entries.push_back({keep(result, path), 2, v->get(), nullptr});
+        else if (const toml::value<bool> *v = node.as_boolean())
+            result.entries.push_back({keep(result, path), 1, v->get() ? 1.0 : 0.0, nullptr});
+        else if (const toml::value<std::string> *v = node.as_string())
+            result.entries.push_back({keep(result, path), 3, 0, keep(result, v->get())});
+
+        // arrays and dates have no constant representation; scripts index them at runtime
+    }
+}
+
+bool loadConfigConstants(const std::string &path, ConfigConstants &result) {
+    result.entries.clear();
+    result.storage.clear();
+
+    std::optional<std::string> source = readFile(path);
+
+    if (source) {
+        try {
+            flatten(toml::parse(*source, path), "config", result);
+        }
+        catch (const toml::parse_error &err) {
+            std::cerr << "Parsing " << path << " failed:\n" << err << "\n";
+            return false;
+        }
+    }
+
+    result.entries.push_back({nullptr, 0, 0, nullptr});
+    return true;
+}
+
+static const Luau::CompileConstant *findConfig(const ConfigConstants &config, const char *name, int type) {
+    for (const Luau::CompileConstant &entry: config.entries)
+        if (entry.name && entry.type == type && strcmp(entry.name, name) == 0)
+            return &entry;
+
+    return nullptr;
+}
+
+bool getConfigFlag(const ConfigConstants &config, const char *name, bool def) {
+    const Luau::CompileConstant *entry = findConfig(config, name, 1);
+    return entry ? entry->valueNumber != 0 : def;
+}
+
+double getConfigNumber(const ConfigConstants &config, const char *name, double def) {
+    const Luau::CompileConstant *entry = findConfig(config, name, 2);
+    return entry ? entry->valueNumber : def;
+}
@@ -0,0 +1,41 @@
+#ifndef SERENE_CONFIGCONSTANTS_H
+#define SERENE_CONFIGCONSTANTS_H
+
+#include "Luau/Compiler.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+/*
+
+    Config Constants
+
+    Values from Serene.TOML (ports, gear ratios, PID gains) are known when the robot image is built,
+    so they are passed to the compiler as constant globals under the "config" prefix:
+
+        [drive]
+        ratio = 1.5
+
+    makes config.drive.ratio * 360 fold to 540 in the bytecode. Scripts that use config in ways that
+    can't be folded, like local drive = config.drive or pairs(config), get a frozen config table instead.
+
+ */
+
+struct ConfigConstants {
+    // terminated by an entry with a null name, ready to be used as CompileOptions::constantGlobals
+    std::vector<Luau::CompileConstant> entries;
+
+    // owns the names and string values referenced by entries
+    std::deque<std::string> storage;
+};
+
+// a missing file results in an empty set of constants; returns false if the file can't be parsed
+bool loadConfigConstants(const std::string &path, ConfigConstants &result);
+
+// build settings live in Serene.TOML as well, e.g. build.compress is read as getConfigFlag(config, "config.build.compress", false)
+bool getConfigFlag(const ConfigConstants &config, const char *name, bool def);
+
+double getConfigNumber(const ConfigConstants &config, const char *name, double def);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SERENE_REQUIRERESOLVER_H
+#define SERENE_REQUIRERESOLVER_H
+
+#include "Luau/Compiler.h"
+
+#include "FileUtils.h"
+
+/*
+
+    Require Resolver
+
+    The robot image is a single chunk, so modules loaded with require("name") are linked at compile time.
+    Names are resolved the same way script analysis resolves them: name.luau, falling back to name.lua,
+    relative to the directory of the entry script.
+
+ */
+
+struct FileModuleResolver : Luau::CompileModuleResolver {
+    std::string directory;
+
+    explicit FileModuleResolver(std::string directory)
+            : directory(std::move(directory)) {
+    }
+
+    std::optional<std::string> readModule(const std::string &name) override {
+        if (std::optional<std::string> source = readFile(joinPaths(directory, name + ".luau")))
+            return source;
+
+        return readFile(joinPaths(directory, name + ".lua"));
+    }
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include <optional>
 #include <string>
 #include <functional>
+#include <algorithm>
 
 
 /*
@@ -27,6 +28,8 @@
 #include "FileUtils.h"
 #include "Flags.h"
 #include "ByteCodeWriter.h"
+#include "ConfigConstants.h"
+#include "RequireResolver.h"
 
 LUAU_FASTFLAG(DebugLuauTimeTracing)
 LUAU_FASTFLAG(LuauTypeMismatchModuleNameResolution)
@@ -59,6 +62,9 @@ LUAU_FASTFLAG(LuauTypeMismatchModuleNameResolution)
 struct GlobalOptions {
     int optimizationLevel = 1;
     int debugLevel = 1;
+    bool compress = false;
+    bool strip = false;
+    ConfigConstants config;
 } globalOptions;
 
 static Luau::CompileOptions copts() {
@@ -66,6 +72,7 @@ static Luau::CompileOptions copts() {
     result.optimizationLevel = globalOptions.optimizationLevel;
     result.debugLevel = globalOptions.debugLevel;
     result.coverageLevel = 0;
+    result.constantGlobals = globalOptions.config.entries.empty() ? nullptr : globalOptions.config.entries.data();
     return result;
 }
 
@@ -277,8 +284,36 @@ static bool compileFile(const std::string &name, const std::string &output_file)
 
     try {
         Luau::BytecodeBuilder bcb;
-        Luau::compileOrThrow(bcb, *source, copts());
-        writeByteCode(output_file.c_str(), bcb.getBytecode().data(),bcb.getBytecode().size());
+        bcb.setStripDebugInfo(globalOptions.strip);
+
+        FileModuleResolver resolver(".");
+        Luau::compileProgramOrThrow(bcb, *source, resolver, copts());
+
+        std::string bytecode = bcb.getBytecode();
+
+        if (globalOptions.compress) {
+            std::string compressed = Luau::BytecodeBuilder::compress(bytecode);
+            printf("Compressed bytecode from %d to %d bytes\n", int(bytecode.size()), int(compressed.size()));
+            bytecode = std::move(compressed);
+        }
+
+        writeByteCode(output_file.c_str(), bytecode.data(), bytecode.size());
+
+        // the sidecar is keyed by the hash of the final image, so it has to be written after compression
+        if (globalOptions.strip) {
+            std::string sidecar_file = output_file;
+            if (sidecar_file.size() > 2 && sidecar_file.compare(sidecar_file.size() - 2, 2, ".h") == 0)
+                sidecar_file.resize(sidecar_file.size() - 2);
+            sidecar_file += ".debug";
+
+            std::string sidecar = bcb.getDebugSidecar(bytecode, name);
+            if (!writeFile(sidecar_file, sidecar.data(), 1, sidecar.size())) {
+                fprintf(stderr, "Error writing %s\n", sidecar_file.c_str());
+                return false;
+            }
+
+            printf("Stripped debug info into %s\n", sidecar_file.c_str());
+        }
 
         return true;
     }
@@ -316,6 +351,29 @@ MYLIB_EXPORT bool CompileFile(const char *source_file,const char *output_file) {
 
     chdir(getParentPath(source_file)->c_str());
 
+    /*
+
+        Load Serene.TOML next to the entry script;
+        its values are folded into the bytecode as config.* constants.
+
+     */
+
+    if (!loadConfigConstants("Serene.TOML", globalOptions.config)) {
+        fprintf(stderr, "Compilation terminated.  [ERROR]");
+        return false;
+    }
+
+    // [build] compress = true shrinks the image for upload; the robot then decodes it into the heap up front instead of lazily
+    globalOptions.compress = getConfigFlag(globalOptions.config, "config.build.compress", false);
+
+    // [build] strip = true leaves line info and function names in a .debug sidecar next to the image; errors on the robot then
+    // report @hash/function/pc locations that Serene.Symbolicate turns back into file:line
+    globalOptions.strip = getConfigFlag(globalOptions.config, "config.build.strip", false);
+
+    // [build] optimize = 2 enables inlining, which is also what inlines calls into required modules; the default level 1 keeps
+    // every call and local visible to the debugger
+    globalOptions.optimizationLevel = std::max(0, std::min(2, int(getConfigNumber(globalOptions.config, "config.build.optimize", 1))));
+
     /*
 
         Command line args
@@ -0,0 +1,721 @@
+/*
+
+    SereneHeapDiff
+
+    Responsible for:
+        - Reading heap snapshots written by memory.snapshot / lua_heapsnapshot, either as files (from the SD card or the
+          host) or picked out of a serial terminal log.
+        - Reporting the objects that retain the most memory, by building the dominator tree of the heap.
+        - Diffing the first and the last snapshot by memory category and by allocation site.
+
+    Usage: Serene.HeapDiff <snapshot or log>... [--top=N]
+
+    A log can hold several snapshots and - reads stdin. With a single snapshot only the retained sizes are reported.
+    The VM doesn't record where an object was allocated, so the allocation site of an object is approximated by its memory
+    category (the module that was running when it was allocated) and the nearest function that dominates it; functions and
+    protos are their own site. The snapshot format is described next to luaC_snapshot in lgcdebug.cpp.
+
+ */
+
+#include "FileUtils.h"
+
+#include "lua.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum SnapshotFlags {
+    SNAPSHOT_FIXED = 1 << 0,
+    SNAPSHOT_WEAKKEYS = 1 << 1,
+    SNAPSHOT_WEAKVALUES = 1 << 2,
+    SNAPSHOT_CFUNCTION = 1 << 3,
+};
+
+struct Object {
+    uint64_t address = 0;
+    uint8_t type = 0;
+    uint8_t category = 0;
+    uint8_t flags = 0;
+    size_t size = 0;
+
+    std::string data; // prefix of a string or name of a C function
+    size_t length = 0;
+
+    uint64_t proto = 0;
+    uint64_t source = 0;
+    uint64_t debugname = 0;
+    int linedefined = 0;
+    int tag = 0;
+    size_t fields = 0; // refs start with a key and a value for each field of a table
+
+    std::vector<uint64_t> refs;
+};
+
+struct Snapshot {
+    std::string origin;
+    size_t totalbytes = 0;
+    std::map<int, std::string> categories;
+    std::vector<uint64_t> roots;
+
+    // node 0 is a virtual root that refers to the roots; objects[i] is node i + 1
+    std::vector<Object> objects;
+    std::unordered_map<uint64_t, size_t> nodes;
+
+    std::vector<size_t> idom; // 0 for objects that aren't reachable
+    std::vector<size_t> retained;
+    std::vector<bool> reachable;
+
+    // field an object is stored in, preferably one of the table that dominates it
+    std::unordered_map<size_t, std::string> names;
+};
+
+struct Reader {
+    const std::string &data;
+    size_t pos;
+    bool error = false;
+
+    uint8_t byte() {
+        if (pos >= data.size()) {
+            error = true;
+            return 0;
+        }
+
+        return uint8_t(data[pos++]);
+    }
+
+    uint64_t varint() {
+        uint64_t result = 0;
+
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            result |= uint64_t(b & 127) << shift;
+
+            if (!(b & 128))
+                return result;
+        }
+
+        error = true;
+        return result;
+    }
+
+    static int64_t unzigzag(uint64_t value) {
+        return int64_t(value >> 1) ^ -int64_t(value & 1);
+    }
+
+    int64_t zigzag() {
+        return unzigzag(varint());
+    }
+
+    // objects are encoded relative to the object that refers to them, see luaC_snapshot
+    uint64_t ref(uint64_t base) {
+        uint64_t value = varint();
+        return value ? base + unzigzag(value - 1) : 0;
+    }
+
+    std::string bytes(size_t count) {
+        if (count > data.size() - pos) {
+            error = true;
+            return std::string();
+        }
+
+        std::string result = data.substr(pos, count);
+        pos += count;
+        return result;
+    }
+};
+
+static bool parseSnapshot(const std::string &data, Snapshot &snapshot) {
+    Reader r{data, 0};
+
+    if (r.bytes(4) != "SHSN" || r.byte() != 1)
+        return false;
+
+    snapshot.totalbytes = r.varint();
+
+    for (uint64_t count = r.varint(); count && !r.error; --count) {
+        int category = r.byte();
+        snapshot.categories[category] = r.bytes(r.varint());
+    }
+
+    for (uint64_t count = r.varint(); count && !r.error; --count)
+        snapshot.roots.push_back(r.ref(0));
+
+    uint64_t last = 0;
+
+    while (!r.error) {
+        uint8_t type = r.byte();
+        if (type == 255)
+            break;
+
+        Object o;
+        o.type = type;
+        o.category = r.byte();
+        o.flags = r.byte();
+        o.address = last + r.zigzag();
+        o.size = r.varint();
+
+        last = o.address;
+
+        if (type == LUA_TSTRING || (type == LUA_TFUNCTION && (o.flags & SNAPSHOT_CFUNCTION))) {
+            o.length = r.varint();
+            o.data = r.bytes(std::min(o.length, size_t(32)));
+        } else if (type == LUA_TFUNCTION) {
+            o.proto = r.ref(o.address);
+        } else if (type == LUA_TPROTO) {
+            o.linedefined = int(r.varint());
+            o.source = r.ref(o.address);
+            o.debugname = r.ref(o.address);
+        } else if (type == LUA_TTABLE) {
+            o.fields = r.varint();
+        } else if (type == LUA_TUSERDATA) {
+            o.tag = r.byte();
+        }
+
+        while (uint64_t ref = r.ref(o.address))
+            o.refs.push_back(ref);
+
+        snapshot.nodes[o.address] = snapshot.objects.size() + 1;
+        snapshot.objects.push_back(std::move(o));
+    }
+
+    return !r.error;
+}
+
+/*
+
+    On the serial line a snapshot is printed as base64 between "#heap begin" and "#heap end <bytes>", see lmemlib.cpp.
+    Lines without the "#heap " prefix belong to other output and are skipped.
+
+ */
+
+static int base64Value(char ch) {
+    if (ch >= 'A' && ch <= 'Z')
+        return ch - 'A';
+    if (ch >= 'a' && ch <= 'z')
+        return ch - 'a' + 26;
+    if (ch >= '0' && ch <= '9')
+        return ch - '0' + 52;
+    if (ch == '+')
+        return 62;
+    if (ch == '/')
+        return 63;
+
+    return -1;
+}
+
+static void decodeBase64(const char *text, size_t length, std::string &result) {
+    unsigned bits = 0;
+    int count = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        int value = base64Value(text[i]);
+        if (value < 0)
+            continue;
+
+        bits = (bits << 6) | unsigned(value);
+        count += 6;
+
+        if (count >= 8) {
+            count -= 8;
+            result += char((bits >> count) & 255);
+        }
+    }
+}
+
+static std::vector<std::string> extractSnapshots(const std::string &log, const std::string &path) {
+    std::vector<std::string> result;
+    std::string current;
+    bool inside = false;
+
+    for (size_t pos = 0; pos < log.size();) {
+        size_t end = log.find('\n', pos);
+        if (end == std::string::npos)
+            end = log.size();
+
+        std::string line = log.substr(pos, end - pos);
+        pos = end + 1;
+
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+            line.pop_back();
+
+        size_t start = line.find("#heap ");
+        if (start == std::string::npos)
+            continue;
+
+        const char *text = line.c_str() + start + 6;
+
+        if (strcmp(text, "begin") == 0) {
+            current.clear();
+            inside = true;
+        } else if (strncmp(text, "end ", 4) == 0 && inside) {
+            size_t expected = strtoul(text + 4, nullptr, 10);
+
+            if (current.size() == expected)
+                result.push_back(current);
+            else
+                fprintf(stderr, "%s: skipping a truncated snapshot (%d of %d bytes)\n", path.c_str(), int(current.size()),
+                        int(expected));
+
+            inside = false;
+        } else if (inside) {
+            decodeBase64(text, strlen(text), current);
+        }
+    }
+
+    return result;
+}
+
+static bool loadSnapshots(const std::string &path, std::vector<Snapshot> &snapshots) {
+    std::optional<std::string> data = path == "-" ? readStdin() : readFile(path);
+    if (!data) {
+        fprintf(stderr, "Error opening %s\n", path.c_str());
+        return false;
+    }
+
+    std::vector<std::string> blobs;
+
+    if (data->compare(0, 4, "SHSN") == 0)
+        blobs.push_back(*data);
+    else
+        blobs = extractSnapshots(*data, path);
+
+    if (blobs.empty()) {
+        fprintf(stderr, "%s doesn't contain a heap snapshot\n", path.c_str());
+        return false;
+    }
+
+    for (size_t i = 0; i < blobs.size(); ++i) {
+        Snapshot snapshot;
+        std::string name = path == "-" ? "stdin" : path;
+        snapshot.origin = blobs.size() == 1 ? name : name + "#" + std::to_string(i + 1);
+
+        if (!parseSnapshot(blobs[i], snapshot)) {
+            fprintf(stderr, "%s is not a valid heap snapshot\n", snapshot.origin.c_str());
+            return false;
+        }
+
+        snapshots.push_back(std::move(snapshot));
+    }
+
+    return true;
+}
+
+/*
+
+    Dominators are computed with the iterative algorithm of Cooper, Harvey and Kennedy, which is simple and fast enough for the
+    heaps of a robot. Weak references were left out by the VM, so they don't keep objects alive here either.
+
+ */
+
+static void computeDominators(Snapshot &snapshot) {
+    size_t count = snapshot.objects.size() + 1;
+
+    std::vector<std::vector<size_t>> successors(count);
+
+    for (uint64_t root : snapshot.roots)
+        if (auto it = snapshot.nodes.find(root); it != snapshot.nodes.end())
+            successors[0].push_back(it->second);
+
+    // fixed objects are kept alive by the VM itself
+    for (size_t i = 0; i < snapshot.objects.size(); ++i)
+        if (snapshot.objects[i].flags & SNAPSHOT_FIXED)
+            successors[0].push_back(i + 1);
+
+    for (size_t i = 0; i < snapshot.objects.size(); ++i)
+        for (uint64_t ref : snapshot.objects[i].refs)
+            if (auto it = snapshot.nodes.find(ref); it != snapshot.nodes.end())
+                successors[i + 1].push_back(it->second);
+
+    // depth first search from the root, without recursion since heaps can be deep
+    std::vector<size_t> postorder;
+    std::vector<size_t> number(count, SIZE_MAX);
+    std::vector<bool> visited(count, false);
+    std::vector<std::pair<size_t, size_t>> stack;
+
+    stack.push_back({0, 0});
+    visited[0] = true;
+
+    while (!stack.empty()) {
+        auto &[node, next] = stack.back();
+
+        if (next < successors[node].size()) {
+            size_t succ = successors[node][next++];
+
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.push_back({succ, 0});
+            }
+        } else {
+            number[node] = postorder.size();
+            postorder.push_back(node);
+            stack.pop_back();
+        }
+    }
+
+    std::vector<std::vector<size_t>> predecessors(count);
+
+    for (size_t node : postorder)
+        for (size_t succ : successors[node])
+            predecessors[succ].push_back(node);
+
+    std::vector<size_t> idom(count, SIZE_MAX);
+    idom[0] = 0;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        // reverse postorder, skipping the root
+        for (size_t i = postorder.size() - 1; i-- > 0;) {
+            size_t node = postorder[i];
+            size_t dom = SIZE_MAX;
+
+            for (size_t pred : predecessors[node]) {
+                if (idom[pred] == SIZE_MAX)
+                    continue;
+
+                if (dom == SIZE_MAX) {
+                    dom = pred;
+                    continue;
+                }
+
+                size_t a = pred, b = dom;
+
+                while (a != b) {
+                    while (number[a] < number[b])
+                        a = idom[a];
+                    while (number[b] < number[a])
+                        b = idom[b];
+                }
+
+                dom = a;
+            }
+
+            if (dom != idom[node]) {
+                idom[node] = dom;
+                changed = true;
+            }
+        }
+    }
+
+    snapshot.idom.assign(count, 0);
+    snapshot.retained.assign(count, 0);
+    snapshot.reachable = visited;
+
+    for (size_t i = 1; i < count; ++i) {
+        snapshot.retained[i] = snapshot.objects[i - 1].size;
+
+        if (visited[i])
+            snapshot.idom[i] = idom[i];
+    }
+
+    // postorder visits every object before its dominator
+    for (size_t node : postorder)
+        if (node != 0)
+            snapshot.retained[snapshot.idom[node]] += snapshot.retained[node];
+}
+
+static const Object *findObject(const Snapshot &snapshot, uint64_t address) {
+    auto it = snapshot.nodes.find(address);
+    return it == snapshot.nodes.end() ? nullptr : &snapshot.objects[it->second - 1];
+}
+
+static std::string printable(const std::string &data) {
+    std::string result;
+
+    for (char ch : data)
+        result += (unsigned char)ch >= 32 && (unsigned char)ch < 127 ? ch : '?';
+
+    return result;
+}
+
+static void computeNames(Snapshot &snapshot) {
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < snapshot.objects.size(); ++i) {
+            const Object &o = snapshot.objects[i];
+
+            for (size_t field = 0; field < o.fields && field * 2 + 1 < o.refs.size(); ++field) {
+                const Object *key = findObject(snapshot, o.refs[field * 2]);
+                auto value = snapshot.nodes.find(o.refs[field * 2 + 1]);
+
+                if (!key || value == snapshot.nodes.end() || snapshot.names.count(value->second))
+                    continue;
+
+                if (pass == 1 || snapshot.idom[value->second] == i + 1)
+                    snapshot.names[value->second] = printable(key->data);
+            }
+        }
+    }
+}
+
+static std::string categoryName(const Snapshot &snapshot, int category) {
+    auto it = snapshot.categories.find(category);
+
+    if (it != snapshot.categories.end())
+        return it->second;
+
+    return category == 0 ? "default" : "category " + std::to_string(category);
+}
+
+// anonymous functions are named after the field they are stored in, if any
+static std::string protoLabel(const Snapshot &snapshot, const Object &proto, const std::string &field) {
+    const Object *name = findObject(snapshot, proto.debugname);
+    const Object *source = findObject(snapshot, proto.source);
+
+    std::string result = name ? printable(name->data) : field.empty() ? "anonymous" : field;
+    result += " (";
+    result += source ? printable(source->data) : "?";
+    result += ":" + std::to_string(proto.linedefined) + ")";
+    return result;
+}
+
+static std::string objectLabel(const Snapshot &snapshot, size_t node) {
+    if (node == 0)
+        return "<root>";
+
+    const Object &o = snapshot.objects[node - 1];
+
+    if (!snapshot.roots.empty() && o.address == snapshot.roots[0])
+        return "main thread";
+    if (snapshot.roots.size() > 1 && o.address == snapshot.roots[1])
+        return "registry";
+
+    auto name = snapshot.names.find(node);
+    std::string field = name == snapshot.names.end() ? "" : name->second;
+    std::string suffix = field.empty() ? "" : " " + field;
+
+    switch (o.type) {
+        case LUA_TSTRING:
+            return "string \"" + printable(o.data) + (o.length > o.data.size() ? "...\"" : "\"");
+
+        case LUA_TTABLE:
+            return (o.flags & (SNAPSHOT_WEAKKEYS | SNAPSHOT_WEAKVALUES) ? "weak table" : "table") + suffix;
+
+        case LUA_TFUNCTION:
+            if (o.flags & SNAPSHOT_CFUNCTION)
+                return "function " + (o.data.empty() ? std::string("?") : printable(o.data)) + " [C]";
+            else if (const Object *proto = findObject(snapshot, o.proto))
+                return "function " + protoLabel(snapshot, *proto, field);
+            else
+                return "function";
+
+        case LUA_TUSERDATA:
+            return "userdata tag " + std::to_string(o.tag) + suffix;
+
+        case LUA_TTHREAD:
+            return "thread" + suffix;
+
+        case LUA_TPROTO:
+            return "proto " + protoLabel(snapshot, o, "");
+
+        case LUA_TUPVAL:
+            return "upvalue";
+
+        default:
+            return "object type " + std::to_string(o.type);
+    }
+}
+
+static const char *typeName(uint8_t type) {
+    switch (type) {
+        case LUA_TSTRING:
+            return "string";
+        case LUA_TTABLE:
+            return "table";
+        case LUA_TFUNCTION:
+            return "function";
+        case LUA_TUSERDATA:
+            return "userdata";
+        case LUA_TTHREAD:
+            return "thread";
+        case LUA_TPROTO:
+            return "proto";
+        case LUA_TUPVAL:
+            return "upvalue";
+        default:
+            return "object";
+    }
+}
+
+static std::string allocationSite(const Snapshot &snapshot, size_t node) {
+    const Object &o = snapshot.objects[node - 1];
+
+    if (o.type == LUA_TFUNCTION || o.type == LUA_TPROTO)
+        return categoryName(snapshot, o.category) + ": " + objectLabel(snapshot, node);
+
+    std::string result = categoryName(snapshot, o.category) + ": " + typeName(o.type);
+
+    if (!snapshot.reachable[node])
+        return result + " (unreachable)";
+
+    for (size_t dom = snapshot.idom[node]; dom != 0; dom = snapshot.idom[dom]) {
+        uint8_t type = snapshot.objects[dom - 1].type;
+
+        if (type == LUA_TFUNCTION || type == LUA_TTHREAD)
+            return result + " held by " + objectLabel(snapshot, dom);
+    }
+
+    return result;
+}
+
+struct Usage {
+    size_t count = 0;
+    size_t bytes = 0;
+};
+
+struct Change {
+    std::string name;
+    Usage before, after;
+
+    long long growth() const {
+        return (long long)after.bytes - (long long)before.bytes;
+    }
+};
+
+static void printChanges(const char *title, std::map<std::string, Change> &changes, size_t top) {
+    std::vector<Change> sorted;
+
+    for (auto &[name, change] : changes) {
+        change.name = name;
+
+        if (change.growth() != 0 || change.after.count != change.before.count)
+            sorted.push_back(change);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const Change &a, const Change &b) {
+        return a.growth() > b.growth();
+    });
+
+    printf("\n%s:\n", title);
+
+    if (sorted.empty())
+        printf("  no changes\n");
+
+    for (size_t i = 0; i < sorted.size() && i < top; ++i) {
+        const Change &c = sorted[i];
+        printf("  %+9lld bytes %+6lld objects  %8d bytes %6d objects  %s\n", c.growth(),
+               (long long)c.after.count - (long long)c.before.count, int(c.after.bytes), int(c.after.count), c.name.c_str());
+    }
+}
+
+static void printDominators(const Snapshot &snapshot, const Snapshot *before, size_t top) {
+    std::vector<size_t> nodes;
+
+    for (size_t i = 1; i <= snapshot.objects.size(); ++i)
+        if (snapshot.reachable[i] && snapshot.retained[i] > snapshot.objects[i - 1].size)
+            nodes.push_back(i);
+
+    std::sort(nodes.begin(), nodes.end(), [&](size_t a, size_t b) {
+        return snapshot.retained[a] > snapshot.retained[b];
+    });
+
+    printf("\nLargest retained sizes in %s:\n", snapshot.origin.c_str());
+
+    for (size_t i = 0; i < nodes.size() && i < top; ++i) {
+        size_t node = nodes[i];
+        const Object &o = snapshot.objects[node - 1];
+
+        printf("  %8d bytes (%6d self)", int(snapshot.retained[node]), int(o.size));
+
+        // objects that survived keep their address, so their retained size can be compared
+        if (before) {
+            auto it = before->nodes.find(o.address);
+
+            if (it != before->nodes.end() && before->objects[it->second - 1].type == o.type)
+                printf(" %+9lld", (long long)snapshot.retained[node] - (long long)before->retained[it->second]);
+            else
+                printf(" %9s", "new");
+        }
+
+        printf("  %s: %s, held by %s\n", categoryName(snapshot, o.category).c_str(), objectLabel(snapshot, node).c_str(),
+               objectLabel(snapshot, snapshot.idom[node]).c_str());
+    }
+}
+
+static void summarize(const Snapshot &snapshot) {
+    size_t unreachable = 0;
+
+    for (size_t i = 1; i <= snapshot.objects.size(); ++i)
+        if (!snapshot.reachable[i])
+            unreachable += snapshot.objects[i - 1].size;
+
+    printf("%s: %d bytes, %d objects, %d bytes unreachable\n", snapshot.origin.c_str(), int(snapshot.totalbytes),
+           int(snapshot.objects.size()), int(unreachable));
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <snapshot or log>... [--top=N]\n", argv[0]);
+        return 1;
+    }
+
+    size_t top = 20;
+    std::vector<Snapshot> snapshots;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--top=", 6) == 0)
+            top = strtoul(argv[i] + 6, nullptr, 10);
+        else if (!loadSnapshots(argv[i], snapshots))
+            return 1;
+    }
+
+    if (snapshots.empty()) {
+        fprintf(stderr, "No snapshots given\n");
+        return 1;
+    }
+
+    for (Snapshot &snapshot : snapshots) {
+        computeDominators(snapshot);
+        computeNames(snapshot);
+    }
+
+    const Snapshot &after = snapshots.back();
+    const Snapshot *before = snapshots.size() > 1 ? &snapshots.front() : nullptr;
+
+    if (before)
+        summarize(*before);
+
+    summarize(after);
+
+    if (before) {
+        std::map<std::string, Change> categories;
+        std::map<std::string, Change> sites;
+
+        for (size_t i = 1; i <= before->objects.size(); ++i) {
+            const Object &o = before->objects[i - 1];
+
+            Usage &category = categories[categoryName(*before, o.category)].before;
+            category.count++;
+            category.bytes += o.size;
+
+            Usage &site = sites[allocationSite(*before, i)].before;
+            site.count++;
+            site.bytes += o.size;
+        }
+
+        for (size_t i = 1; i <= after.objects.size(); ++i) {
+            const Object &o = after.objects[i - 1];
+
+            Usage &category = categories[categoryName(after, o.category)].after;
+            category.count++;
+            category.bytes += o.size;
+
+            Usage &site = sites[allocationSite(after, i)].after;
+            site.count++;
+            site.bytes += o.size;
+        }
+
+        printChanges("Growth by memory category", categories, top);
+        printChanges("Growth by allocation site", sites, top);
+    }
+
+    printDominators(after, before, top);
+    return 0;
+}
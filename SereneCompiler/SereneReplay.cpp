@@ -0,0 +1,209 @@
+/*
+
+    SereneReplay
+
+    Responsible for:
+        - Running a script against a replay log recorded on the robot (see lreplay.cpp).
+        - Reporting per loop iteration timings so that match-time stalls can be profiled on the host.
+        - Reporting the most frequent opcode pairs in the compiled program (--opcode-pairs=N); these drive the choice of
+          superinstructions in BytecodeBuilder::fuseInstructions.
+        - Loading the program from a compressed image (--compress) when build.compress is set in Serene.TOML or on request.
+
+    Usage: Serene.Replay <script.lua> <log.replay> [--top=N] [--config=Serene.TOML] [--opcode-pairs=N] [--compress]
+
+    The script is compiled with the same options and config constants SereneCompiler uses for the robot image, so the
+    bytecode is identical to the one that produced the recording. Every call to replay.tick() marks the end of a loop iteration.
+
+ */
+
+#include "lua.h"
+#include "lualib.h"
+
+#include "Luau/BytecodeBuilder.h"
+#include "Luau/Compiler.h"
+#include "Luau/ParseResult.h"
+
+#include "ConfigConstants.h"
+#include "FileUtils.h"
+#include "RequireResolver.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Iteration {
+    unsigned index;
+    double time;
+    unsigned safepoints;
+};
+
+struct ReplayReport {
+    std::vector<Iteration> iterations;
+
+    double lasttimestamp = 0;
+    unsigned safepoints = 0;
+};
+
+static ReplayReport report;
+
+static Luau::BytecodeBuilder::OpcodePairHistogram opcodePairs;
+
+/*
+
+    Interrupts are called at every loop back edge and call; their count per iteration is
+    independent of host speed and is a stable measure of the work done by the script.
+
+ */
+
+static void countSafepoint(lua_State *L, int gc) {
+    if (gc < 0)
+        report.safepoints++;
+}
+
+static int timedTick(lua_State *L) {
+    double now = lua_clock();
+    unsigned index = lua_replaytick(L);
+
+    report.iterations.push_back({index, now - report.lasttimestamp, report.safepoints});
+
+    report.safepoints = 0;
+    report.lasttimestamp = lua_clock();
+
+    lua_pushinteger(L, int(index));
+    return 1;
+}
+
+static void printReport(size_t top) {
+    const std::vector<Iteration> &its = report.iterations;
+
+    if (its.empty()) {
+        printf("No iterations recorded; does the script call replay.tick()?\n");
+        return;
+    }
+
+    double total = 0, worst = 0;
+    for (const Iteration &it: its) {
+        total += it.time;
+        worst = std::max(worst, it.time);
+    }
+
+    printf("Iterations: %d, avg %.1f us, max %.1f us\n", int(its.size()), total / its.size() * 1e6, worst * 1e6);
+
+    std::vector<Iteration> sorted = its;
+    std::sort(sorted.begin(), sorted.end(), [](const Iteration &a, const Iteration &b) { return a.time > b.time; });
+
+    printf("\nSlowest iterations:\n%10s %12s %12s\n", "iteration", "time (us)", "safepoints");
+    for (size_t i = 0; i < std::min(top, sorted.size()); ++i)
+        printf("%10u %12.1f %12u\n", sorted[i].index, sorted[i].time * 1e6, sorted[i].safepoints);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <script.lua> <log.replay> [--top=N] [--config=Serene.TOML] [--opcode-pairs=N] [--compress]\n", argv[0]);
+        return 1;
+    }
+
+    size_t top = 10;
+    size_t topPairs = 0;
+    bool compress = false;
+    std::string configPath = joinPaths(getParentPath(argv[1]).value_or("."), "Serene.TOML");
+
+    for (int i = 3; i < argc; ++i) {
+        if (strncmp(argv[i], "--top=", 6) == 0)
+            top = size_t(atoi(argv[i] + 6));
+        else if (strncmp(argv[i], "--config=", 9) == 0)
+            configPath = argv[i] + 9;
+        else if (strncmp(argv[i], "--opcode-pairs=", 15) == 0)
+            topPairs = size_t(atoi(argv[i] + 15));
+        else if (strcmp(argv[i], "--compress") == 0)
+            compress = true;
+    }
+
+    std::optional<std::string> source = readFile(argv[1]);
+    if (!source) {
+        fprintf(stderr, "Error opening %s\n", argv[1]);
+        return 1;
+    }
+
+    std::optional<std::string> log = readFile(argv[2]);
+    if (!log) {
+        fprintf(stderr, "Error opening %s\n", argv[2]);
+        return 1;
+    }
+
+    // must match the options used for the robot image in SereneCompiler.cpp
+    ConfigConstants config;
+    if (!loadConfigConstants(configPath, config))
+        return 1;
+
+    Luau::CompileOptions options;
+    options.optimizationLevel = 1;
+    options.debugLevel = 1;
+    options.constantGlobals = config.entries.data();
+
+    std::string bytecode;
+
+    try {
+        Luau::BytecodeBuilder bcb;
+        bcb.setOpcodePairHistogram(&opcodePairs);
+
+        FileModuleResolver resolver(getParentPath(argv[1]).value_or("."));
+        Luau::compileProgramOrThrow(bcb, *source, resolver, options);
+        bytecode = bcb.getBytecode();
+    }
+    catch (Luau::ParseErrors &e) {
+        for (auto &error: e.getErrors())
+            fprintf(stderr, "%s(%d): SyntaxError: %s\n", argv[1], error.getLocation().begin.line + 1, error.what());
+        return 1;
+    }
+    catch (Luau::CompileError &e) {
+        fprintf(stderr, "%s(%d): CompileError: %s\n", argv[1], e.getLocation().begin.line + 1, e.what());
+        return 1;
+    }
+
+    if (compress || getConfigFlag(config, "config.build.compress", false)) {
+        std::string compressed = Luau::BytecodeBuilder::compress(bytecode);
+        printf("Compressed bytecode from %d to %d bytes\n\n", int(bytecode.size()), int(compressed.size()));
+        bytecode = std::move(compressed);
+    }
+
+    if (topPairs)
+        printf("Most frequent opcode pairs:\n%s\n", Luau::BytecodeBuilder::dumpOpcodePairs(opcodePairs, topPairs).c_str());
+
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+
+    lua_getglobal(L, LUA_REPLAYLIBNAME);
+    lua_pushcfunction(L, timedTick, "tick");
+    lua_setfield(L, -2, "tick");
+    lua_pop(L, 1);
+
+    if (!lua_replayplay(L, log->data(), log->size())) {
+        fprintf(stderr, "%s is not a replay log\n", argv[2]);
+        return 1;
+    }
+
+    lua_callbacks(L)->interrupt = countSafepoint;
+
+    if (luau_load(L, argv[1], bytecode.data(), bytecode.size(), 0) != 0) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        return 1;
+    }
+
+    report.lasttimestamp = lua_clock();
+
+    int status = lua_pcall(L, 0, 0, 0);
+
+    // running out of log is the expected way for a replayed control loop to finish
+    if (status != 0)
+        printf("Replay stopped: %s\n\n", lua_tostring(L, -1));
+
+    printReport(top);
+
+    lua_close(L);
+    return 0;
+}
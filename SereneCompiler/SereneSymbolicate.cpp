@@ -0,0 +1,185 @@
+/*
+
+    SereneSymbolicate
+
+    Responsible for:
+        - Expanding the @hash/function/pc locations that a robot image built with build.strip reports in errors and
+          tracebacks back into line numbers and function names, using the .debug sidecar written by SereneCompiler.
+
+    Usage: Serene.Symbolicate <image.debug>... [--log=robot.log]
+
+    The log is read from stdin unless --log is given. Every location that matches one of the sidecars is replaced so that
+    the output reads like the output of an image that wasn't stripped; locations from other images are left untouched.
+    The sidecar format is described in # Debug info sidecar in Bytecode.h.
+
+ */
+
+#include "FileUtils.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct FunctionInfo {
+    int linedefined = 0;
+    std::string name;
+    std::vector<int> lines; // line of each instruction word
+};
+
+struct ImageInfo {
+    std::string source;
+    std::map<int, FunctionInfo> functions;
+};
+
+static std::map<uint32_t, ImageInfo> images;
+
+static bool loadSidecar(const std::string &path) {
+    std::optional<std::string> data = readFile(path);
+    if (!data) {
+        fprintf(stderr, "Error opening %s\n", path.c_str());
+        return false;
+    }
+
+    std::istringstream in(*data);
+
+    std::string magic;
+    int version = 0;
+    std::string hash;
+    in >> magic >> version >> hash;
+
+    if (magic != "luau-debug" || version != 1 || hash.size() != 8) {
+        fprintf(stderr, "%s is not a debug info sidecar\n", path.c_str());
+        return false;
+    }
+
+    ImageInfo &image = images[uint32_t(strtoul(hash.c_str(), nullptr, 16))];
+    std::getline(in >> std::ws, image.source);
+
+    std::string tag;
+    while (in >> tag) {
+        int id = 0;
+        unsigned count = 0;
+        FunctionInfo function;
+
+        if (tag != "f" || !(in >> id >> function.linedefined >> function.name >> count)) {
+            fprintf(stderr, "%s: malformed record\n", path.c_str());
+            return false;
+        }
+
+        if (function.name == "-")
+            function.name.clear();
+
+        function.lines.resize(count);
+        for (unsigned i = 0; i < count; ++i)
+            in >> function.lines[i];
+
+        image.functions[id] = std::move(function);
+    }
+
+    return true;
+}
+
+/*
+
+    Locations are @hhhhhhhh/<function>/<pc>; errors follow them with ": message" and traceback frames
+    end with them, in which case the function name that was stripped is appended like debug.traceback does.
+
+ */
+
+static bool parseNumber(const std::string &text, size_t &pos, int &result) {
+    size_t start = pos;
+    while (pos < text.size() && isdigit((unsigned char)text[pos]))
+        pos++;
+
+    if (pos == start)
+        return false;
+
+    result = atoi(text.c_str() + start);
+    return true;
+}
+
+static bool symbolicate(const std::string &text, size_t &pos, std::string &result) {
+    size_t cursor = pos + 1;
+
+    if (cursor + 9 > text.size() || text[cursor + 8] != '/')
+        return false;
+
+    for (size_t i = 0; i < 8; ++i)
+        if (!isxdigit((unsigned char)text[cursor + i]))
+            return false;
+
+    uint32_t hash = uint32_t(strtoul(text.substr(cursor, 8).c_str(), nullptr, 16));
+    cursor += 9;
+
+    int id = 0, pc = 0;
+    if (!parseNumber(text, cursor, id) || cursor >= text.size() || text[cursor] != '/')
+        return false;
+
+    cursor++;
+
+    if (!parseNumber(text, cursor, pc))
+        return false;
+
+    auto image = images.find(hash);
+    if (image == images.end())
+        return false;
+
+    auto function = image->second.functions.find(id);
+    if (function == image->second.functions.end() || pc < 0 || size_t(pc) >= function->second.lines.size())
+        return false;
+
+    result += std::to_string(function->second.lines[pc]);
+
+    bool frame = cursor == text.size() || text[cursor] == '\n' || text[cursor] == '\r';
+    if (frame && !function->second.name.empty()) {
+        result += " function ";
+        result += function->second.name;
+    }
+
+    pos = cursor;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <image.debug>... [--log=robot.log]\n", argv[0]);
+        return 1;
+    }
+
+    std::string logPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--log=", 6) == 0)
+            logPath = argv[i] + 6;
+        else if (!loadSidecar(argv[i]))
+            return 1;
+    }
+
+    std::optional<std::string> log = logPath.empty() ? readStdin() : readFile(logPath);
+    if (!log) {
+        fprintf(stderr, "Error opening %s\n", logPath.empty() ? "stdin" : logPath.c_str());
+        return 1;
+    }
+
+    const std::string &text = *log;
+
+    std::string result;
+    result.reserve(text.size());
+
+    for (size_t pos = 0; pos < text.size();) {
+        if (text[pos] == '@' && symbolicate(text, pos, result))
+            continue;
+
+        result += text[pos++];
+    }
+
+    fwrite(result.data(), 1, result.size(), stdout);
+    return 0;
+}
@@ -213,6 +213,28 @@ LUA_API int luau_load(lua_State* L, const char* chunkname, const char* data, siz
 LUA_API void lua_call(lua_State* L, int nargs, int nresults);
 LUA_API int lua_pcall(lua_State* L, int nargs, int nresults, int errfunc);
 
+/*
+** lazy loading
+** luau_loadlazy only decodes function headers; code, constants and debug info of every function are decoded from data when the function
+** is first called, so data must stay valid (e.g. in flash) for as long as any function loaded from it is alive.
+** imports of lazily decoded functions are resolved with raw table lookups; imports that need metamethods are resolved at runtime instead.
+** if data is aligned to 4 bytes, code is executed in place from data instead of being copied to the heap; such functions don't support
+** breakpoints and coverage, and number-specialized instructions aren't replaced with generic ones when their operands aren't numbers.
+** compressed bytecode (see BytecodeBuilder::compress) is accepted by both functions; it's decoded while loading, so luau_loadlazy loads it eagerly.
+*/
+struct lua_LoadStats
+{
+    unsigned protos;        /* number of functions loaded */
+    unsigned lazyprotos;    /* number of functions loaded lazily */
+    unsigned pendingprotos; /* number of lazily loaded functions that haven't been decoded yet */
+    size_t pendingbytes;    /* heap bytes that decoding the pending functions would allocate */
+    size_t inplacebytes;    /* code bytes of decoded functions that are executed in place from data */
+};
+typedef struct lua_LoadStats lua_LoadStats;
+
+LUA_API int luau_loadlazy(lua_State* L, const char* chunkname, const char* data, size_t size, int env);
+LUA_API void lua_getloadstats(lua_State* L, lua_LoadStats* stats);
+
 /*
 ** coroutine functions
 */
@@ -225,6 +247,26 @@ LUA_API int lua_isyieldable(lua_State* L);
 LUA_API void* lua_getthreaddata(lua_State* L);
 LUA_API void lua_setthreaddata(lua_State* L, void* data);
 
+/*
+** thread pool
+** the stacks of collected threads are kept and given to new threads (lua_newthread, coroutine.create/wrap) instead of allocating
+** fresh ones, and lua_resetthread keeps a grown stack instead of shrinking it; only stacks of up to `stacksize` slots are kept.
+** at most `size` stacks are pooled (up to LUAI_MAXTHREADPOOL); the pooled memory stays attributed to the memory category of the
+** collected thread until it's reused. a size of 0 turns the pool off.
+*/
+struct lua_ThreadPoolStats
+{
+    unsigned created; /* threads that got a fresh stack */
+    unsigned reused;  /* threads that got a pooled stack */
+    unsigned dropped; /* stacks of collected threads that were freed because the pool was full or they were too large */
+    unsigned pooled;  /* stacks in the pool */
+    size_t bytes;     /* memory held by the pool */
+};
+typedef struct lua_ThreadPoolStats lua_ThreadPoolStats;
+
+LUA_API void lua_setthreadpool(lua_State* L, int size, int stacksize);
+LUA_API void lua_getthreadpoolstats(lua_State* L, lua_ThreadPoolStats* stats);
+
 /*
 ** garbage-collection function and options
 */
@@ -274,17 +316,181 @@ enum lua_GCOp
     LUA_GCSETGOAL,
     LUA_GCSETSTEPMUL,
     LUA_GCSETSTEPSIZE,
+
+    /*
+    ** switch to the generational or back to the incremental (default) mode; returns the previous mode
+    **
+    ** in the generational mode, minor collections only visit the objects allocated since the previous one and the old
+    ** objects that were changed to refer to them, so their cost depends on the allocation rate rather than on the heap size.
+    ** a minor collection runs after the heap grows by data% (LUA_GCGEN argument, 0 keeps the current setting, default 20%)
+    ** of its live size; when the heap reaches the goal G, an incremental major collection runs with the settings above.
+    */
+    LUA_GCGEN,
+    LUA_GCINC,
 };
 
 LUA_API int lua_gc(lua_State* L, int what, int data);
 
+/*
+** garbage collector metrics
+** every GC step is timed, at the cost of two clock reads; times are in seconds. the percentiles come from log-linear
+** histograms and are accurate to 25%. work is measured in the units of LUA_GCSETSTEPSIZE/LUA_GCSETSTEPMUL, so comparing
+** assist and explicit work shows whether explicit steps (lua_gc(LUA_GCSTEP), scratch scopes) keep up with allocation.
+*/
+enum lua_GCPhase
+{
+    LUA_GCPHASEMARK,   /* incremental mark steps, including marking the roots */
+    LUA_GCPHASEATOMIC, /* the non-incremental end of the mark phase */
+    LUA_GCPHASESWEEP,
+    LUA_GCPHASEMINOR, /* minor collections of the generational mode (LUA_GCGEN) */
+
+    LUA_GCPHASE_COUNT
+};
+
+struct lua_GCHistogram
+{
+    unsigned count;
+    double total;
+    double max;
+    double p50;
+    double p90;
+    double p99;
+};
+typedef struct lua_GCHistogram lua_GCHistogram;
+
+struct lua_GCMetrics
+{
+    lua_GCHistogram phases[LUA_GCPHASE_COUNT]; /* time of the steps in each phase */
+    lua_GCHistogram assiststeps;               /* time of the steps run by allocations */
+    lua_GCHistogram explicitsteps;             /* time of the other steps */
+    lua_GCHistogram heapgoal;                  /* heap size at the start of the atomic phase, in % of the heap goal; one sample per cycle */
+
+    double assistwork;
+    double explicitwork;
+    unsigned cycles; /* completed incremental cycles, not counting full collections */
+
+    size_t goalbytes; /* current heap goal */
+    size_t totalbytes;
+};
+typedef struct lua_GCMetrics lua_GCMetrics;
+
+LUA_API void lua_gcmetrics(lua_State* L, lua_GCMetrics* metrics);
+LUA_API void lua_gcresetmetrics(lua_State* L);
+
+/*
+** GC pacing
+** with a loop period set, allocations stop running GC steps; the work is done by lua_gctick, which the loop calls once per
+** iteration before it waits for the next period. a tick spends at most `budget` seconds and never runs past the end of the
+** period, and it leaves a step for a later tick when that step (e.g. the atomic phase) isn't predicted to fit. to keep memory
+** bounded when the budget is too small for the allocation rate, allocations resume assisting the collector once the heap
+** is past both the heap goal and two ticks of allocation beyond the point where the collector asked for work. in the
+** generational mode ticks start the major cycle early enough for it to finish at the heap goal in slices of the budget.
+** a period of 0 turns pacing off.
+*/
+struct lua_GCPaceStats
+{
+    unsigned ticks;
+    unsigned worked;    /* ticks that ran GC steps */
+    unsigned deferred;  /* ticks that left a step for later because it wasn't predicted to fit */
+    unsigned overruns;  /* ticks that ended after their period, without slack for the collector */
+    unsigned fallbacks; /* steps run by allocations between ticks */
+    double lasttime;    /* GC time of the last tick */
+    double maxtime;
+    double required; /* GC time per tick needed to keep up with the allocation rate, 0 until measured */
+};
+typedef struct lua_GCPaceStats lua_GCPaceStats;
+
+LUA_API void lua_gcpace(lua_State* L, double period, double budget);
+LUA_API void lua_gctick(lua_State* L);
+LUA_API void lua_getgcpacestats(lua_State* L, lua_GCPaceStats* stats);
+
+/*
+** scratch scopes
+** GC steps are deferred while a scope is open, unless the heap reaches the goal G; in the generational mode (LUA_GCGEN)
+** closing the outermost scope runs a minor collection, which frees the objects allocated in the scope right away and keeps
+** the ones that escaped it (stored into older objects, left on a stack or returned). scopes can nest.
+*/
+LUA_API void lua_beginscratch(lua_State* L);
+LUA_API void lua_endscratch(lua_State* L);
+
 /*
 ** memory statistics
-** all allocated bytes are attributed to the memory category of the running thread (0..LUA_MEMORY_CATEGORIES-1)
+** all allocated bytes are attributed to the memory category of the running thread (0..LUA_MEMORY_CATEGORIES-1); while that
+** is 0, objects created by functions of modules linked by compileProgramOrThrow are attributed to the categories of the modules,
+** which luau_load assigns from the top of the range by module name (see # Memory categories in Bytecode.h).
+** peaks, allocation totals and limits are tracked after lua_trackmemcats, lua_setmemcatlimit or loading a chunk with modules.
+** an allocation that would exceed the hard limit of its category raises a memory error; the soft limit is only reported.
 */
+struct lua_MemCatStats
+{
+    const char* name;      /* module the category was assigned to, or NULL */
+    size_t bytes;          /* live bytes */
+    size_t peakbytes;      /* largest number of live bytes since tracking started */
+    size_t allocatedbytes; /* bytes allocated since tracking started; wraps around */
+    size_t softlimit;      /* 0 if not set */
+    size_t hardlimit;      /* 0 if not set */
+};
+typedef struct lua_MemCatStats lua_MemCatStats;
 
 LUA_API void lua_setmemcat(lua_State* L, int category);
 LUA_API size_t lua_totalbytes(lua_State* L, int category);
+LUA_API void lua_trackmemcats(lua_State* L);
+LUA_API void lua_getmemcatstats(lua_State* L, int category, lua_MemCatStats* stats);
+LUA_API void lua_setmemcatlimit(lua_State* L, int category, size_t softlimit, size_t hardlimit);
+
+/*
+** heap snapshots
+** writes every live object with its size, memory category and references in the binary format that Serene.HeapDiff reads
+** (see luaC_snapshot); objects that became unreachable since the last collection are still included, so run a full collection
+** first to leave them out. write is called with consecutive chunks of the snapshot.
+*/
+LUA_API void lua_heapsnapshot(lua_State* L, void (*write)(void* context, const void* data, size_t size), void* context);
+
+/*
+** deterministic replay
+** native bindings pass nondeterministic results (sensor reads, clock reads) through lua_replaynumber/lua_replayboolean
+** when recording, the values are appended to a ring buffer that another task drains to storage via lua_replaydrain
+** when replaying, the values are read back from a recorded log and the live values are ignored
+*/
+
+enum lua_ReplayMode
+{
+    LUA_REPLAYOFF,
+    LUA_REPLAYRECORD,
+    LUA_REPLAYPLAY,
+};
+
+LUA_API void lua_replayrecord(lua_State* L, void* buffer, size_t size); /* size must be a power of two */
+LUA_API int lua_replayplay(lua_State* L, const void* log, size_t size); /* returns 0 if the log header is invalid */
+LUA_API void lua_replaystop(lua_State* L);
+LUA_API int lua_replaymode(lua_State* L);
+LUA_API size_t lua_replaydrain(lua_State* L, void (*write)(void* context, const void* data, size_t size), void* context);
+LUA_API size_t lua_replaydropped(lua_State* L);
+
+LUA_API double lua_replaynumber(lua_State* L, double value);
+LUA_API int lua_replayboolean(lua_State* L, int value);
+LUA_API unsigned lua_replaytick(lua_State* L);
+
+/*
+** execution budgets (watchdog)
+** once a budget is set, every outermost lua_pcall/lua_resume on the VM may pass at most `safepoints` safepoints (loop back edges
+** and calls) and may run for at most `timeout` seconds; 0 disables either limit. on overrun the running thread yields if it can,
+** otherwise an error is raised.
+** the deadline is checked by lua_watchdogtick, which is safe to call from a timer task; the interpreter itself only reads a flag.
+** budgets are enforced from the interrupt callback; an interrupt callback that was set before lua_setbudget keeps being called.
+*/
+struct lua_BudgetStats
+{
+    unsigned runs;     /* number of budgeted runs */
+    unsigned overruns; /* number of runs that exceeded the budget */
+    double lastusage;  /* fraction of the budget used by the last run */
+    double maxusage;   /* highest fraction of the budget used by a single run */
+};
+typedef struct lua_BudgetStats lua_BudgetStats;
+
+LUA_API void lua_setbudget(lua_State* L, int safepoints, double timeout);
+LUA_API void lua_watchdogtick(lua_State* L);
+LUA_API void lua_getbudgetstats(lua_State* L, lua_BudgetStats* stats);
 
 /*
 ** miscellaneous functions
@@ -393,6 +599,9 @@ struct lua_Debug
     unsigned char nparams;      /* (a) number of parameters */
     char isvararg;              /* (a) */
     char short_src[LUA_IDSIZE]; /* (s) */
+    int pc;                     /* (p) index of the current instruction, -1 if unknown */
+    int protoid;                /* (p) index of the function in its bytecode, -1 for C functions */
+    unsigned bytecodehash;      /* (p) hash of bytecode stripped of line info, 0 otherwise; with protoid and pc, locates the code */
     void* userdata;             /* only valid in luau_callhook */
 };
 
@@ -99,6 +99,11 @@
 #define LUA_MEMORY_CATEGORIES 256
 #endif
 
+/* upper bound for number of stacks of collected threads that are kept for new threads, see lua_setthreadpool */
+#ifndef LUAI_MAXTHREADPOOL
+#define LUAI_MAXTHREADPOOL 64
+#endif
+
 /* minimum size for the string table (must be power of 2) */
 #ifndef LUA_MINSTRTABSIZE
 #define LUA_MINSTRTABSIZE 32
@@ -109,6 +114,11 @@
 #define LUA_MAXCAPTURES 32
 #endif
 
+/* number of compiled patterns that string.find/match/gmatch/gsub keep, the least recently used one is replaced */
+#ifndef LUAI_PATTERNCACHE
+#define LUAI_PATTERNCACHE 16
+#endif
+
 /* }================================================================== */
 
 /*
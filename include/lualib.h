@@ -102,6 +102,18 @@ LUALIB_API void luaL_addvalue(luaL_Buffer* B);
 LUALIB_API void luaL_pushresult(luaL_Buffer* B);
 LUALIB_API void luaL_pushresultsize(luaL_Buffer* B, size_t size);
 
+/*
+** channels between independent VMs; each channel is a lock-free single-producer single-consumer queue of copied plain values
+** (nil, booleans, numbers, vectors, strings and flat tables) that is allocated outside of any VM heap
+*/
+typedef struct luaL_Channel luaL_Channel;
+
+LUALIB_API luaL_Channel* luaL_newchannel(size_t capacity);
+LUALIB_API void luaL_freechannel(luaL_Channel* ch);
+LUALIB_API int luaL_channelsend(lua_State* L, luaL_Channel* ch, int idx); /* returns 0 if the channel is full, errors if the value can never fit */
+LUALIB_API int luaL_channelreceive(lua_State* L, luaL_Channel* ch);       /* pushes the value and returns 1, or returns 0 if empty */
+LUALIB_API void luaL_pushchannel(lua_State* L, luaL_Channel* out, luaL_Channel* in); /* pushes a channel object with send/receive methods */
+
 /* builtin libraries */
 LUALIB_API int luaopen_base(lua_State* L);
 
@@ -129,6 +141,15 @@ LUALIB_API int luaopen_math(lua_State* L);
 #define LUA_DBLIBNAME "debug"
 LUALIB_API int luaopen_debug(lua_State* L);
 
+#define LUA_REPLAYLIBNAME "replay"
+LUALIB_API int luaopen_replay(lua_State* L);
+
+#define LUA_MEMLIBNAME "memory"
+LUALIB_API int luaopen_memory(lua_State* L);
+
+#define LUA_BUFLIBNAME "buffer"
+LUALIB_API int luaopen_buffer(lua_State* L);
+
 /* open all builtin libraries */
 LUALIB_API void luaL_openlibs(lua_State* L);
 
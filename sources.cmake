@@ -40,16 +40,26 @@ target_sources(Luau.Compiler PRIVATE
         Compiler/src/Compiler.cpp
         Compiler/src/Builtins/Builtins.cpp
         Compiler/src/BuiltinFolding.cpp
+        Compiler/src/CommonSubexpressions.cpp
         Compiler/src/ConstantFolding.cpp
         Compiler/src/CostModel.cpp
+        Compiler/src/EscapeAnalysis.cpp
+        Compiler/src/LoopInvariants.cpp
+        Compiler/src/RequireGraph.cpp
         Compiler/src/TableShape.cpp
+        Compiler/src/TreeShaking.cpp
         Compiler/src/ValueTracking.cpp
         Compiler/src/lcode.cpp
         Compiler/src/Builtins/Builtins.h
         Compiler/src/BuiltinFolding.h
+        Compiler/src/CommonSubexpressions.h
         Compiler/src/ConstantFolding.h
         Compiler/src/CostModel.h
+        Compiler/src/EscapeAnalysis.h
+        Compiler/src/LoopInvariants.h
+        Compiler/src/RequireGraph.h
         Compiler/src/TableShape.h
+        Compiler/src/TreeShaking.h
         Compiler/src/ValueTracking.h
         )
 
@@ -64,6 +74,71 @@ target_sources(Luau.CodeGen PRIVATE
         CodeGen/src/AssemblyBuilderX64.cpp
         )
 
+# Luau.VM Sources
+target_sources(Luau.VM PRIVATE
+        include/lua.h
+        include/luaconf.h
+        include/lualib.h
+
+        src/VM/lapi.cpp
+        src/VM/laux.cpp
+        src/VM/lcorolib.cpp
+        src/VM/ldblib.cpp
+        src/VM/ldebug.cpp
+        src/VM/ldo.cpp
+        src/VM/lfunc.cpp
+        src/VM/lgc.cpp
+        src/VM/lgcdebug.cpp
+        src/VM/lmem.cpp
+        src/VM/lnumprint.cpp
+        src/VM/lobject.cpp
+        src/VM/lperf.cpp
+        src/VM/lreplay.cpp
+        src/VM/lstate.cpp
+        src/VM/lstring.cpp
+        src/VM/lstrlib.cpp
+        src/VM/ltable.cpp
+        src/VM/ltablib.cpp
+        src/VM/ltm.cpp
+        src/VM/ludata.cpp
+        src/VM/lutf8lib.cpp
+        src/VM/lvmexecute.cpp
+        src/VM/lvmload.cpp
+        src/VM/lvmutils.cpp
+        src/VM/lwatchdog.cpp
+        src/VM/lzio.cpp
+        src/VM/Libraries/lbaselib.cpp
+        src/VM/Libraries/lbitlib.cpp
+        src/VM/Libraries/lbuiltins.cpp
+        src/VM/Libraries/lchannellib.cpp
+        src/VM/Libraries/linit.cpp
+        src/VM/Libraries/lmathlib.cpp
+        src/VM/Libraries/loslib.cpp
+        src/VM/Libraries/lreplaylib.cpp
+        src/VM/Libraries/lmemlib.cpp
+        src/VM/Libraries/lbuflib.cpp
+
+        src/VM/lapi.h
+        src/VM/lbytecode.h
+        src/VM/lcommon.h
+        src/VM/ldebug.h
+        src/VM/ldo.h
+        src/VM/lfunc.h
+        src/VM/lgc.h
+        src/VM/lmem.h
+        src/VM/lnumutils.h
+        src/VM/lobject.h
+        src/VM/lstate.h
+        src/VM/lstring.h
+        src/VM/ltable.h
+        src/VM/ltm.h
+        src/VM/ludata.h
+        src/VM/lvm.h
+        src/VM/lwatchdog.h
+        src/VM/lzio.h
+        src/VM/Libraries/lbuiltins.h
+        )
+
 # Luau.Analysis Sources
 target_sources(Luau.Analysis PRIVATE
         Analysis/include/Luau/AstQuery.h
@@ -166,6 +241,11 @@ if (TARGET Serene.Compiler)
             SereneCompiler/ByteCodeWriter.h
             SereneCompiler/ByteCodeWriter.cpp
 
+            SereneCompiler/ConfigConstants.h
+            SereneCompiler/ConfigConstants.cpp
+
+            SereneCompiler/RequireResolver.h
+
             SereneCompiler/SereneCompiler.h
             SereneCompiler/SereneCompiler.cpp
 
@@ -173,4 +253,36 @@ if (TARGET Serene.Compiler)
 
             SereneCompiler/SereneCLI.cpp
             )
-endif()
\ No newline at end of file
+endif()
+
+if (TARGET Serene.Replay)
+    target_sources(Serene.Replay PRIVATE
+            SereneCompiler/FileUtils.h
+            SereneCompiler/FileUtils.cpp
+
+            SereneCompiler/ConfigConstants.h
+            SereneCompiler/ConfigConstants.cpp
+
+            SereneCompiler/RequireResolver.h
+
+            SereneCompiler/SereneReplay.cpp
+            )
+endif()
+
+if (TARGET Serene.Symbolicate)
+    target_sources(Serene.Symbolicate PRIVATE
+            SereneCompiler/FileUtils.h
+            SereneCompiler/FileUtils.cpp
+
+            SereneCompiler/SereneSymbolicate.cpp
+            )
+endif()
+
+if (TARGET Serene.HeapDiff)
+    target_sources(Serene.HeapDiff PRIVATE
+            SereneCompiler/FileUtils.h
+            SereneCompiler/FileUtils.cpp
+
+            SereneCompiler/SereneHeapDiff.cpp
+            )
+endif()
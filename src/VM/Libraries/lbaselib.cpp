@@ -172,6 +172,17 @@ static int luaB_gcinfo(lua_State *L) {
     return 1;
 }
 
+/* calls fn in a scratch scope, see lua_beginscratch; fn can't yield */
+static int luaB_scratch(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    lua_beginscratch(L);
+    int status = lua_pcall(L, lua_gettop(L) - 1, LUA_MULTRET, 0);
+    lua_endscratch(L); /* results and errors are on the stack, so they survive the scope */
+    if (status != 0)
+        lua_error(L);
+    return lua_gettop(L);
+}
+
 static int luaB_type(lua_State *L) {
     luaL_checkany(L, 1);
     /* resulting name doesn't differentiate between userdata types */
@@ -390,6 +401,7 @@ static const luaL_Reg base_funcs[] = {
         {"rawget",       luaB_rawget},
         {"rawset",       luaB_rawset},
         {"rawlen",       luaB_rawlen},
+        {"scratch",      luaB_scratch},
         {"select",       luaB_select},
         {"setfenv",      luaB_setfenv},
         {"setmetatable", luaB_setmetatable},
@@ -0,0 +1,219 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#include "../../../include/lualib.h"
+
+#include "../lcommon.h"
+#include "../lnumutils.h"
+#include "../ludata.h"
+
+#include <string.h>
+
+/*
+ * Buffers are fixed-size mutable blocks of bytes for building and parsing binary packets without allocating a string for
+ * every field. They are user data with the UTAG_BUFFER tag and a shared locked metatable, so typeof(b) is "buffer" while
+ * type(b) is "userdata". Offsets start at 0 and values are stored little endian.
+ *
+ * buffer.read* and buffer.write* are builtins (see LBF_BUFFER_READI8 in Bytecode.h), the functions here only run when the
+ * fast path fails, e.g. to raise an error for an access out of bounds.
+ */
+
+#define MAXBUFFERSIZE (1 << 30)
+
+static char *checkbuffer(lua_State *L, int idx, size_t *len) {
+    char *data = static_cast<char *>(lua_touserdatatagged(L, idx, UTAG_BUFFER));
+    if (!data)
+        luaL_typeerror(L, idx, "buffer");
+    *len = lua_objlen(L, idx);
+    return data;
+}
+
+static size_t checkoffset(lua_State *L, int idx, size_t len, size_t size) {
+    int offset = luaL_checkinteger(L, idx);
+    if (offset < 0 || size_t(offset) > len || size > len - size_t(offset))
+        luaL_error(L, "buffer access out of bounds");
+    return size_t(offset);
+}
+
+static char *newbuffer(lua_State *L, size_t size) {
+    if (size > MAXBUFFERSIZE)
+        luaL_error(L, "buffer size is too large");
+    char *data = static_cast<char *>(lua_newuserdatatagged(L, size, UTAG_BUFFER));
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_setmetatable(L, -2);
+    return data;
+}
+
+static int buffer_create(lua_State *L) {
+    int size = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, size >= 0, 1, "size must be non-negative");
+
+    char *data = newbuffer(L, size);
+    memset(data, 0, size);
+    return 1;
+}
+
+static int buffer_fromstring(lua_State *L) {
+    size_t len;
+    const char *s = luaL_checklstring(L, 1, &len);
+
+    char *data = newbuffer(L, len);
+    memcpy(data, s, len);
+    return 1;
+}
+
+static int buffer_tostring(lua_State *L) {
+    size_t len;
+    char *data = checkbuffer(L, 1, &len);
+
+    lua_pushlstring(L, data, len);
+    return 1;
+}
+
+static int buffer_len(lua_State *L) {
+    size_t len;
+    checkbuffer(L, 1, &len);
+
+    lua_pushinteger(L, int(len));
+    return 1;
+}
+
+template<typename T>
+static int buffer_readnumber(lua_State *L) {
+    size_t len;
+    char *data = checkbuffer(L, 1, &len);
+    size_t offset = checkoffset(L, 2, len, sizeof(T));
+
+    T v;
+    memcpy(&v, data + offset, sizeof(T));
+    lua_pushnumber(L, double(v));
+    return 1;
+}
+
+template<typename T>
+static int buffer_writeinteger(lua_State *L) {
+    size_t len;
+    char *data = checkbuffer(L, 1, &len);
+    size_t offset = checkoffset(L, 2, len, sizeof(T));
+    double value = luaL_checknumber(L, 3);
+
+    unsigned u;
+    luai_num2unsigned(u, value);
+
+    T v = T(u);
+    memcpy(data + offset, &v, sizeof(T));
+    return 0;
+}
+
+template<typename T>
+static int buffer_writefp(lua_State *L) {
+    size_t len;
+    char *data = checkbuffer(L, 1, &len);
+    size_t offset = checkoffset(L, 2, len, sizeof(T));
+
+    T v = T(luaL_checknumber(L, 3));
+    memcpy(data + offset, &v, sizeof(T));
+    return 0;
+}
+
+static int buffer_readstring(lua_State *L) {
+    size_t len;
+    char *data = checkbuffer(L, 1, &len);
+    int count = luaL_checkinteger(L, 3);
+    luaL_argcheck(L, count >= 0, 3, "count must be non-negative");
+    size_t offset = checkoffset(L, 2, len, count);
+
+    lua_pushlstring(L, data + offset, count);
+    return 1;
+}
+
+static int buffer_writestring(lua_State *L) {
+    size_t len, size;
+    char *data = checkbuffer(L, 1, &len);
+    const char *s = luaL_checklstring(L, 3, &size);
+    int count = luaL_optinteger(L, 4, int(size));
+    luaL_argcheck(L, count >= 0 && size_t(count) <= size, 4, "count is out of range");
+    size_t offset = checkoffset(L, 2, len, count);
+
+    memcpy(data + offset, s, count);
+    return 0;
+}
+
+// buffer.copy(target, targetoffset, source, sourceoffset = 0, count = #source - sourceoffset); the ranges may overlap
+static int buffer_copy(lua_State *L) {
+    size_t tlen, slen;
+    char *target = checkbuffer(L, 1, &tlen);
+    char *source = checkbuffer(L, 3, &slen);
+    int soffset = luaL_optinteger(L, 4, 0);
+    luaL_argcheck(L, soffset >= 0 && size_t(soffset) <= slen, 4, "offset is out of range");
+    int count = luaL_optinteger(L, 5, int(slen - soffset));
+    luaL_argcheck(L, count >= 0, 5, "count must be non-negative");
+    size_t toffset = checkoffset(L, 2, tlen, count);
+    if (size_t(count) > slen - soffset)
+        luaL_error(L, "buffer access out of bounds");
+
+    memmove(target + toffset, source + soffset, count);
+    return 0;
+}
+
+// buffer.fill(b, offset, value, count = #b - offset)
+static int buffer_fill(lua_State *L) {
+    size_t len;
+    char *data = checkbuffer(L, 1, &len);
+    int offset = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, offset >= 0 && size_t(offset) <= len, 2, "offset is out of range");
+    unsigned value = luaL_checkunsigned(L, 3);
+    int count = luaL_optinteger(L, 4, int(len - offset));
+    luaL_argcheck(L, count >= 0, 4, "count must be non-negative");
+    if (size_t(count) > len - offset)
+        luaL_error(L, "buffer access out of bounds");
+
+    memset(data + offset, uint8_t(value), count);
+    return 0;
+}
+
+static const luaL_Reg buflib[] = {
+        {"tostring",    buffer_tostring},
+        {"len",         buffer_len},
+        {"readi8",      buffer_readnumber<int8_t>},
+        {"readu8",      buffer_readnumber<uint8_t>},
+        {"readi16",     buffer_readnumber<int16_t>},
+        {"readu16",     buffer_readnumber<uint16_t>},
+        {"readi32",     buffer_readnumber<int32_t>},
+        {"readu32",     buffer_readnumber<uint32_t>},
+        {"readf32",     buffer_readnumber<float>},
+        {"readf64",     buffer_readnumber<double>},
+        {"writei8",     buffer_writeinteger<int8_t>},
+        {"writeu8",     buffer_writeinteger<uint8_t>},
+        {"writei16",    buffer_writeinteger<int16_t>},
+        {"writeu16",    buffer_writeinteger<uint16_t>},
+        {"writei32",    buffer_writeinteger<int32_t>},
+        {"writeu32",    buffer_writeinteger<uint32_t>},
+        {"writef32",    buffer_writefp<float>},
+        {"writef64",    buffer_writefp<double>},
+        {"readstring",  buffer_readstring},
+        {"writestring", buffer_writestring},
+        {"copy",        buffer_copy},
+        {"fill",        buffer_fill},
+        {NULL, NULL},
+};
+
+int luaopen_buffer(lua_State *L) {
+    luaL_register(L, LUA_BUFLIBNAME, buflib);
+
+    // metatable shared by all buffers, the upvalue of the functions that create them
+    lua_createtable(L, 0, 2);
+    lua_pushliteral(L, "buffer");
+    lua_setfield(L, -2, "__type");
+    lua_pushliteral(L, "The metatable is locked");
+    lua_setfield(L, -2, "__metatable");
+    lua_setreadonly(L, -1, true);
+
+    lua_pushvalue(L, -1);
+    lua_pushcclosure(L, buffer_create, "create", 1);
+    lua_setfield(L, -3, "create");
+
+    lua_pushcclosure(L, buffer_fromstring, "fromstring", 1);
+    lua_setfield(L, -2, "fromstring");
+
+    return 1;
+}
@@ -8,8 +8,10 @@
 #include "../lgc.h"
 #include "../lnumutils.h"
 #include "../ldo.h"
+#include "../ludata.h"
 
 #include <math.h>
+#include <string.h>
 
 #ifdef _MSC_VER
 #include <intrin.h>
@@ -993,6 +995,73 @@ static int luauF_rawlen(lua_State *L, StkId res, TValue *arg0, int nresults, Stk
     return -1;
 }
 
+// buffers are stored little endian, which is the native byte order of all supported targets
+#define ttisbuffer(o) (ttisuserdata(o) && uvalue(o)->tag == UTAG_BUFFER)
+
+// the offset is truncated like luaL_checkinteger does; out of bounds accesses fall back to the library function for the error
+static bool checkbufferoffset(Udata *u, TValue *arg, size_t size, int *offset) {
+    double d = nvalue(arg);
+
+    if (d >= 0 && d + size <= double(u->len)) {
+        *offset = int(d);
+        return true;
+    }
+
+    return false;
+}
+
+template<typename T>
+static int luauF_readbuffer(lua_State *L, StkId res, TValue *arg0, int nresults, StkId args, int nparams) {
+    if (nparams >= 2 && nresults <= 1 && ttisbuffer(arg0) && ttisnumber(args)) {
+        Udata *u = uvalue(arg0);
+        int offset;
+
+        if (checkbufferoffset(u, args, sizeof(T), &offset)) {
+            T v;
+            memcpy(&v, u->data + offset, sizeof(T));
+            setnvalue(res, double(v));
+            return 1;
+        }
+    }
+
+    return -1;
+}
+
+template<typename T>
+static int luauF_writeinteger(lua_State *L, StkId res, TValue *arg0, int nresults, StkId args, int nparams) {
+    if (nparams >= 3 && nresults <= 0 && ttisbuffer(arg0) && ttisnumber(args) && ttisnumber(args + 1)) {
+        Udata *u = uvalue(arg0);
+        int offset;
+
+        if (checkbufferoffset(u, args, sizeof(T), &offset)) {
+            unsigned value;
+            luai_num2unsigned(value, nvalue(args + 1));
+
+            T v = T(value);
+            memcpy(u->data + offset, &v, sizeof(T));
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+template<typename T>
+static int luauF_writefp(lua_State *L, StkId res, TValue *arg0, int nresults, StkId args, int nparams) {
+    if (nparams >= 3 && nresults <= 0 && ttisbuffer(arg0) && ttisnumber(args) && ttisnumber(args + 1)) {
+        Udata *u = uvalue(arg0);
+        int offset;
+
+        if (checkbufferoffset(u, args, sizeof(T), &offset)) {
+            T v = T(nvalue(args + 1));
+            memcpy(u->data + offset, &v, sizeof(T));
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
 luau_FastFunction luauF_table[256] = {
         NULL,
         luauF_assert,
@@ -1066,4 +1135,18 @@ luau_FastFunction luauF_table[256] = {
         luauF_select,
 
         luauF_rawlen,
+
+        luauF_readbuffer<int8_t>,
+        luauF_readbuffer<uint8_t>,
+        luauF_writeinteger<uint8_t>,
+        luauF_readbuffer<int16_t>,
+        luauF_readbuffer<uint16_t>,
+        luauF_writeinteger<uint16_t>,
+        luauF_readbuffer<int32_t>,
+        luauF_readbuffer<uint32_t>,
+        luauF_writeinteger<uint32_t>,
+        luauF_readbuffer<float>,
+        luauF_writefp<float>,
+        luauF_readbuffer<double>,
+        luauF_writefp<double>,
 };
@@ -0,0 +1,347 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#include "../../../include/lualib.h"
+
+#include "../lcommon.h"
+
+#include <atomic>
+#include <new>
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Channels connect independent VMs (each created with its own lua_newstate) that run on different tasks.
+ *
+ * A channel is a lock-free single-producer single-consumer ring buffer allocated outside of any VM heap; head is only
+ * advanced by the sending VM and tail is only advanced by the receiving VM. Values are copied into the ring buffer as
+ * self-contained messages, so the two VMs never share GC objects and a collection in one of them can't stall the other.
+ *
+ * Only plain values can be sent: nil, booleans, numbers, vectors, strings and flat tables whose keys and values are
+ * plain non-table values.
+ *
+ * Message layout: [uint32 payload size][payload]; payload is a single encoded value:
+ *   tag byte, followed by 8 bytes for numbers, 12 bytes for vectors, [uint32 length][bytes] for strings,
+ *   and [uint32 count][key value]* for tables
+ */
+
+#define CHANNEL_METATABLE "channel"
+
+enum ChannelTag {
+    CTAG_NIL,
+    CTAG_FALSE,
+    CTAG_TRUE,
+    CTAG_NUMBER,
+    CTAG_VECTOR,
+    CTAG_STRING,
+    CTAG_TABLE,
+};
+
+struct luaL_Channel {
+    uint8_t *data;
+    size_t size; // power of two
+
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+};
+
+struct ChannelEndpoint {
+    luaL_Channel *out;
+    luaL_Channel *in;
+};
+
+luaL_Channel *luaL_newchannel(size_t capacity) {
+    size_t size = 64;
+    while (size < capacity)
+        size *= 2;
+
+    luaL_Channel *ch = static_cast<luaL_Channel *>(malloc(sizeof(luaL_Channel)));
+    if (!ch)
+        return NULL;
+
+    ch->data = static_cast<uint8_t *>(malloc(size));
+    if (!ch->data) {
+        free(ch);
+        return NULL;
+    }
+
+    ch->size = size;
+    new(&ch->head) std::atomic<size_t>(0);
+    new(&ch->tail) std::atomic<size_t>(0);
+    return ch;
+}
+
+void luaL_freechannel(luaL_Channel *ch) {
+    free(ch->data);
+    free(ch);
+}
+
+static size_t encodedsize(lua_State *L, int idx, bool nested) {
+    switch (lua_type(L, idx)) {
+        case LUA_TNIL:
+        case LUA_TBOOLEAN:
+            return 1;
+        case LUA_TNUMBER:
+            return 1 + sizeof(double);
+        case LUA_TVECTOR:
+            return 1 + 3 * sizeof(float);
+        case LUA_TSTRING:
+            return 1 + sizeof(uint32_t) + lua_objlen(L, idx);
+        case LUA_TTABLE: {
+            if (nested)
+                luaL_error(L, "cannot send nested tables through a channel");
+
+            size_t size = 1 + sizeof(uint32_t);
+
+            lua_pushnil(L);
+            while (lua_next(L, idx)) {
+                size += encodedsize(L, lua_gettop(L) - 1, true);
+                size += encodedsize(L, lua_gettop(L), true);
+                lua_pop(L, 1);
+            }
+
+            return size;
+        }
+        default:
+            luaL_error(L, "cannot send a %s through a channel", luaL_typename(L, idx));
+    }
+}
+
+static size_t putbytes(luaL_Channel *ch, size_t pos, const void *data, size_t size) {
+    size_t mask = ch->size - 1;
+    for (size_t i = 0; i < size; ++i)
+        ch->data[(pos + i) & mask] = static_cast<const uint8_t *>(data)[i];
+    return pos + size;
+}
+
+static size_t putvalue(lua_State *L, luaL_Channel *ch, size_t pos, int idx) {
+    uint8_t tag;
+
+    switch (lua_type(L, idx)) {
+        case LUA_TNIL:
+            tag = CTAG_NIL;
+            return putbytes(ch, pos, &tag, 1);
+
+        case LUA_TBOOLEAN:
+            tag = lua_toboolean(L, idx) ? CTAG_TRUE : CTAG_FALSE;
+            return putbytes(ch, pos, &tag, 1);
+
+        case LUA_TNUMBER: {
+            double v = lua_tonumber(L, idx);
+            tag = CTAG_NUMBER;
+            pos = putbytes(ch, pos, &tag, 1);
+            return putbytes(ch, pos, &v, sizeof(v));
+        }
+
+        case LUA_TVECTOR: {
+            const float *v = lua_tovector(L, idx);
+            tag = CTAG_VECTOR;
+            pos = putbytes(ch, pos, &tag, 1);
+            return putbytes(ch, pos, v, 3 * sizeof(float));
+        }
+
+        case LUA_TSTRING: {
+            size_t len = 0;
+            const char *s = lua_tolstring(L, idx, &len);
+            uint32_t len32 = uint32_t(len);
+            tag = CTAG_STRING;
+            pos = putbytes(ch, pos, &tag, 1);
+            pos = putbytes(ch, pos, &len32, sizeof(len32));
+            return putbytes(ch, pos, s, len);
+        }
+
+        default: {
+            LUAU_ASSERT(lua_type(L, idx) == LUA_TTABLE);
+
+            // count is patched after the traversal
+            size_t countpos = pos + 1;
+            uint32_t count = 0;
+            tag = CTAG_TABLE;
+            pos = putbytes(ch, pos, &tag, 1);
+            pos = putbytes(ch, pos, &count, sizeof(count));
+
+            lua_pushnil(L);
+            while (lua_next(L, idx)) {
+                pos = putvalue(L, ch, pos, lua_gettop(L) - 1);
+                pos = putvalue(L, ch, pos, lua_gettop(L));
+                lua_pop(L, 1);
+                count++;
+            }
+
+            putbytes(ch, countpos, &count, sizeof(count));
+            return pos;
+        }
+    }
+}
+
+int luaL_channelsend(lua_State *L, luaL_Channel *ch, int idx) {
+    idx = lua_absindex(L, idx);
+
+    // lua_next needs 2 extra slots per table level
+    luaL_checkstack(L, 4, "channel send");
+
+    size_t payload = encodedsize(L, idx, false);
+
+    // a message that can't fit even in an empty channel would make the sender retry forever
+    if (sizeof(uint32_t) + payload > ch->size)
+        luaL_error(L, "message of %d bytes is too large for a channel of %d bytes", int(sizeof(uint32_t) + payload), int(ch->size));
+
+    size_t head = ch->head.load(std::memory_order_relaxed);
+    size_t tail = ch->tail.load(std::memory_order_acquire);
+
+    if (ch->size - (head - tail) < sizeof(uint32_t) + payload)
+        return 0;
+
+    uint32_t payload32 = uint32_t(payload);
+    size_t pos = putbytes(ch, head, &payload32, sizeof(payload32));
+    pos = putvalue(L, ch, pos, idx);
+    LUAU_ASSERT(pos == head + sizeof(uint32_t) + payload);
+
+    ch->head.store(pos, std::memory_order_release);
+    return 1;
+}
+
+static const char *getvalue(lua_State *L, const char *data, const char *end) {
+    if (data >= end)
+        luaL_error(L, "malformed channel message");
+
+    uint8_t tag = uint8_t(*data++);
+
+    switch (tag) {
+        case CTAG_NIL:
+            lua_pushnil(L);
+            return data;
+
+        case CTAG_FALSE:
+        case CTAG_TRUE:
+            lua_pushboolean(L, tag == CTAG_TRUE);
+            return data;
+
+        case CTAG_NUMBER: {
+            double v;
+            memcpy(&v, data, sizeof(v));
+            lua_pushnumber(L, v);
+            return data + sizeof(v);
+        }
+
+        case CTAG_VECTOR: {
+            float v[3];
+            memcpy(v, data, sizeof(v));
+#if LUA_VECTOR_SIZE == 4
+            lua_pushvector(L, v[0], v[1], v[2], 0.0f);
+#else
+            lua_pushvector(L, v[0], v[1], v[2]);
+#endif
+            return data + sizeof(v);
+        }
+
+        case CTAG_STRING: {
+            uint32_t len;
+            memcpy(&len, data, sizeof(len));
+            lua_pushlstring(L, data + sizeof(len), len);
+            return data + sizeof(len) + len;
+        }
+
+        case CTAG_TABLE: {
+            uint32_t count;
+            memcpy(&count, data, sizeof(count));
+            data += sizeof(count);
+
+            lua_createtable(L, 0, int(count));
+
+            for (uint32_t i = 0; i < count; ++i) {
+                data = getvalue(L, data, end);
+                data = getvalue(L, data, end);
+                lua_rawset(L, -3);
+            }
+
+            return data;
+        }
+
+        default:
+            luaL_error(L, "malformed channel message");
+    }
+}
+
+int luaL_channelreceive(lua_State *L, luaL_Channel *ch) {
+    size_t tail = ch->tail.load(std::memory_order_relaxed);
+    size_t head = ch->head.load(std::memory_order_acquire);
+
+    if (head == tail)
+        return 0;
+
+    size_t mask = ch->size - 1;
+
+    uint32_t payload;
+    for (size_t i = 0; i < sizeof(payload); ++i)
+        reinterpret_cast<uint8_t *>(&payload)[i] = ch->data[(tail + i) & mask];
+
+    // copy the message out so that the decoder doesn't have to deal with the wrap around
+    luaL_Buffer b;
+    char *buf = luaL_buffinitsize(L, &b, payload);
+
+    for (size_t i = 0; i < payload; ++i)
+        buf[i] = char(ch->data[(tail + sizeof(payload) + i) & mask]);
+
+    ch->tail.store(tail + sizeof(payload) + payload, std::memory_order_release);
+
+    luaL_checkstack(L, 4, "channel receive");
+
+    getvalue(L, buf, buf + payload);
+
+    // remove the buffer storage that may be placed below the value
+    if (b.storage)
+        lua_remove(L, -2);
+
+    return 1;
+}
+
+static ChannelEndpoint *checkendpoint(lua_State *L) {
+    return static_cast<ChannelEndpoint *>(luaL_checkudata(L, 1, CHANNEL_METATABLE));
+}
+
+static int channel_send(lua_State *L) {
+    ChannelEndpoint *ep = checkendpoint(L);
+    luaL_checkany(L, 2);
+    if (!ep->out)
+        luaL_error(L, "channel is receive-only");
+
+    lua_pushboolean(L, luaL_channelsend(L, ep->out, 2));
+    return 1;
+}
+
+static int channel_receive(lua_State *L) {
+    ChannelEndpoint *ep = checkendpoint(L);
+    if (!ep->in)
+        luaL_error(L, "channel is send-only");
+
+    if (!luaL_channelreceive(L, ep->in))
+        return 0;
+
+    lua_pushboolean(L, true);
+    lua_insert(L, -2);
+    return 2;
+}
+
+static const luaL_Reg channel_methods[] = {
+        {"send",    channel_send},
+        {"receive", channel_receive},
+        {NULL, NULL},
+};
+
+void luaL_pushchannel(lua_State *L, luaL_Channel *out, luaL_Channel *in) {
+    ChannelEndpoint *ep = static_cast<ChannelEndpoint *>(lua_newuserdata(L, sizeof(ChannelEndpoint)));
+    ep->out = out;
+    ep->in = in;
+
+    if (luaL_newmetatable(L, CHANNEL_METATABLE)) {
+        lua_newtable(L);
+        luaL_register(L, NULL, channel_methods);
+        lua_setfield(L, -2, "__index");
+
+        lua_pushstring(L, CHANNEL_METATABLE);
+        lua_setfield(L, -2, "__type");
+    }
+
+    lua_setmetatable(L, -2);
+}
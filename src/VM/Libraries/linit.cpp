@@ -14,6 +14,9 @@ static const luaL_Reg lualibs[] = {
         {LUA_DBLIBNAME,   luaopen_debug},
         {LUA_UTF8LIBNAME, luaopen_utf8},
         {LUA_BITLIBNAME,  luaopen_bit32},
+        {LUA_REPLAYLIBNAME, luaopen_replay},
+        {LUA_MEMLIBNAME, luaopen_memory},
+        {LUA_BUFLIBNAME, luaopen_buffer},
         {NULL, NULL},
 };
 
@@ -0,0 +1,382 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#include "../../../include/lualib.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Memory categories are assigned to modules by luau_load (see lua_getmemcatstats), so a leak shows up as a category whose
+ * live bytes keep growing; the allocation rate tells the churn of a category apart from its growth.
+ *
+ * The rate of a category is computed over the time since the previous memory.stats call that reported the category; the
+ * upvalues of memory.stats keep the allocation totals and times of the previous calls and the time the library was opened.
+ *
+ * memory.snapshot writes a heap snapshot (see lua_heapsnapshot) for Serene.HeapDiff: to a file when given a path, e.g. on the
+ * SD card, otherwise to stdout, which is the serial line on the robot. On stdout it's base64 encoded between "#heap begin"
+ * and "#heap end <bytes>" lines and every line starts with "#heap ", so that the snapshot can be picked out of a terminal log
+ * even when other tasks print in between.
+ *
+ * memory.gcmetrics reports the GC step times per phase and per kind (assist or explicit) and how well the heap trigger hits
+ * the goal, see lua_gcmetrics; memory.resetgcmetrics starts a new measurement, e.g. after changing the GC settings.
+ *
+ * memory.gcpace(period, budget) paces the collector to a control loop that calls memory.gctick() at the end of every
+ * iteration, see lua_gcpace; memory.gcpacestats tells whether the budget keeps up.
+ *
+ * memory.threadpool(size, stacksize) sets how many stacks of collected coroutines are kept for new ones and how large they
+ * may be, see lua_setthreadpool; memory.threadpoolstats tells how many coroutines got a pooled stack.
+ */
+
+static int findcategory(lua_State *L, const char *name) {
+    for (int i = 0; i < LUA_MEMORY_CATEGORIES; i++) {
+        lua_MemCatStats stats;
+        lua_getmemcatstats(L, i, &stats);
+
+        if (stats.name && strcmp(stats.name, name) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+// categories are given by number or by module name
+static int checkcategory(lua_State *L, int arg) {
+    if (lua_type(L, arg) == LUA_TSTRING) {
+        int category = findcategory(L, lua_tostring(L, arg));
+        if (category < 0)
+            luaL_error(L, "no memory category for module '%s'", lua_tostring(L, arg));
+
+        return category;
+    }
+
+    int category = luaL_checkinteger(L, arg);
+    luaL_argcheck(L, unsigned(category) < LUA_MEMORY_CATEGORIES, arg, "invalid category");
+    return category;
+}
+
+static void setfield(lua_State *L, const char *key, size_t value) {
+    lua_pushnumber(L, double(value));
+    lua_setfield(L, -2, key);
+}
+
+static void pushstats(lua_State *L, int category, const lua_MemCatStats &stats, double now) {
+    lua_createtable(L, 0, 9);
+
+    lua_pushinteger(L, category);
+    lua_setfield(L, -2, "category");
+
+    if (stats.name) {
+        lua_pushstring(L, stats.name);
+        lua_setfield(L, -2, "name");
+    }
+
+    setfield(L, "bytes", stats.bytes);
+    setfield(L, "peak", stats.peakbytes);
+    setfield(L, "allocated", stats.allocatedbytes);
+    setfield(L, "softlimit", stats.softlimit);
+    setfield(L, "hardlimit", stats.hardlimit);
+
+    lua_pushboolean(L, stats.softlimit && stats.bytes > stats.softlimit);
+    lua_setfield(L, -2, "over");
+
+    // the first call for a category measures from the time the library was opened, when the totals started at 0
+    lua_rawgeti(L, lua_upvalueindex(1), category);
+    lua_rawgeti(L, lua_upvalueindex(2), category);
+    size_t allocated = size_t(lua_tonumber(L, -2));
+    double time = lua_isnil(L, -1) ? lua_tonumber(L, lua_upvalueindex(3)) : lua_tonumber(L, -1);
+    lua_pop(L, 2);
+
+    // totals wrap around, so the difference is taken in size_t
+    double rate = now > time ? double(size_t(stats.allocatedbytes - allocated)) / (now - time) : 0;
+    lua_pushnumber(L, rate);
+    lua_setfield(L, -2, "rate");
+
+    lua_pushnumber(L, double(stats.allocatedbytes));
+    lua_rawseti(L, lua_upvalueindex(1), category);
+    lua_pushnumber(L, now);
+    lua_rawseti(L, lua_upvalueindex(2), category);
+}
+
+static int memory_stats(lua_State *L) {
+    double now = lua_clock();
+
+    if (!lua_isnoneornil(L, 1)) {
+        int category = checkcategory(L, 1);
+
+        lua_MemCatStats stats;
+        lua_getmemcatstats(L, category, &stats);
+
+        pushstats(L, category, stats, now);
+        return 1;
+    }
+
+    // categories without live bytes, a name or a limit aren't in use
+    lua_newtable(L);
+    int n = 0;
+
+    for (int i = 0; i < LUA_MEMORY_CATEGORIES; i++) {
+        lua_MemCatStats stats;
+        lua_getmemcatstats(L, i, &stats);
+
+        if (stats.bytes || stats.name || stats.softlimit || stats.hardlimit) {
+            pushstats(L, i, stats, now);
+            lua_rawseti(L, -2, ++n);
+        }
+    }
+
+    return 1;
+}
+
+static int memory_category(lua_State *L) {
+    int category = findcategory(L, luaL_checkstring(L, 1));
+
+    if (category < 0)
+        lua_pushnil(L);
+    else
+        lua_pushinteger(L, category);
+
+    return 1;
+}
+
+static int memory_setlimit(lua_State *L) {
+    int category = checkcategory(L, 1);
+    double softlimit = luaL_optnumber(L, 2, 0);
+    double hardlimit = luaL_optnumber(L, 3, 0);
+    luaL_argcheck(L, softlimit >= 0, 2, "limit must be non-negative");
+    luaL_argcheck(L, hardlimit >= 0, 3, "limit must be non-negative");
+
+    lua_setmemcatlimit(L, category, size_t(softlimit), size_t(hardlimit));
+    return 0;
+}
+
+static const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct SnapshotOutput {
+    FILE *file; // NULL for serial
+    size_t bytes;
+
+    size_t size;
+    uint8_t line[57]; // 76 base64 characters
+};
+
+static void printline(SnapshotOutput *out) {
+    char text[80];
+    size_t n = 0;
+
+    for (size_t i = 0; i < out->size; i += 3) {
+        unsigned v = out->line[i] << 16 | (i + 1 < out->size ? out->line[i + 1] << 8 : 0) | (i + 2 < out->size ? out->line[i + 2] : 0);
+
+        text[n++] = kBase64[(v >> 18) & 63];
+        text[n++] = kBase64[(v >> 12) & 63];
+        text[n++] = i + 1 < out->size ? kBase64[(v >> 6) & 63] : '=';
+        text[n++] = i + 2 < out->size ? kBase64[v & 63] : '=';
+    }
+
+    text[n] = 0;
+    printf("#heap %s\n", text);
+
+    out->size = 0;
+}
+
+static void writesnapshot(void *context, const void *data, size_t size) {
+    SnapshotOutput *out = static_cast<SnapshotOutput *>(context);
+    out->bytes += size;
+
+    if (out->file) {
+        fwrite(data, 1, size, out->file);
+        return;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        out->line[out->size++] = static_cast<const uint8_t *>(data)[i];
+
+        if (out->size == sizeof(out->line))
+            printline(out);
+    }
+}
+
+static int memory_snapshot(lua_State *L) {
+    const char *path = luaL_optstring(L, 1, NULL);
+
+    SnapshotOutput out = {};
+
+    if (path) {
+        out.file = fopen(path, "wb");
+        if (!out.file)
+            luaL_error(L, "cannot open '%s'", path);
+    }
+
+    // garbage that wasn't collected yet would show up as growth in the diff
+    lua_gc(L, LUA_GCCOLLECT, 0);
+
+    if (out.file) {
+        lua_heapsnapshot(L, writesnapshot, &out);
+
+        bool failed = ferror(out.file) != 0;
+        fclose(out.file);
+
+        if (failed)
+            luaL_error(L, "cannot write '%s'", path);
+    } else {
+        printf("#heap begin\n");
+        lua_heapsnapshot(L, writesnapshot, &out);
+
+        if (out.size)
+            printline(&out);
+
+        printf("#heap end %u\n", unsigned(out.bytes));
+        fflush(stdout);
+    }
+
+    lua_pushnumber(L, double(out.bytes));
+    return 1;
+}
+
+static void pushhistogram(lua_State *L, const char *name, const lua_GCHistogram &h) {
+    lua_createtable(L, 0, 6);
+
+    lua_pushinteger(L, h.count);
+    lua_setfield(L, -2, "count");
+    lua_pushnumber(L, h.total);
+    lua_setfield(L, -2, "total");
+    lua_pushnumber(L, h.max);
+    lua_setfield(L, -2, "max");
+    lua_pushnumber(L, h.p50);
+    lua_setfield(L, -2, "p50");
+    lua_pushnumber(L, h.p90);
+    lua_setfield(L, -2, "p90");
+    lua_pushnumber(L, h.p99);
+    lua_setfield(L, -2, "p99");
+
+    lua_setfield(L, -2, name);
+}
+
+static int memory_gcmetrics(lua_State *L) {
+    lua_GCMetrics metrics;
+    lua_gcmetrics(L, &metrics);
+
+    lua_createtable(L, 0, 12);
+
+    pushhistogram(L, "mark", metrics.phases[LUA_GCPHASEMARK]);
+    pushhistogram(L, "atomic", metrics.phases[LUA_GCPHASEATOMIC]);
+    pushhistogram(L, "sweep", metrics.phases[LUA_GCPHASESWEEP]);
+    pushhistogram(L, "minor", metrics.phases[LUA_GCPHASEMINOR]);
+    pushhistogram(L, "assist", metrics.assiststeps);
+    pushhistogram(L, "explicit", metrics.explicitsteps);
+    pushhistogram(L, "heapgoal", metrics.heapgoal);
+
+    lua_pushnumber(L, metrics.assistwork);
+    lua_setfield(L, -2, "assistwork");
+    lua_pushnumber(L, metrics.explicitwork);
+    lua_setfield(L, -2, "explicitwork");
+    lua_pushinteger(L, metrics.cycles);
+    lua_setfield(L, -2, "cycles");
+    setfield(L, "goal", metrics.goalbytes);
+    setfield(L, "bytes", metrics.totalbytes);
+
+    return 1;
+}
+
+static int memory_resetgcmetrics(lua_State *L) {
+    lua_gcresetmetrics(L);
+    return 0;
+}
+
+static int memory_gcpace(lua_State *L) {
+    double period = luaL_checknumber(L, 1);
+    double budget = luaL_optnumber(L, 2, period);
+    luaL_argcheck(L, period >= 0, 1, "period must be non-negative");
+    luaL_argcheck(L, budget >= 0, 2, "budget must be non-negative");
+
+    lua_gcpace(L, period, budget);
+    return 0;
+}
+
+static int memory_gctick(lua_State *L) {
+    lua_gctick(L);
+    return 0;
+}
+
+static int memory_gcpacestats(lua_State *L) {
+    lua_GCPaceStats stats;
+    lua_getgcpacestats(L, &stats);
+
+    lua_createtable(L, 0, 8);
+
+    lua_pushinteger(L, stats.ticks);
+    lua_setfield(L, -2, "ticks");
+    lua_pushinteger(L, stats.worked);
+    lua_setfield(L, -2, "worked");
+    lua_pushinteger(L, stats.deferred);
+    lua_setfield(L, -2, "deferred");
+    lua_pushinteger(L, stats.overruns);
+    lua_setfield(L, -2, "overruns");
+    lua_pushinteger(L, stats.fallbacks);
+    lua_setfield(L, -2, "fallbacks");
+    lua_pushnumber(L, stats.lasttime);
+    lua_setfield(L, -2, "lasttime");
+    lua_pushnumber(L, stats.maxtime);
+    lua_setfield(L, -2, "maxtime");
+    lua_pushnumber(L, stats.required);
+    lua_setfield(L, -2, "required");
+
+    return 1;
+}
+
+static int memory_threadpool(lua_State *L) {
+    int size = luaL_checkinteger(L, 1);
+    int stacksize = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, size >= 0, 1, "size must be non-negative");
+    luaL_argcheck(L, stacksize >= 0, 2, "stack size must be non-negative");
+
+    lua_setthreadpool(L, size, stacksize);
+    return 0;
+}
+
+static int memory_threadpoolstats(lua_State *L) {
+    lua_ThreadPoolStats stats;
+    lua_getthreadpoolstats(L, &stats);
+
+    lua_createtable(L, 0, 5);
+
+    lua_pushinteger(L, stats.created);
+    lua_setfield(L, -2, "created");
+    lua_pushinteger(L, stats.reused);
+    lua_setfield(L, -2, "reused");
+    lua_pushinteger(L, stats.dropped);
+    lua_setfield(L, -2, "dropped");
+    lua_pushinteger(L, stats.pooled);
+    lua_setfield(L, -2, "pooled");
+    lua_pushnumber(L, double(stats.bytes));
+    lua_setfield(L, -2, "bytes");
+
+    return 1;
+}
+
+static const luaL_Reg memlib[] = {
+        {"category", memory_category},
+        {"setlimit", memory_setlimit},
+        {"snapshot", memory_snapshot},
+        {"gcmetrics", memory_gcmetrics},
+        {"resetgcmetrics", memory_resetgcmetrics},
+        {"gcpace", memory_gcpace},
+        {"gctick", memory_gctick},
+        {"gcpacestats", memory_gcpacestats},
+        {"threadpool", memory_threadpool},
+        {"threadpoolstats", memory_threadpoolstats},
+        {NULL, NULL},
+};
+
+int luaopen_memory(lua_State *L) {
+    lua_trackmemcats(L);
+
+    luaL_register(L, LUA_MEMLIBNAME, memlib);
+
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_pushnumber(L, lua_clock());
+    lua_pushcclosure(L, memory_stats, "stats", 3);
+    lua_setfield(L, -2, "stats");
+
+    return 1;
+}
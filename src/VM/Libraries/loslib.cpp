@@ -24,7 +24,7 @@ static time_t timegm(struct tm *timep) {
 #endif
 
 static int os_clock(lua_State *L) {
-    lua_pushnumber(L, lua_clock());
+    lua_pushnumber(L, lua_replaynumber(L, lua_clock()));
     return 1;
 }
 
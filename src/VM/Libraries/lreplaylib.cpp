@@ -0,0 +1,32 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#include "../../../include/lualib.h"
+
+static const char *const modenames[] = {"off", "record", "play"};
+
+static int replay_tick(lua_State *L) {
+    lua_pushinteger(L, int(lua_replaytick(L)));
+    return 1;
+}
+
+static int replay_mode(lua_State *L) {
+    lua_pushstring(L, modenames[lua_replaymode(L)]);
+    return 1;
+}
+
+static int replay_clock(lua_State *L) {
+    lua_pushnumber(L, lua_replaynumber(L, lua_clock()));
+    return 1;
+}
+
+static const luaL_Reg replaylib[] = {
+        {"tick",  replay_tick},
+        {"mode",  replay_mode},
+        {"clock", replay_clock},
+        {NULL, NULL},
+};
+
+int luaopen_replay(lua_State *L) {
+    luaL_register(L, LUA_REPLAYLIBNAME, replaylib);
+    return 1;
+}
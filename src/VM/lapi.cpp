@@ -7,10 +7,12 @@
 #include "ltable.h"
 #include "lfunc.h"
 #include "lgc.h"
+#include "lmem.h"
 #include "ldo.h"
 #include "ludata.h"
 #include "lvm.h"
 #include "lnumutils.h"
+#include "lwatchdog.h"
 
 #include <string.h>
 
@@ -874,8 +876,12 @@ int lua_pcall(lua_State *L, int nargs, int nresults, int errfunc) {
     c.func = L->top - (nargs + 1); /* function to be called */
     c.nresults = nresults;
 
+    luaW_beginrun(L);
+
     int status = luaD_pcall(L, f_call, &c, savestack(L, c.func), func);
 
+    luaW_endrun(L);
+
     adjustresults(L, nresults);
     return status;
 }
@@ -1003,12 +1009,31 @@ int lua_gc(lua_State *L, int what, int data) {
             g->gcstepsize = data << 10;
             break;
         }
+        case LUA_GCGEN: {
+            if (data > 0)
+                g->gcgenminormul = data;
+            res = luaC_changemode(L, /* generational= */ true) ? LUA_GCGEN : LUA_GCINC;
+            break;
+        }
+        case LUA_GCINC: {
+            res = luaC_changemode(L, /* generational= */ false) ? LUA_GCGEN : LUA_GCINC;
+            break;
+        }
         default:
             res = -1; /* invalid option */
     }
     return res;
 }
 
+void lua_beginscratch(lua_State *L) {
+    luaC_beginscratch(L);
+}
+
+void lua_endscratch(lua_State *L) {
+    api_check(L, L->global->scratchdepth > 0);
+    luaC_endscratch(L);
+}
+
 /*
 ** miscellaneous functions
 */
@@ -1048,7 +1073,7 @@ void lua_concat(lua_State *L, int n) {
 }
 
 void *lua_newuserdatatagged(lua_State *L, size_t sz, int tag) {
-    api_check(L, unsigned(tag) < LUA_UTAG_LIMIT || tag == UTAG_PROXY);
+    api_check(L, unsigned(tag) < LUA_UTAG_LIMIT || tag == UTAG_PROXY || tag == UTAG_BUFFER);
     luaC_checkGC(L);
     luaC_checkthreadsleep(L);
     Udata *u = luaU_newudata(L, sz, tag);
@@ -1191,3 +1216,58 @@ size_t lua_totalbytes(lua_State *L, int category) {
     api_check(L, category < LUA_MEMORY_CATEGORIES);
     return category < 0 ? L->global->totalbytes : L->global->memcatbytes[category];
 }
+
+void lua_trackmemcats(lua_State *L) {
+    luaM_trackmemcats(L);
+}
+
+void lua_getmemcatstats(lua_State *L, int category, lua_MemCatStats *stats) {
+    api_check(L, unsigned(category) < LUA_MEMORY_CATEGORIES);
+    global_State *g = L->global;
+    stats->bytes = g->memcatbytes[category];
+
+    if (MemCatInfo *info = g->memcatinfo) {
+        stats->name = info[category].name ? getstr(info[category].name) : NULL;
+        stats->peakbytes = info[category].peakbytes;
+        stats->allocatedbytes = info[category].allocatedbytes;
+        stats->softlimit = info[category].softlimit;
+        stats->hardlimit = info[category].hardlimit;
+    } else {
+        stats->name = NULL;
+        stats->peakbytes = stats->bytes;
+        stats->allocatedbytes = 0;
+        stats->softlimit = 0;
+        stats->hardlimit = 0;
+    }
+}
+
+void lua_setmemcatlimit(lua_State *L, int category, size_t softlimit, size_t hardlimit) {
+    api_check(L, unsigned(category) < LUA_MEMORY_CATEGORIES);
+    luaM_trackmemcats(L);
+    L->global->memcatinfo[category].softlimit = softlimit;
+    L->global->memcatinfo[category].hardlimit = hardlimit;
+}
+
+void lua_heapsnapshot(lua_State *L, void (*write)(void *context, const void *data, size_t size), void *context) {
+    luaC_snapshot(L, write, context);
+}
+
+void lua_gcmetrics(lua_State *L, lua_GCMetrics *metrics) {
+    luaC_getmetrics(L, metrics);
+}
+
+void lua_gcresetmetrics(lua_State *L) {
+    luaC_resetmetrics(L);
+}
+
+void lua_gcpace(lua_State *L, double period, double budget) {
+    luaC_setpace(L, period, budget);
+}
+
+void lua_gctick(lua_State *L) {
+    luaC_tick(L);
+}
+
+void lua_getgcpacestats(lua_State *L, lua_GCPaceStats *stats) {
+    luaC_getpacestats(L, stats);
+}
@@ -63,9 +63,17 @@ static l_noret tag_error(lua_State *L, int narg, int tag) {
 
 void luaL_where(lua_State *L, int level) {
     lua_Debug ar;
-    if (lua_getinfo(L, level, "sl", &ar) && ar.currentline > 0) {
-        lua_pushfstring(L, "%s:%d: ", ar.short_src, ar.currentline);
-        return;
+    if (lua_getinfo(L, level, "slp", &ar)) {
+        if (ar.currentline > 0) {
+            lua_pushfstring(L, "%s:%d: ", ar.short_src, ar.currentline);
+            return;
+        }
+
+        /* line info was stripped into the debug info sidecar, see # Debug info sidecar in Bytecode.h */
+        if (ar.pc >= 0) {
+            lua_pushfstring(L, "%s:@%08x/%d/%d: ", ar.short_src, ar.bytecodehash, ar.protoid, ar.pc);
+            return;
+        }
     }
     lua_pushliteral(L, ""); /* else, no information available... */
 }
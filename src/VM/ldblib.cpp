@@ -106,7 +106,7 @@ static int db_traceback(lua_State *L) {
     }
 
     lua_Debug ar;
-    for (int i = level; lua_getinfo(L1, i, "sln", &ar); ++i) {
+    for (int i = level; lua_getinfo(L1, i, "slnp", &ar); ++i) {
         if (strcmp(ar.what, "C") == 0)
             continue;
 
@@ -123,6 +123,11 @@ static int db_traceback(lua_State *L) {
 
             luaL_addchar(&buf, ':');
             luaL_addstring(&buf, line);
+        } else if (ar.pc >= 0) {
+            /* function was stripped of line info, see # Debug info sidecar in Bytecode.h */
+            char location[48];
+            sprintf(location, ":@%08x/%d/%d", ar.bytecodehash, ar.protoid, ar.pc);
+            luaL_addstring(&buf, location);
         }
 
         if (ar.name) {
@@ -124,6 +124,18 @@ static int auxgetinfo(lua_State *L, const char *what, lua_Debug *ar, Closure *f,
                 ar->name = ci ? getfuncname(ci_func(ci)) : getfuncname(f);
                 break;
             }
+            case 'p': {
+                if (f->isC) {
+                    ar->pc = -1;
+                    ar->protoid = -1;
+                    ar->bytecodehash = 0;
+                } else {
+                    ar->pc = ci && isLua(ci) ? currentpc(L, ci) : -1;
+                    ar->protoid = f->l.p->bytecodeid;
+                    ar->bytecodehash = f->l.p->bytecodehash;
+                }
+                break;
+            }
             default:;
         }
     }
@@ -230,10 +242,16 @@ l_noret luaG_readonlyerror(lua_State *L) {
 static void pusherror(lua_State *L, const char *msg) {
     CallInfo *ci = L->ci;
     if (isLua(ci)) {
+        Proto *p = getluaproto(ci);
         char buff[LUA_IDSIZE]; /* add file:line information */
-        luaO_chunkid(buff, getstr(getluaproto(ci)->source), LUA_IDSIZE);
-        int line = currentline(L, ci);
-        luaO_pushfstring(L, "%s:%d: %s", buff, line, msg);
+        luaO_chunkid(buff, getstr(p->source), LUA_IDSIZE);
+        if (p->lineinfo) {
+            int line = currentline(L, ci);
+            luaO_pushfstring(L, "%s:%d: %s", buff, line, msg);
+        } else {
+            /* stripped line info is recovered on the host from the debug info sidecar */
+            luaO_pushfstring(L, "%s:@%08x/%d/%d: %s", buff, p->bytecodehash, p->bytecodeid, currentpc(L, ci), msg);
+        }
     } else {
         lua_pushstring(L, msg);
     }
@@ -255,7 +273,8 @@ void luaG_pusherror(lua_State *L, const char *error) {
 }
 
 void luaG_breakpoint(lua_State *L, Proto *p, int line, bool enable) {
-    if (p->lineinfo) {
+    // code that is executed in place is read-only
+    if (p->lineinfo && !p->codeinplace) {
         for (int i = 0; i < p->sizecode; ++i) {
             // note: we keep prologue as is, instead opting to break at the first meaningful instruction
             if (LUAU_INSN_OP(p->code[i]) == LOP_PREPVARARGS)
@@ -441,7 +460,7 @@ const char *lua_debugtrace(lua_State *L) {
     size_t offset = 0;
 
     lua_Debug ar;
-    for (int level = 0; lua_getinfo(L, level, "sln", &ar); ++level) {
+    for (int level = 0; lua_getinfo(L, level, "slnp", &ar); ++level) {
         if (ar.source)
             offset = append(buf, sizeof(buf), offset, ar.short_src);
 
@@ -450,6 +469,11 @@ const char *lua_debugtrace(lua_State *L) {
             sprintf(line, ":%d", ar.currentline);
 
             offset = append(buf, sizeof(buf), offset, line);
+        } else if (ar.pc >= 0) {
+            char location[48];
+            sprintf(location, ":@%08x/%d/%d", ar.bytecodehash, ar.protoid, ar.pc);
+
+            offset = append(buf, sizeof(buf), offset, location);
         }
 
         if (ar.name) {
@@ -7,6 +7,7 @@
 #include "lgc.h"
 #include "lmem.h"
 #include "lvm.h"
+#include "lwatchdog.h"
 
 #if LUA_USE_LONGJMP
 #include <setjmp.h>
@@ -411,6 +412,8 @@ int lua_resume(lua_State *L, lua_State *from, int nargs) {
 
     luaC_checkthreadsleep(L);
 
+    luaW_beginrun(L);
+
     status = luaD_rawrunprotected(L, resume, L->top - nargs);
 
     CallInfo *ch = NULL;
@@ -421,6 +424,8 @@ int lua_resume(lua_State *L, lua_State *from, int nargs) {
 
     resume_finish(L, status);
     --L->nCcalls;
+
+    luaW_endrun(L);
     return L->status;
 }
 
@@ -438,6 +443,8 @@ int lua_resumeerror(lua_State *L, lua_State *from) {
 
     luaC_checkthreadsleep(L);
 
+    luaW_beginrun(L);
+
     status = LUA_ERRRUN;
 
     CallInfo *ch = NULL;
@@ -448,6 +455,8 @@ int lua_resumeerror(lua_State *L, lua_State *from) {
 
     resume_finish(L, status);
     --L->nCcalls;
+
+    luaW_endrun(L);
     return L->status;
 }
 
@@ -5,9 +5,10 @@
 #include "lstate.h"
 #include "lmem.h"
 #include "lgc.h"
+#include "lvm.h"
 
 Proto *luaF_newproto(lua_State *L) {
-    Proto *f = luaM_newgco(L, Proto, sizeof(Proto), L->activememcat);
+    Proto *f = luaM_newgco(L, Proto, sizeof(Proto), luaE_memcat(L));
     luaC_init(L, f, LUA_TPROTO);
     f->k = NULL;
     f->sizek = 0;
@@ -15,6 +16,10 @@ Proto *luaF_newproto(lua_State *L) {
     f->sizep = 0;
     f->code = NULL;
     f->sizecode = 0;
+    f->cache = NULL;
+    f->sizecache = 0;
+    f->codeinplace = 0;
+    f->modulememcat = 0;
     f->sizeupvalues = 0;
     f->nups = 0;
     f->upvalues = NULL;
@@ -30,11 +35,15 @@ Proto *luaF_newproto(lua_State *L) {
     f->source = NULL;
     f->debugname = NULL;
     f->debuginsn = NULL;
+    f->lazy = NULL;
+    f->lazyoffset = 0;
+    f->bytecodehash = 0;
+    f->bytecodeid = 0;
     return f;
 }
 
 Closure *luaF_newLclosure(lua_State *L, int nelems, Table *e, Proto *p) {
-    Closure *c = luaM_newgco(L, Closure, sizeLclosure(nelems), L->activememcat);
+    Closure *c = luaM_newgco(L, Closure, sizeLclosure(nelems), luaE_memcat(L));
     luaC_init(L, c, LUA_TFUNCTION);
     c->isC = 0;
     c->env = e;
@@ -48,7 +57,7 @@ Closure *luaF_newLclosure(lua_State *L, int nelems, Table *e, Proto *p) {
 }
 
 Closure *luaF_newCclosure(lua_State *L, int nelems, Table *e) {
-    Closure *c = luaM_newgco(L, Closure, sizeCclosure(nelems), L->activememcat);
+    Closure *c = luaM_newgco(L, Closure, sizeCclosure(nelems), luaE_memcat(L));
     luaC_init(L, c, LUA_TFUNCTION);
     c->isC = 1;
     c->env = e;
@@ -76,10 +85,9 @@ UpVal *luaF_findupval(lua_State *L, StkId level) {
         pp = &p->u.l.threadnext;
     }
 
-    UpVal *uv = luaM_newgco(L, UpVal, sizeof(UpVal), L->activememcat); /* not found: create a new one */
+    UpVal *uv = luaM_newgco(L, UpVal, sizeof(UpVal), luaE_memcat(L)); /* not found: create a new one */
     uv->tt = LUA_TUPVAL;
     uv->marked = luaC_white(g);
-    uv->memcat = L->activememcat;
     uv->v = level; /* current value lives in the stack */
 
     // chain the upvalue in the threads open upvalue list at the proper position
@@ -142,7 +150,11 @@ void luaF_close(lua_State *L, StkId level) {
 }
 
 void luaF_freeproto(lua_State *L, Proto *f, lua_Page *page) {
-    luaM_freearray(L, f->code, f->sizecode, Instruction, f->memcat);
+    if (f->lazy)
+        luau_unloadproto(L, f);
+    if (!f->codeinplace)
+        luaM_freearray(L, f->code, f->sizecode, Instruction, f->memcat);
+    luaM_freearray(L, f->cache, f->sizecache, uint8_t, f->memcat);
     luaM_freearray(L, f->p, f->sizep, Proto*, f->memcat);
     luaM_freearray(L, f->k, f->sizek, TValue, f->memcat);
     if (f->lineinfo)
@@ -121,6 +121,54 @@ static void finishGcCycleMetrics(global_State* g)
 }
 #endif
 
+static int histogrambucket(uint32_t value) {
+    if (value < 8)
+        return int(value);
+
+    int log2 = luaO_log2(value);
+    int bucket = 8 + (log2 - 3) * 4 + int((value >> (log2 - 2)) & 3);
+
+    return bucket < GC_HISTOGRAM_BUCKETS ? bucket : GC_HISTOGRAM_BUCKETS - 1;
+}
+
+// largest value that falls into the bucket
+static uint32_t histogramlimit(int bucket) {
+    if (bucket < 8)
+        return uint32_t(bucket);
+
+    int log2 = (bucket - 8) / 4 + 3;
+    return (uint32_t(5 + (bucket - 8) % 4) << (log2 - 2)) - 1;
+}
+
+static void recordhistogram(GCHistogram *h, uint32_t value) {
+    h->counts[histogrambucket(value)]++;
+    h->count++;
+    h->total += value;
+
+    if (value > h->max)
+        h->max = value;
+}
+
+static void recordstep(global_State *g, int phase, bool assist, double seconds, size_t work) {
+    uint32_t us = seconds <= 0 ? 0 : seconds >= 4e3 ? UINT32_MAX : uint32_t(seconds * 1e6);
+
+    double &estimate = g->gcpace.estimate[phase];
+    estimate = seconds > estimate * 0.95 ? seconds : estimate * 0.95;
+
+    if (assist && g->gcpace.period > 0)
+        g->gcpace.stats.fallbacks++;
+
+    recordhistogram(&g->stepmetrics.phases[phase], us);
+
+    if (assist) {
+        recordhistogram(&g->stepmetrics.assiststeps, us);
+        g->stepmetrics.assistwork += work;
+    } else {
+        recordhistogram(&g->stepmetrics.explicitsteps, us);
+        g->stepmetrics.explicitwork += work;
+    }
+}
+
 static void removeentry(LuaNode *n) {
     LUAU_ASSERT(ttisnil(gval(n)));
     if (iscollectable(gkey(n)))
@@ -228,6 +276,10 @@ static void traverseproto(global_State *g, Proto *f) {
         stringmark(f->source);
     if (f->debugname)
         stringmark(f->debugname);
+    if (f->lazy) { /* mark what decoding the proto will refer to */
+        markobject(g, f->lazy->strings);
+        markobject(g, f->lazy->env);
+    }
     for (i = 0; i < f->sizek; i++) /* mark literals */
     markvalue(g, &f->k[i]);
     for (i = 0; i < f->sizeupvalues; i++) { /* mark upvalue names */
@@ -263,8 +315,8 @@ static void traversestack(global_State *g, lua_State *l, bool clearstack) {
     if (l->namecall)
         stringmark(l->namecall);
     for (StkId o = l->stack; o < l->top; o++) markvalue(g, o);
-    /* final traversal? */
-    if (g->gcstate == GCSatomic || clearstack) {
+    /* final traversal? minor collections are atomic */
+    if (g->gcstate == GCSatomic || g->gckind == KGC_GEN || clearstack) {
         StkId stack_end = l->stack + l->stacksize;
         for (StkId o = l->top; o < stack_end; o++) /* clear not-marked stack slice */
             setnilvalue(o);
@@ -321,8 +373,8 @@ static size_t propagatemark(global_State *g) {
             Proto *p = gco2p(o);
             g->gray = p->gclist;
             traverseproto(g, p);
-            return sizeof(Proto) + sizeof(Instruction) * p->sizecode + sizeof(Proto *) * p->sizep +
-                   sizeof(TValue) * p->sizek + p->sizelineinfo +
+            return sizeof(Proto) + (p->codeinplace ? 0 : sizeof(Instruction) * p->sizecode) + p->sizecache +
+                   sizeof(Proto *) * p->sizep + sizeof(TValue) * p->sizek + p->sizelineinfo +
                    sizeof(LocVar) * p->sizelocvars + sizeof(TString *) * p->sizeupvalues;
         }
         default:
@@ -645,6 +697,171 @@ static int sweepgcopage(lua_State *L, lua_Page *page) {
     return int(end - start) / blockSize;
 }
 
+/*
+** Generational mode
+**
+** Objects that survive a collection become old: they keep the marks they got, so old objects are black (strings and
+** open upvalues are gray, like after a mark phase) and the barriers treat the time between minor collections like a
+** mark phase, which keeps young objects that old objects refer to reachable from the gray lists:
+** - forward barriers mark the young object gray, leaving it in `gray'
+** - back barriers put the old table in `grayagain'; threads that wake up are put there too
+** - old weak tables stay gray in `weak' so that their young entries can be cleared
+**
+** A minor collection marks from the roots and these lists only, and frees the unmarked objects from the `young' log of
+** the objects allocated since the previous one; its cost depends on the allocation rate, not on the heap size. When the
+** heap reaches the goal set by the last major collection, all objects are made white again and a regular incremental
+** cycle runs; the objects that survive it are made old when it ends.
+*/
+static bool makeold(void *context, lua_Page *page, GCObject *o) {
+    global_State *g = (global_State *) context;
+
+    white2gray(o);
+
+    switch (o->gch.tt) {
+        case LUA_TSTRING:
+            break;
+        case LUA_TUPVAL:
+            if (gco2uv(o)->v == &gco2uv(o)->u.value) /* closed? */
+                gray2black(o);                         /* open upvalues are never black */
+            break;
+        case LUA_TTABLE: {
+            Table *h = gco2h(o);
+            const char *modev = gettablemode(g, h);
+
+            if (modev && (strchr(modev, 'k') || strchr(modev, 'v'))) {
+                h->gclist = g->weak; /* weak tables are kept gray */
+                g->weak = o;
+            } else {
+                gray2black(o);
+            }
+            break;
+        }
+        case LUA_TTHREAD: {
+            lua_State *th = gco2th(o);
+            LUAU_ASSERT(!luaC_threadsleeping(th));
+
+            th->gclist = g->grayagain; /* the first minor collection puts it to sleep */
+            g->grayagain = o;
+            break;
+        }
+        default:
+            gray2black(o);
+    }
+
+    return false;
+}
+
+static bool makeyoung(void *context, lua_Page *page, GCObject *o) {
+    global_State *g = (global_State *) context;
+
+    makewhite(g, o);
+
+    if (o->gch.tt == LUA_TTHREAD)
+        resetbit(gco2th(o)->stackstate, THREAD_SLEEPINGBIT);
+
+    return false;
+}
+
+static void entergen(lua_State *L) {
+    global_State *g = L->global;
+    LUAU_ASSERT(g->gcstate == GCSpause);
+
+    /* lists may still refer to objects that the sweep made white */
+    g->gray = NULL;
+    g->grayagain = NULL;
+    g->weak = NULL;
+
+    luaM_visitgco(L, g, makeold);
+    makeold(g, NULL, obj2gco(g->mainthread));
+
+    g->nyoung = 0;
+    g->gckind = KGC_GEN;
+}
+
+static void leavegen(lua_State *L, uint8_t kind) {
+    global_State *g = L->global;
+    LUAU_ASSERT(g->gckind == KGC_GEN && g->gcstate == GCSpause);
+
+    luaM_visitgco(L, g, makeyoung);
+    makeyoung(g, NULL, obj2gco(g->mainthread));
+
+    g->gray = NULL;
+    g->grayagain = NULL;
+    g->weak = NULL;
+
+    g->nyoung = 0;
+    g->gckind = kind;
+}
+
+static size_t sweepyoung(lua_State *L) {
+    global_State *g = L->global;
+
+    /* objects allocated by userdata destructors are kept for the next collection */
+    int count = g->nyoung;
+
+    for (int i = 0; i < count; ++i) {
+        GCObject *o = g->young[i].o;
+
+        if (!iswhite(o))
+            continue; /* marked objects are old now */
+
+        if (isfixed(o))
+            makeold(g, NULL, o);
+        else
+            freeobj(L, o, g->young[i].page);
+    }
+
+    memmove(g->young, g->young + count, (g->nyoung - count) * sizeof(GCYoung));
+    g->nyoung -= count;
+
+    return count * GC_SWEEPPAGESTEPCOST;
+}
+
+static size_t youngcollection(lua_State *L) {
+    global_State *g = L->global;
+    LUAU_ASSERT(g->gckind == KGC_GEN && g->gcstate == GCSpause);
+
+    size_t work = 0;
+
+    /* threads that aren't running are put to sleep like in the mark phase */
+    g->gcstate = GCSpropagate;
+
+    /* mark from the roots and from the objects marked by forward barriers */
+    markobject(g, L);
+    markvalue(g, registry(L));
+    markmt(g);
+    work += propagateall(g);
+
+    /* traverse old tables changed by back barriers and threads that ran since the last collection */
+    g->gray = g->grayagain;
+    g->grayagain = NULL;
+    work += propagateall(g);
+
+    /* traverse old weak tables, which don't get barriers */
+    g->gray = g->weak;
+    g->weak = NULL;
+    work += propagateall(g);
+
+    /* open upvalues don't get barriers either */
+    work += remarkupvals(g);
+    work += propagateall(g);
+
+    /* remove young objects from weak tables; the tables stay in `weak' for the next collection */
+    work += cleartable(L, g->weak);
+
+    work += sweepyoung(L);
+
+    g->gcstate = GCSpause;
+    return work;
+}
+
+// minor collections run when the heap grows by a fraction of the size that the goal of the last major collection is based on
+static size_t getminortrigger(global_State *g) {
+    double live = double(g->gcstats.heapgoalsizebytes) * 100 / (g->gcgoal > 0 ? g->gcgoal : 100);
+
+    return g->totalbytes + size_t(live * g->gcgenminormul / 100);
+}
+
 static size_t gcstep(lua_State *L, size_t limit) {
     size_t cost = 0;
     global_State *g = L->global;
@@ -790,9 +1007,29 @@ size_t luaC_step(lua_State *L, bool assist) {
 
     GC_INTERRUPT(0);
 
+    double starttimestamp = lua_clock();
+
+    if (g->gckind == KGC_GEN) {
+        size_t work = youngcollection(L);
+
+        recordstep(g, LUA_GCPHASEMINOR, assist, lua_clock() - starttimestamp, work);
+
+        // when the old objects reach the heap goal, they are collected by an incremental major cycle that starts on the next step
+        if (g->totalbytes >= g->gcstats.heapgoalsizebytes) {
+            leavegen(L, KGC_GENMAJOR);
+            g->GCthreshold = g->totalbytes;
+        } else {
+            g->GCthreshold = getminortrigger(g);
+        }
+
+        GC_INTERRUPT(GCSpause);
+
+        return work * 100 / g->gcstepmul;
+    }
+
     // at the start of the new cycle
     if (g->gcstate == GCSpause)
-        g->gcstats.starttimestamp = lua_clock();
+        g->gcstats.starttimestamp = starttimestamp;
 
 #ifdef LUAI_GCMETRICS
     if (g->gcstate == GCSpause)
@@ -809,6 +1046,17 @@ size_t luaC_step(lua_State *L, bool assist) {
     recordGcStateStep(g, lastgcstate, lua_clock() - lasttimestamp, assist, work);
 #endif
 
+    // the step timestamps double as the cycle timestamps, so that a step only reads the clock twice
+    double endtimestamp = lua_clock();
+
+    int phase = lastgcstate == GCSatomic ? LUA_GCPHASEATOMIC : lastgcstate == GCSsweep ? LUA_GCPHASESWEEP : LUA_GCPHASEMARK;
+    recordstep(g, phase, assist, endtimestamp - starttimestamp, work);
+
+    // how close the trigger got the end of the mark phase to the goal it was placed for
+    if (lastgcstate == GCSatomic && g->gcstats.heapgoalsizebytes)
+        recordhistogram(&g->stepmetrics.heapgoal, uint32_t(double(g->gcstats.atomicstarttotalsizebytes) * 100 /
+                                                               double(g->gcstats.heapgoalsizebytes)));
+
     size_t actualstepsize = work * 100 / g->gcstepmul;
 
     // at the end of the last cycle
@@ -820,9 +1068,17 @@ size_t luaC_step(lua_State *L, bool assist) {
         g->GCthreshold = heaptrigger;
 
         g->gcstats.heapgoalsizebytes = heapgoal;
-        g->gcstats.endtimestamp = lua_clock();
+        g->gcstats.endtimestamp = endtimestamp;
         g->gcstats.endtotalsizebytes = g->totalbytes;
 
+        g->stepmetrics.cycles++;
+
+        // the objects that survived the major collection are the new old generation
+        if (g->gckind == KGC_GENMAJOR) {
+            entergen(L);
+            g->GCthreshold = getminortrigger(g);
+        }
+
 #ifdef LUAI_GCMETRICS
         finishGcCycleMetrics(g);
 #endif
@@ -842,6 +1098,9 @@ size_t luaC_step(lua_State *L, bool assist) {
 void luaC_fullgc(lua_State *L) {
     global_State *g = L->global;
 
+    if (g->gckind == KGC_GEN)
+        leavegen(L, KGC_GENMAJOR);
+
 #ifdef LUAI_GCMETRICS
     if (g->gcstate == GCSpause)
         startGcCycleMetrics(g);
@@ -891,11 +1150,77 @@ void luaC_fullgc(lua_State *L) {
 
     g->gcstats.heapgoalsizebytes = heapgoalsizebytes;
 
+    if (g->gckind == KGC_GENMAJOR) {
+        entergen(L);
+        g->GCthreshold = getminortrigger(g);
+    }
+
 #ifdef LUAI_GCMETRICS
     finishGcCycleMetrics(g);
 #endif
 }
 
+bool luaC_changemode(lua_State *L, bool generational) {
+    global_State *g = L->global;
+    bool wasgenerational = g->gckind != KGC_INC;
+
+    if (generational && g->gckind == KGC_INC) {
+        if (g->gcstate == GCSpause) {
+            entergen(L);
+
+            if (g->GCthreshold != SIZE_MAX) // don't restart a stopped collector
+                g->GCthreshold = getminortrigger(g);
+        } else {
+            g->gckind = KGC_GENMAJOR; // the current cycle becomes the first major collection
+        }
+    } else if (!generational && g->gckind != KGC_INC) {
+        if (g->gckind == KGC_GEN)
+            leavegen(L, KGC_INC);
+
+        g->gckind = KGC_INC;
+    }
+
+    return wasgenerational;
+}
+
+void luaC_beginscratch(lua_State *L) {
+    global_State *g = L->global;
+
+    if (g->scratchdepth++ > 0)
+        return;
+
+    g->scratchthreshold = g->GCthreshold;
+
+    // objects allocated in the scope are expected to die with it, so collecting before the end would be wasted work
+    if (g->GCthreshold < g->gcstats.heapgoalsizebytes)
+        g->GCthreshold = g->gcstats.heapgoalsizebytes;
+}
+
+void luaC_endscratch(lua_State *L) {
+    global_State *g = L->global;
+    LUAU_ASSERT(g->scratchdepth > 0);
+
+    if (--g->scratchdepth > 0)
+        return;
+
+    if (g->GCthreshold == SIZE_MAX) // the collector was stopped
+        return;
+
+    if (g->gckind == KGC_GEN && g->gcpace.period > 0) {
+        // a paced collector leaves the minor collection to the next lua_gctick, so it stays out of the loop timing
+        g->GCthreshold = g->scratchthreshold;
+        g->gcpace.threshold = g->totalbytes;
+    } else if (g->gckind == KGC_GEN) {
+        // the barriers remembered every older object that the scope stored its objects into, so a minor collection frees the rest
+        g->GCthreshold = g->totalbytes;
+        luaC_step(L, false);
+    } else {
+        // the steps that were deferred are paid back by the following allocations
+        if (g->GCthreshold > g->scratchthreshold)
+            g->GCthreshold = g->scratchthreshold;
+    }
+}
+
 void luaC_barrierupval(lua_State *L, GCObject *v) {
     global_State *g = L->global;
     LUAU_ASSERT(iswhite(v) && !isdead(g, v));
@@ -907,7 +1232,7 @@ void luaC_barrierupval(lua_State *L, GCObject *v) {
 void luaC_barrierf(lua_State *L, GCObject *o, GCObject *v) {
     global_State *g = L->global;
     LUAU_ASSERT(isblack(o) && iswhite(v) && !isdead(g, v) && !isdead(g, o));
-    LUAU_ASSERT(g->gcstate != GCSpause);
+    LUAU_ASSERT(g->gcstate != GCSpause || g->gckind == KGC_GEN);
     /* must keep invariant? */
     if (keepinvariant(g))
         reallymarkobject(g, v); /* restore invariant */
@@ -927,7 +1252,7 @@ void luaC_barriertable(lua_State *L, Table *t, GCObject *v) {
     }
 
     LUAU_ASSERT(isblack(o) && !isdead(g, o));
-    LUAU_ASSERT(g->gcstate != GCSpause);
+    LUAU_ASSERT(g->gcstate != GCSpause || g->gckind == KGC_GEN);
     black2gray(o); /* make table gray (again) */
     t->gclist = g->grayagain;
     g->grayagain = o;
@@ -937,7 +1262,7 @@ void luaC_barrierback(lua_State *L, Table *t) {
     global_State *g = L->global;
     GCObject *o = obj2gco(t);
     LUAU_ASSERT(isblack(o) && !isdead(g, o));
-    LUAU_ASSERT(g->gcstate != GCSpause);
+    LUAU_ASSERT(g->gcstate != GCSpause || g->gckind == KGC_GEN);
     black2gray(o); /* make table gray (again) */
     t->gclist = g->grayagain;
     g->grayagain = o;
@@ -947,7 +1272,6 @@ void luaC_initobj(lua_State *L, GCObject *o, uint8_t tt) {
     global_State *g = L->global;
     o->gch.marked = luaC_white(g);
     o->gch.tt = tt;
-    o->gch.memcat = L->activememcat;
 }
 
 void luaC_initupval(lua_State *L, UpVal *uv) {
@@ -989,6 +1313,210 @@ int64_t luaC_allocationrate(lua_State *L) {
     return int64_t((g->gcstats.atomicstarttotalsizebytes - g->gcstats.endtotalsizebytes) / duration);
 }
 
+/*
+** Pacing moves the GC work out of the allocations and into lua_gctick, which runs at the end of every loop iteration.
+** Between ticks GCthreshold is raised to a limit above the threshold that the collector asked for, and a tick runs steps
+** for as long as the collector has work and the slack of the tick allows. Whether the next step fits is predicted from the
+** recent step times of its phase, which matters most for the atomic phase and minor collections that can't be split.
+*/
+
+#define GC_PACE_LAG 2 // ticks of allocation that the heap may run ahead of the collector before allocations assist
+
+static int nextphase(global_State *g) {
+    if (g->gckind == KGC_GEN)
+        return LUA_GCPHASEMINOR;
+
+    return g->gcstate == GCSatomic ? LUA_GCPHASEATOMIC : g->gcstate == GCSsweep ? LUA_GCPHASESWEEP : LUA_GCPHASEMARK;
+}
+
+static size_t pacelag(lua_State *L) {
+    global_State *g = L->global;
+    const GCPaceState &pace = g->gcpace;
+
+    // the net allocation rate hides the garbage that minor collections free, the growth between ticks doesn't
+    size_t lag = pace.tickbytes;
+    int64_t rate = luaC_allocationrate(L);
+
+    if (rate > 0 && size_t(double(rate) * pace.period) > lag)
+        lag = size_t(double(rate) * pace.period);
+
+    return lag * GC_PACE_LAG;
+}
+
+static void applypace(lua_State *L, size_t threshold) {
+    global_State *g = L->global;
+    GCPaceState &pace = g->gcpace;
+
+    size_t limit = g->gcstats.heapgoalsizebytes;
+    size_t lag = pacelag(L);
+
+    if (threshold + lag > limit)
+        limit = threshold + lag;
+
+    pace.threshold = threshold;
+    pace.applied = threshold > limit ? threshold : limit;
+    pace.lastbytes = g->totalbytes;
+    g->GCthreshold = pace.applied;
+}
+
+void luaC_setpace(lua_State *L, double period, double budget) {
+    global_State *g = L->global;
+    GCPaceState &pace = g->gcpace;
+
+    bool paced = pace.period > 0;
+
+    pace.period = period;
+    pace.budget = budget;
+    pace.tickend = 0;
+
+    if (g->GCthreshold == SIZE_MAX) // the collector is stopped
+        return;
+
+    if (period > 0 && !paced)
+        applypace(L, g->GCthreshold);
+    else if (period <= 0 && paced && g->GCthreshold == pace.applied)
+        g->GCthreshold = pace.threshold;
+}
+
+void luaC_tick(lua_State *L) {
+    global_State *g = L->global;
+    GCPaceState &pace = g->gcpace;
+
+    if (pace.period <= 0)
+        return;
+
+    double now = lua_clock();
+
+    // the first tick only starts the schedule; later ticks end a period after the previous one
+    if (pace.tickend == 0) {
+        pace.tickend = now;
+        return;
+    }
+
+    pace.tickend += pace.period;
+    pace.stats.ticks++;
+
+    size_t grown = g->totalbytes > pace.lastbytes ? g->totalbytes - pace.lastbytes : 0;
+    pace.tickbytes = grown > size_t(pace.tickbytes * 0.95) ? grown : size_t(pace.tickbytes * 0.95);
+
+    if (now >= pace.tickend) {
+        pace.stats.overruns++;
+        pace.tickend = now;
+    }
+
+    // work that doesn't fit in this tick is left for the following ones; the allocation rate tells how much is needed
+    const GCStepMetrics &m = g->stepmetrics;
+    double worktime = 0;
+    for (int i = 0; i < LUA_GCPHASE_COUNT; i++)
+        worktime += double(m.phases[i].total) * 1e-6;
+
+    int64_t rate = luaC_allocationrate(L);
+    double work = double(m.assistwork + m.explicitwork);
+
+    double workrate = work > 0 && worktime > 0 ? work / worktime : 0;
+
+    if (rate >= 0 && workrate > 0)
+        pace.stats.required = double(rate) * pace.period * g->gcstepmul / 100 / workrate;
+
+    if (g->GCthreshold == SIZE_MAX) // the collector is stopped
+        return;
+
+    // anything else that changed the threshold (an assist, a full collection, an explicit step) knows better than the last tick
+    size_t threshold = g->GCthreshold == pace.applied ? pace.threshold : g->GCthreshold;
+
+    // a major cycle that only starts at the heap goal can't keep up in slices of the budget; start it early enough to finish there
+    if (g->gckind == KGC_GEN && workrate > 0 && pace.budget > 0) {
+        double majorticks = double(g->totalbytes) / workrate / pace.budget;
+
+        if (g->totalbytes + size_t((majorticks + GC_PACE_LAG) * double(pace.tickbytes)) >= g->gcstats.heapgoalsizebytes) {
+            leavegen(L, KGC_GENMAJOR);
+            threshold = g->totalbytes;
+        }
+    }
+
+    double deadline = now + pace.budget < pace.tickend ? now + pace.budget : pace.tickend;
+    double start = now;
+    bool worked = false;
+
+    while (g->gcstate != GCSpause || g->totalbytes >= threshold) {
+        double &estimate = pace.estimate[nextphase(g)];
+
+        // the estimate decays while the phase waits as well, so that a single slow step can't hold the work back for good
+        if (now + estimate > deadline) {
+            estimate *= 0.95;
+            pace.stats.deferred++;
+            break;
+        }
+
+        g->GCthreshold = threshold < g->totalbytes ? threshold : g->totalbytes;
+        luaC_step(L, false);
+
+        threshold = g->GCthreshold;
+        worked = true;
+        now = lua_clock();
+    }
+
+    applypace(L, threshold);
+
+    pace.stats.worked += worked;
+    pace.stats.lasttime = worked ? now - start : 0;
+
+    if (pace.stats.lasttime > pace.stats.maxtime)
+        pace.stats.maxtime = pace.stats.lasttime;
+}
+
+void luaC_getpacestats(lua_State *L, lua_GCPaceStats *stats) {
+    *stats = L->global->gcpace.stats;
+}
+
+static double histogrampercentile(const GCHistogram *h, double percentile) {
+    uint32_t rank = uint32_t(h->count * percentile + 0.5);
+    uint32_t seen = 0;
+
+    for (int i = 0; i < GC_HISTOGRAM_BUCKETS; i++) {
+        seen += h->counts[i];
+
+        if (seen >= rank && seen > 0) {
+            uint32_t limit = histogramlimit(i);
+            return limit < h->max ? limit : h->max;
+        }
+    }
+
+    return h->max;
+}
+
+static void gethistogram(const GCHistogram *h, double scale, lua_GCHistogram *result) {
+    result->count = h->count;
+    result->total = double(h->total) * scale;
+    result->max = double(h->max) * scale;
+    result->p50 = histogrampercentile(h, 0.5) * scale;
+    result->p90 = histogrampercentile(h, 0.9) * scale;
+    result->p99 = histogrampercentile(h, 0.99) * scale;
+}
+
+void luaC_getmetrics(lua_State *L, lua_GCMetrics *metrics) {
+    global_State *g = L->global;
+    const GCStepMetrics &m = g->stepmetrics;
+
+    for (int i = 0; i < LUA_GCPHASE_COUNT; i++)
+        gethistogram(&m.phases[i], 1e-6, &metrics->phases[i]);
+
+    gethistogram(&m.assiststeps, 1e-6, &metrics->assiststeps);
+    gethistogram(&m.explicitsteps, 1e-6, &metrics->explicitsteps);
+    gethistogram(&m.heapgoal, 1, &metrics->heapgoal);
+
+    metrics->assistwork = double(m.assistwork);
+    metrics->explicitwork = double(m.explicitwork);
+    metrics->cycles = m.cycles;
+
+    metrics->goalbytes = g->gcstats.heapgoalsizebytes;
+    metrics->totalbytes = g->totalbytes;
+}
+
+void luaC_resetmetrics(lua_State *L) {
+    L->global->stepmetrics = GCStepMetrics();
+}
+
 void luaC_wakethread(lua_State *L) {
     if (!luaC_threadsleeping(L))
         return;
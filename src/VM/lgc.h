@@ -12,6 +12,7 @@
 #define LUAI_GCGOAL 200    /* 200% (allow heap to double compared to live heap size) */
 #define LUAI_GCSTEPMUL 200 /* GC runs 'twice the speed' of memory allocation */
 #define LUAI_GCSTEPSIZE 1  /* GC runs every KB of memory allocation */
+#define LUAI_GCGENMINORMUL 20 /* generational mode runs a minor collection after the heap grows by 20% of its live size */
 
 /*
 ** Possible states of the Garbage Collector
@@ -22,14 +23,25 @@
 #define GCSatomic 3
 #define GCSsweep 4
 
+/*
+** Kinds of the Garbage Collector
+** in the generational mode, objects that survived a collection are old and stay marked until the next major collection;
+** the heap is in KGC_GEN between minor collections and in KGC_GENMAJOR while an incremental major collection runs
+*/
+#define KGC_INC 0
+#define KGC_GEN 1
+#define KGC_GENMAJOR 2
+
 /*
 ** macro to tell when main invariant (white objects cannot point to black
 ** ones) must be kept. During a collection, the sweep
 ** phase may break the invariant, as objects turned white may point to
 ** still-black objects. The invariant is restored when sweep ends and
-** all objects are white again.
+** all objects are white again. Between minor collections, old objects
+** are black and the barriers keep young objects reachable from them.
 */
-#define keepinvariant(g) ((g)->gcstate == GCSpropagate || (g)->gcstate == GCSpropagateagain || (g)->gcstate == GCSatomic)
+#define keepinvariant(g) \
+    ((g)->gcstate == GCSpropagate || (g)->gcstate == GCSpropagateagain || (g)->gcstate == GCSatomic || (g)->gckind == KGC_GEN)
 
 /*
 ** some useful bit tricks
@@ -138,6 +150,12 @@ LUAI_FUNC size_t luaC_step(lua_State *L, bool assist);
 
 LUAI_FUNC void luaC_fullgc(lua_State *L);
 
+LUAI_FUNC bool luaC_changemode(lua_State *L, bool generational);
+
+LUAI_FUNC void luaC_beginscratch(lua_State *L);
+
+LUAI_FUNC void luaC_endscratch(lua_State *L);
+
 LUAI_FUNC void luaC_initobj(lua_State *L, GCObject *o, uint8_t tt);
 
 LUAI_FUNC void luaC_initupval(lua_State *L, UpVal *uv);
@@ -154,8 +172,20 @@ LUAI_FUNC void luaC_validate(lua_State *L);
 
 LUAI_FUNC void luaC_dump(lua_State *L, void *file, const char *(*categoryName)(lua_State *L, uint8_t memcat));
 
+LUAI_FUNC void luaC_snapshot(lua_State *L, void (*write)(void *context, const void *data, size_t size), void *context);
+
 LUAI_FUNC int64_t luaC_allocationrate(lua_State *L);
 
+LUAI_FUNC void luaC_getmetrics(lua_State *L, lua_GCMetrics *metrics);
+
+LUAI_FUNC void luaC_resetmetrics(lua_State *L);
+
+LUAI_FUNC void luaC_setpace(lua_State *L, double period, double budget);
+
+LUAI_FUNC void luaC_tick(lua_State *L);
+
+LUAI_FUNC void luaC_getpacestats(lua_State *L, lua_GCPaceStats *stats);
+
 LUAI_FUNC void luaC_wakethread(lua_State *L);
 
 LUAI_FUNC const char *luaC_statename(int state);
@@ -8,6 +8,7 @@
 #include "lstate.h"
 #include "lstring.h"
 #include "ltable.h"
+#include "ltm.h"
 #include "ludata.h"
 
 #include <string.h>
@@ -208,6 +209,9 @@ void luaC_validate(lua_State *L) {
     validategraylist(g, g->gray);
     validategraylist(g, g->grayagain);
 
+    /* objects are only logged between minor collections */
+    LUAU_ASSERT(g->gckind == KGC_GEN || g->nyoung == 0);
+
     validategco(L, NULL, obj2gco(g->mainthread));
 
     luaM_visitgco(L, L, validategco);
@@ -252,11 +256,21 @@ static void dumpstring(FILE *f, TString *ts) {
     fprintf(f, "\"}");
 }
 
-static void dumptable(FILE *f, Table *h) {
-    size_t size = sizeof(Table) + (h->node == &luaH_dummynode ? 0 : sizenode(h) * sizeof(LuaNode)) +
-                  h->sizearray * sizeof(TValue);
+static size_t tablesize(Table *h) {
+    return sizeof(Table) + (h->node == &luaH_dummynode ? 0 : sizenode(h) * sizeof(LuaNode)) + h->sizearray * sizeof(TValue);
+}
+
+static size_t threadsize(lua_State *th) {
+    return sizeof(lua_State) + sizeof(TValue) * th->stacksize + sizeof(CallInfo) * th->size_ci;
+}
+
+static size_t protosize(Proto *p) {
+    return sizeof(Proto) + (p->codeinplace ? 0 : sizeof(Instruction) * p->sizecode) + p->sizecache + sizeof(Proto *) * p->sizep +
+           sizeof(TValue) * p->sizek + p->sizelineinfo + sizeof(LocVar) * p->sizelocvars + sizeof(TString *) * p->sizeupvalues;
+}
 
-    fprintf(f, "{\"type\":\"table\",\"cat\":%d,\"size\":%d", h->memcat, int(size));
+static void dumptable(FILE *f, Table *h) {
+    fprintf(f, "{\"type\":\"table\",\"cat\":%d,\"size\":%d", h->memcat, int(tablesize(h)));
 
     if (h->node != &luaH_dummynode) {
         fprintf(f, ",\"pairs\":[");
@@ -335,9 +349,7 @@ static void dumpudata(FILE *f, Udata *u) {
 }
 
 static void dumpthread(FILE *f, lua_State *th) {
-    size_t size = sizeof(lua_State) + sizeof(TValue) * th->stacksize + sizeof(CallInfo) * th->size_ci;
-
-    fprintf(f, "{\"type\":\"thread\",\"cat\":%d,\"size\":%d", th->memcat, int(size));
+    fprintf(f, "{\"type\":\"thread\",\"cat\":%d,\"size\":%d", th->memcat, int(threadsize(th)));
 
     fprintf(f, ",\"env\":");
     dumpref(f, obj2gco(th->gt));
@@ -367,12 +379,7 @@ static void dumpthread(FILE *f, lua_State *th) {
 }
 
 static void dumpproto(FILE *f, Proto *p) {
-    size_t size =
-            sizeof(Proto) + sizeof(Instruction) * p->sizecode + sizeof(Proto *) * p->sizep + sizeof(TValue) * p->sizek +
-            p->sizelineinfo +
-            sizeof(LocVar) * p->sizelocvars + sizeof(TString *) * p->sizeupvalues;
-
-    fprintf(f, "{\"type\":\"proto\",\"cat\":%d,\"size\":%d", p->memcat, int(size));
+    fprintf(f, "{\"type\":\"proto\",\"cat\":%d,\"size\":%d", p->memcat, int(protosize(p)));
 
     if (p->source) {
         fprintf(f, ",\"source\":\"");
@@ -483,3 +490,333 @@ void luaC_dump(lua_State *L, void *file, const char *(*categoryName)(lua_State *
     fprintf(f, "}\n");
     fprintf(f, "}}\n");
 }
+
+/*
+ * Heap snapshots are a compact binary form of luaC_dump, meant to be written on the robot (to the SD card or over serial) and
+ * analyzed on the host by Serene.HeapDiff. Addresses identify objects within a snapshot and, as long as an object survives,
+ * across snapshots of the same VM. Numbers are unsigned LEB128 varints:
+ *
+ *   magic "SHSN", byte version
+ *   varint total bytes
+ *   varint category count, then for each named category: byte category, varint length, name
+ *   varint root count, then the roots: main thread, registry and the metatables of basic types
+ *   objects, each:
+ *     byte type (LUA_T*), byte memory category, byte flags (SNAPSHOT_*), varint address, varint size
+ *     string: varint length, the first min(length, SNAPSHOT_STRING_PREFIX) bytes
+ *     function: proto, or a C function name given like a string
+ *     proto: varint line defined, source, debug name
+ *     table: varint number of fields, entries with a string key and an object value; the references start with the key and
+ *     the value of each field
+ *     userdata: byte tag
+ *     referenced objects, terminated by 0; references that don't keep an object alive (weak table entries) are left out
+ *   byte 255
+ *
+ * The address of an object is zigzag encoded as the difference to the address of the previous object (or 0). Other objects
+ * are zigzag encoded as the difference of their address to the address of the object that refers to them (or 0, for the
+ * roots), plus one; 0 stands for no object.
+ */
+
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_STRING_PREFIX 32
+
+enum SnapshotFlags {
+    SNAPSHOT_FIXED = 1 << 0, // never collected, e.g. reserved words and module names
+    SNAPSHOT_WEAKKEYS = 1 << 1,
+    SNAPSHOT_WEAKVALUES = 1 << 2,
+    SNAPSHOT_CFUNCTION = 1 << 3,
+};
+
+struct SnapshotWriter {
+    void (*write)(void *context, const void *data, size_t size);
+    void *context;
+
+    uintptr_t base; // address of the object that is being written
+    uintptr_t last; // address of the previous object
+
+    size_t size;
+    uint8_t buffer[256];
+};
+
+static void snapflush(SnapshotWriter *w) {
+    if (w->size)
+        w->write(w->context, w->buffer, w->size);
+
+    w->size = 0;
+}
+
+static void snapbyte(SnapshotWriter *w, uint8_t value) {
+    if (w->size == sizeof(w->buffer))
+        snapflush(w);
+
+    w->buffer[w->size++] = value;
+}
+
+static void snapvarint(SnapshotWriter *w, uint64_t value) {
+    do {
+        uint8_t byte = value & 127;
+        value >>= 7;
+        snapbyte(w, value ? byte | 128 : byte);
+    } while (value);
+}
+
+static void snapdata(SnapshotWriter *w, const char *data, size_t len) {
+    snapvarint(w, len);
+
+    for (size_t i = 0; i < len && i < SNAPSHOT_STRING_PREFIX; ++i)
+        snapbyte(w, uint8_t(data[i]));
+}
+
+static uint64_t zigzag(int64_t value) {
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+// objects mostly refer to objects on the same page, so the difference is usually much smaller than the address
+static void snapref(SnapshotWriter *w, GCObject *o) {
+    snapvarint(w, o ? zigzag(int64_t(uintptr_t(o)) - int64_t(w->base)) + 1 : 0);
+}
+
+static void snaprefs(SnapshotWriter *w, TValue *data, size_t size) {
+    for (size_t i = 0; i < size; ++i)
+        if (iscollectable(&data[i]))
+            snapref(w, gcvalue(&data[i]));
+}
+
+static void snapheader(SnapshotWriter *w, GCObject *o, size_t size, uint8_t flags) {
+    snapbyte(w, o->gch.tt);
+    snapbyte(w, o->gch.memcat);
+    snapbyte(w, isfixed(o) ? flags | SNAPSHOT_FIXED : flags);
+    snapvarint(w, zigzag(int64_t(uintptr_t(o)) - int64_t(w->last)));
+    snapvarint(w, size);
+
+    w->base = w->last = uintptr_t(o);
+}
+
+// entries with a string key and an object value name the object in Serene.HeapDiff
+static bool isfield(LuaNode *n) {
+    return ttisstring(&n->key) && iscollectable(&n->val);
+}
+
+static void snaptable(SnapshotWriter *w, global_State *g, Table *h) {
+    const TValue *mode = gfasttm(g, h->metatable, TM_MODE);
+    const char *modev = mode && ttisstring(mode) ? svalue(mode) : NULL;
+    bool weakkey = modev && strchr(modev, 'k');
+    bool weakvalue = modev && strchr(modev, 'v');
+
+    snapheader(w, obj2gco(h), tablesize(h), (weakkey ? SNAPSHOT_WEAKKEYS : 0) | (weakvalue ? SNAPSHOT_WEAKVALUES : 0));
+
+    bool named = !weakkey && !weakvalue && h->node != &luaH_dummynode;
+    int fields = 0;
+
+    if (named)
+        for (int i = 0; i < sizenode(h); ++i)
+            if (isfield(&h->node[i]))
+                fields++;
+
+    snapvarint(w, fields);
+
+    if (named)
+        for (int i = 0; i < sizenode(h); ++i)
+            if (isfield(&h->node[i])) {
+                snapref(w, gcvalue(&h->node[i].key));
+                snapref(w, gcvalue(&h->node[i].val));
+            }
+
+    if (h->metatable)
+        snapref(w, obj2gco(h->metatable));
+
+    if (!weakvalue)
+        snaprefs(w, h->array, h->sizearray);
+
+    if (h->node != &luaH_dummynode) {
+        for (int i = 0; i < sizenode(h); ++i) {
+            LuaNode &n = h->node[i];
+
+            if (ttisnil(&n.val) || (named && isfield(&n)))
+                continue;
+
+            if (!weakkey && iscollectable(&n.key))
+                snapref(w, gcvalue(&n.key));
+
+            if (!weakvalue && iscollectable(&n.val))
+                snapref(w, gcvalue(&n.val));
+        }
+    }
+}
+
+static void snapclosure(SnapshotWriter *w, Closure *cl) {
+    if (cl->isC) {
+        snapheader(w, obj2gco(cl), sizeCclosure(cl->nupvalues), SNAPSHOT_CFUNCTION);
+
+        const char *name = cl->c.debugname ? cl->c.debugname : "";
+        snapdata(w, name, strlen(name));
+
+        snaprefs(w, cl->c.upvals, cl->nupvalues);
+    } else {
+        snapheader(w, obj2gco(cl), sizeLclosure(cl->nupvalues), 0);
+        snapref(w, obj2gco(cl->l.p));
+
+        // the proto is also a reference
+        snapref(w, obj2gco(cl->l.p));
+        snaprefs(w, cl->l.uprefs, cl->nupvalues);
+    }
+
+    snapref(w, obj2gco(cl->env));
+}
+
+static void snapproto(SnapshotWriter *w, Proto *p) {
+    snapheader(w, obj2gco(p), protosize(p), 0);
+    snapvarint(w, p->linedefined);
+    snapref(w, p->source ? obj2gco(p->source) : NULL);
+    snapref(w, p->debugname ? obj2gco(p->debugname) : NULL);
+
+    if (p->source)
+        snapref(w, obj2gco(p->source));
+
+    if (p->debugname)
+        snapref(w, obj2gco(p->debugname));
+
+    if (p->lazy) {
+        snapref(w, obj2gco(p->lazy->strings));
+        snapref(w, obj2gco(p->lazy->env));
+    }
+
+    snaprefs(w, p->k, p->sizek);
+
+    for (int i = 0; i < p->sizep; ++i)
+        snapref(w, obj2gco(p->p[i]));
+
+    for (int i = 0; i < p->sizelocvars; ++i)
+        if (p->locvars[i].varname)
+            snapref(w, obj2gco(p->locvars[i].varname));
+
+    for (int i = 0; i < p->sizeupvalues; ++i)
+        if (p->upvalues[i])
+            snapref(w, obj2gco(p->upvalues[i]));
+}
+
+static void snapobj(SnapshotWriter *w, global_State *g, GCObject *o) {
+    switch (o->gch.tt) {
+        case LUA_TSTRING: {
+            TString *ts = gco2ts(o);
+            snapheader(w, o, sizestring(ts->len), 0);
+            snapdata(w, ts->data, ts->len);
+            break;
+        }
+
+        case LUA_TTABLE:
+            snaptable(w, g, gco2h(o));
+            break;
+
+        case LUA_TFUNCTION:
+            snapclosure(w, gco2cl(o));
+            break;
+
+        case LUA_TUSERDATA: {
+            Udata *u = gco2u(o);
+            snapheader(w, o, sizeudata(u->len), 0);
+            snapbyte(w, u->tag);
+
+            if (u->metatable)
+                snapref(w, obj2gco(u->metatable));
+            break;
+        }
+
+        case LUA_TTHREAD: {
+            lua_State *th = gco2th(o);
+            snapheader(w, o, threadsize(th), 0);
+            snapref(w, obj2gco(th->gt));
+            snaprefs(w, th->stack, th->top - th->stack);
+            break;
+        }
+
+        case LUA_TPROTO:
+            snapproto(w, gco2p(o));
+            break;
+
+        case LUA_TUPVAL: {
+            UpVal *uv = gco2uv(o);
+            snapheader(w, o, sizeof(UpVal), 0);
+
+            if (iscollectable(uv->v))
+                snapref(w, gcvalue(uv->v));
+            break;
+        }
+
+        default:
+            LUAU_ASSERT(0);
+    }
+
+    snapvarint(w, 0);
+}
+
+struct SnapshotContext {
+    SnapshotWriter *writer;
+    global_State *g;
+};
+
+static bool snapgco(void *context, lua_Page *page, GCObject *gco) {
+    SnapshotContext *ctx = (SnapshotContext *) context;
+
+    // objects that are waiting to be swept are already unreachable
+    if (!isdead(ctx->g, gco))
+        snapobj(ctx->writer, ctx->g, gco);
+
+    return false;
+}
+
+void luaC_snapshot(lua_State *L, void (*write)(void *context, const void *data, size_t size), void *context) {
+    global_State *g = L->global;
+
+    SnapshotWriter w;
+    w.write = write;
+    w.context = context;
+    w.base = 0;
+    w.last = 0;
+    w.size = 0;
+
+    const char magic[] = "SHSN";
+    for (int i = 0; i < 4; ++i)
+        snapbyte(&w, uint8_t(magic[i]));
+
+    snapbyte(&w, SNAPSHOT_VERSION);
+    snapvarint(&w, g->totalbytes);
+
+    int categories = 0;
+    for (int i = 0; i < LUA_MEMORY_CATEGORIES; i++)
+        if (g->memcatinfo && g->memcatinfo[i].name)
+            categories++;
+
+    snapvarint(&w, categories);
+
+    for (int i = 0; i < LUA_MEMORY_CATEGORIES; i++) {
+        if (TString *name = g->memcatinfo ? g->memcatinfo[i].name : NULL) {
+            snapbyte(&w, uint8_t(i));
+            snapvarint(&w, name->len);
+
+            for (unsigned j = 0; j < name->len; ++j)
+                snapbyte(&w, uint8_t(name->data[j]));
+        }
+    }
+
+    int roots = 2;
+    for (int i = 0; i < LUA_T_COUNT; i++)
+        if (g->mt[i])
+            roots++;
+
+    snapvarint(&w, roots);
+    snapref(&w, obj2gco(g->mainthread));
+    snapref(&w, gcvalue(&g->registry));
+
+    for (int i = 0; i < LUA_T_COUNT; i++)
+        if (g->mt[i])
+            snapref(&w, obj2gco(g->mt[i]));
+
+    SnapshotContext ctx = {&w, g};
+
+    // the main thread isn't allocated from the pages that luaM_visitgco walks
+    snapobj(&w, g, obj2gco(g->mainthread));
+    luaM_visitgco(L, &ctx, snapgco);
+
+    snapbyte(&w, 255);
+    snapflush(&w);
+}
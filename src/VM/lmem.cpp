@@ -3,6 +3,8 @@
 #include "lmem.h"
 
 #include "lstate.h"
+#include "lstring.h"
+#include "lgc.h"
 #include "ldo.h"
 #include "ldebug.h"
 
@@ -42,7 +44,9 @@
  * impossible to free it in isolation - GCO blocks are freed by sweeping the pages they belong to,
  * using luaM_freegco which must specify the page; this is called by page sweeper that traverses the
  * entire page's worth of objects. For this reason it's also important that freed GCO blocks keep the
- * GC header intact and accessible (with type = NIL) so that the sweeper can access it.
+ * GC header intact and accessible (with type = NIL) so that the sweeper can access it. The only exception
+ * is the generational mode of the GC, which logs the page of each new GCO so that minor collections can
+ * free young objects without sweeping the pages (global_State::young).
  *
  * Some GCOs are too large to fit in a 16K page without excessive fragmentation (the size threshold is
  * currently 512 bytes); in this case, we allocate a dedicated small page with just a single block's worth
@@ -76,6 +80,11 @@
  * the contents of the page, and the free list for further reuse; this allows shorter page setup times
  * which results in less variance between allocation cost, as well as tighter sweep bounds for newly
  * allocated pages.
+ *
+ * Every allocation is attributed to a memory category (global_State::memcatbytes); GCOs remember their
+ * category in the GC header, other allocations use the category of the object that owns them. Peaks,
+ * allocation totals and limits of the categories are only tracked after luaM_trackmemcats is called,
+ * which costs a branch per allocation until then.
  */
 
 #ifndef __has_feature
@@ -327,7 +336,7 @@ static void *newblock(lua_State *L, int sizeClass) {
     return (char *) block + kBlockHeader;
 }
 
-static void *newgcoblock(lua_State *L, int sizeClass) {
+static void *newgcoblock(lua_State *L, int sizeClass, lua_Page **pageout) {
     global_State *g = L->global;
     lua_Page *page = g->freegcopages[sizeClass];
 
@@ -364,6 +373,7 @@ static void *newgcoblock(lua_State *L, int sizeClass) {
         page->next = NULL;
     }
 
+    *pageout = page;
     return block;
 }
 
@@ -434,9 +444,29 @@ static void freegcoblock(lua_State *L, int sizeClass, void *block, lua_Page *pag
         freeclasspage(L, g->freegcopages, &g->allgcopages, page, sizeClass);
 }
 
+static void checkmemcat(lua_State *L, uint8_t memcat, size_t nsize) {
+    global_State *g = L->global;
+    size_t hardlimit = g->memcatinfo[memcat].hardlimit;
+
+    if (hardlimit && g->memcatbytes[memcat] + nsize > hardlimit)
+        luaD_throw(L, LUA_ERRMEM);
+}
+
+static void trackmemcat(global_State *g, uint8_t memcat, size_t nsize) {
+    MemCatInfo &info = g->memcatinfo[memcat];
+
+    info.allocatedbytes += nsize;
+
+    if (g->memcatbytes[memcat] > info.peakbytes)
+        info.peakbytes = g->memcatbytes[memcat];
+}
+
 void *luaM_new_(lua_State *L, size_t nsize, uint8_t memcat) {
     global_State *g = L->global;
 
+    if (g->memcatinfo)
+        checkmemcat(L, memcat, nsize);
+
     int nclass = sizeclass(nsize);
 
     void *block = nclass >= 0 ? newblock(L, nclass) : (*g->frealloc)(g->ud, NULL, 0, nsize);
@@ -446,6 +476,9 @@ void *luaM_new_(lua_State *L, size_t nsize, uint8_t memcat) {
     g->totalbytes += nsize;
     g->memcatbytes[memcat] += nsize;
 
+    if (g->memcatinfo)
+        trackmemcat(g, memcat, nsize);
+
     return block;
 }
 
@@ -455,14 +488,26 @@ GCObject *luaM_newgco_(lua_State *L, size_t nsize, uint8_t memcat) {
 
     global_State *g = L->global;
 
+    if (g->memcatinfo)
+        checkmemcat(L, memcat, nsize);
+
+    // in the generational mode new objects are logged for the next minor collection; the log grows first so that
+    // a failure can't leave an uninitialized block in the page
+    if (g->gckind == KGC_GEN && g->nyoung == g->sizeyoung) {
+        int size = g->sizeyoung ? g->sizeyoung * 2 : 64;
+        luaM_reallocarray(L, g->young, g->sizeyoung, size, GCYoung, 0);
+        g->sizeyoung = size;
+    }
+
     int nclass = sizeclass(nsize);
 
     void *block = NULL;
+    lua_Page *page = NULL;
 
     if (nclass >= 0) {
-        block = newgcoblock(L, nclass);
+        block = newgcoblock(L, nclass, &page);
     } else {
-        lua_Page *page = newpage(L, &g->allgcopages, offsetof(lua_Page, data) + int(nsize), int(nsize), 1);
+        page = newpage(L, &g->allgcopages, offsetof(lua_Page, data) + int(nsize), int(nsize), 1);
 
         block = &page->data;
         ASAN_UNPOISON_MEMORY_REGION(block, page->blockSize);
@@ -474,9 +519,21 @@ GCObject *luaM_newgco_(lua_State *L, size_t nsize, uint8_t memcat) {
     if (block == NULL && nsize > 0)
         luaD_throw(L, LUA_ERRMEM);
 
+    if (g->gckind == KGC_GEN) {
+        g->young[g->nyoung].o = (GCObject *) block;
+        g->young[g->nyoung].page = page;
+        g->nyoung++;
+    }
+
+    // the object is freed with the category in its header
+    ((GCObject *) block)->gch.memcat = memcat;
+
     g->totalbytes += nsize;
     g->memcatbytes[memcat] += nsize;
 
+    if (g->memcatinfo)
+        trackmemcat(g, memcat, nsize);
+
     return (GCObject *) block;
 }
 
@@ -521,6 +578,9 @@ void *luaM_realloc_(lua_State *L, void *block, size_t osize, size_t nsize, uint8
     global_State *g = L->global;
     LUAU_ASSERT((osize == 0) == (block == NULL));
 
+    if (g->memcatinfo && nsize > osize)
+        checkmemcat(L, memcat, nsize - osize);
+
     int nclass = sizeclass(nsize);
     int oclass = sizeclass(osize);
     void *result;
@@ -547,9 +607,72 @@ void *luaM_realloc_(lua_State *L, void *block, size_t osize, size_t nsize, uint8
     LUAU_ASSERT((nsize == 0) == (result == NULL));
     g->totalbytes = (g->totalbytes - osize) + nsize;
     g->memcatbytes[memcat] += nsize - osize;
+
+    if (g->memcatinfo && nsize > osize)
+        trackmemcat(g, memcat, nsize - osize);
+
     return result;
 }
 
+// attributes memory that is handed over to another owner without reallocating it to a different category
+void luaM_movememcat(lua_State *L, size_t size, uint8_t from, uint8_t to) {
+    global_State *g = L->global;
+
+    if (from == to)
+        return;
+
+    if (g->memcatinfo)
+        checkmemcat(L, to, size);
+
+    g->memcatbytes[from] -= size;
+    g->memcatbytes[to] += size;
+
+    if (g->memcatinfo)
+        trackmemcat(g, to, size);
+}
+
+void luaM_trackmemcats(lua_State *L) {
+    global_State *g = L->global;
+
+    if (g->memcatinfo)
+        return;
+
+    MemCatInfo *info = luaM_newarray(L, LUA_MEMORY_CATEGORIES, MemCatInfo, 0);
+
+    for (int i = 0; i < LUA_MEMORY_CATEGORIES; i++) {
+        info[i].name = NULL;
+        info[i].peakbytes = g->memcatbytes[i];
+        info[i].allocatedbytes = 0;
+        info[i].softlimit = 0;
+        info[i].hardlimit = 0;
+    }
+
+    g->memcatinfo = info;
+}
+
+/*
+ * Module categories are taken from the top of the range, so that they don't collide with the small
+ * categories that hosts usually pick for lua_setmemcat; all chunks loaded into the state share them.
+ */
+uint8_t luaM_getmemcat(lua_State *L, TString *name) {
+    luaM_trackmemcats(L);
+
+    MemCatInfo *info = L->global->memcatinfo;
+
+    for (int i = LUA_MEMORY_CATEGORIES - 1; i > 0; i--) {
+        if (info[i].name == name)
+            return uint8_t(i);
+
+        if (!info[i].name) {
+            luaS_fix(name); /* names are reported for as long as the state lives */
+            info[i].name = name;
+            return uint8_t(i);
+        }
+    }
+
+    return 0; /* out of categories */
+}
+
 void luaM_getpagewalkinfo(lua_Page *page, char **start, char **end, int *busyBlocks, int *blockSize) {
     int blockCount = (page->pageSize - offsetof(lua_Page, data)) / page->blockSize;
 
@@ -6,6 +6,7 @@
 
 struct lua_Page;
 union GCObject;
+struct TString;
 
 #define luaM_newgco(L, t, size, memcat) cast_to(t*, luaM_newgco_(L, size, memcat))
 #define luaM_freegco(L, p, size, memcat, page) luaM_freegco_(L, obj2gco(p), size, memcat, page)
@@ -29,6 +30,12 @@ LUAI_FUNC void *luaM_realloc_(lua_State *L, void *block, size_t osize, size_t ns
 
 LUAI_FUNC l_noret luaM_toobig(lua_State *L);
 
+LUAI_FUNC void luaM_movememcat(lua_State *L, size_t size, uint8_t from, uint8_t to);
+
+LUAI_FUNC void luaM_trackmemcats(lua_State *L);
+
+LUAI_FUNC uint8_t luaM_getmemcat(lua_State *L, TString *name);
+
 LUAI_FUNC void luaM_getpagewalkinfo(lua_Page *page, char **start, char **end, int *busyBlocks, int *blockSize);
 
 LUAI_FUNC lua_Page *luaM_getnextgcopage(lua_Page *page);
@@ -263,7 +263,8 @@ typedef struct Proto {
 
 
     TValue *k;              /* constants used by the function */
-    Instruction *code;      /* function bytecode */
+    Instruction *code;      /* function bytecode; points into the bytecode image when codeinplace is set */
+    uint8_t *cache;         /* inline caches of instructions with constant keys; C of these instructions is the cache index */
     struct Proto **p;       /* functions defined inside the function */
     uint8_t *lineinfo;      /* for each instruction, line number as a delta from baseline */
     int *abslineinfo;       /* baseline line info, one entry for each 1<<linegaplog2 instructions; allocated after lineinfo */
@@ -276,8 +277,14 @@ typedef struct Proto {
 
     GCObject *gclist;
 
+    struct LazyChunk *lazy; /* chunk to decode code, constants and debug info from on first call, see luau_loadlazy */
+    uint32_t lazyoffset;    /* offset of the encoded code in the chunk */
+
+    uint32_t bytecodehash; /* hash of the bytecode image the function was loaded from, see # Debug info sidecar in Bytecode.h */
+    int bytecodeid;        /* index of the function in the bytecode image */
 
     int sizecode;
+    int sizecache;
     int sizep;
     int sizelocvars;
     int sizeupvalues;
@@ -291,6 +298,8 @@ typedef struct Proto {
     uint8_t numparams;
     uint8_t is_vararg;
     uint8_t maxstacksize;
+    uint8_t codeinplace; /* code is executed in place from read-only memory and can't be patched */
+    uint8_t modulememcat; /* memory category of the module that defines the function, see luaE_memcat */
 } Proto;
 // clang-format on
 
@@ -301,6 +310,22 @@ typedef struct LocVar {
     uint8_t reg; /* register slot, relative to base, where variable is stored */
 } LocVar;
 
+/*
+** Bytecode chunks loaded with luau_loadlazy; the image is kept until every proto in it has been decoded or freed
+*/
+typedef struct LazyChunk {
+    const char *data;
+    size_t size;
+
+    struct Table *strings; /* strings of the chunk; string id i is at array index i-1 */
+    struct Table *env;
+
+    struct Proto **protos;
+    unsigned int protocount;
+
+    unsigned int pending; /* number of protos that haven't been decoded yet */
+} LazyChunk;
+
 /*
 ** Upvalues
 */
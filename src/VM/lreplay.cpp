@@ -0,0 +1,250 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#include "lstate.h"
+#include "ldebug.h"
+
+#include <math.h>
+#include <string.h>
+
+/*
+ * Replay log format
+ *
+ * The log starts with a 5-byte header ("SRPL" followed by the format version) and is followed by a stream of records.
+ * Every record starts with a tag byte; numbers are stored in the smallest encoding that round-trips exactly so that
+ * typical sensor reads (integer encoder ticks, port states) take 2-3 bytes instead of 9.
+ *
+ * When recording, records are written into a ring buffer owned by the host; head is only advanced by the VM and tail is
+ * only advanced by lua_replaydrain, so the drain can run on a separate low priority task (e.g. writing to the SD card)
+ * without blocking the control loop. Records that don't fit are dropped and accounted for in lua_replaydropped; a log with
+ * dropped records will desynchronize on replay which is reported as an error.
+ */
+
+#define REPLAY_VERSION 1
+
+static const char kReplayMagic[4] = {'S', 'R', 'P', 'L'};
+
+enum ReplayTag {
+    RTAG_TICK,
+    RTAG_FALSE,
+    RTAG_TRUE,
+    RTAG_INT8,
+    RTAG_INT16,
+    RTAG_INT32,
+    RTAG_FLOAT,
+    RTAG_DOUBLE,
+};
+
+static void writerecord(global_State *g, uint8_t tag, const void *payload, size_t size) {
+    ReplayState &r = g->replay;
+
+    size_t head = r.head.load(std::memory_order_relaxed);
+    size_t tail = r.tail.load(std::memory_order_acquire);
+
+    if (r.size - (head - tail) < size + 1) {
+        r.dropped += size + 1;
+        return;
+    }
+
+    size_t mask = r.size - 1;
+    r.data[head & mask] = tag;
+
+    for (size_t i = 0; i < size; ++i)
+        r.data[(head + 1 + i) & mask] = static_cast<const uint8_t *>(payload)[i];
+
+    r.head.store(head + 1 + size, std::memory_order_release);
+}
+
+static size_t payloadsize(uint8_t tag) {
+    switch (tag) {
+        case RTAG_INT8:
+            return 1;
+        case RTAG_INT16:
+            return 2;
+        case RTAG_INT32:
+        case RTAG_FLOAT:
+            return 4;
+        case RTAG_DOUBLE:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+// reads the next record which must have a tag in [first, last]; anything else means the script diverged from the recording
+static const uint8_t *readrecord(lua_State *L, uint8_t first, uint8_t last) {
+    ReplayState &r = L->global->replay;
+
+    size_t head = r.head.load(std::memory_order_relaxed);
+
+    if (head >= r.size)
+        luaG_runerror(L, "replay log exhausted after %u iterations", r.ticks);
+
+    uint8_t tag = r.data[head];
+
+    if (tag < first || tag > last)
+        luaG_runerror(L, "replay log desynchronized at iteration %u (offset %d)", r.ticks, int(head));
+
+    size_t next = head + 1 + payloadsize(tag);
+
+    if (next > r.size)
+        luaG_runerror(L, "replay log truncated at iteration %u", r.ticks);
+
+    r.head.store(next, std::memory_order_relaxed);
+    return r.data + head;
+}
+
+void lua_replayrecord(lua_State *L, void *buffer, size_t size) {
+    api_check(L, size >= 16 && (size & (size - 1)) == 0);
+    ReplayState &r = L->global->replay;
+
+    r.mode = LUA_REPLAYRECORD;
+    r.data = static_cast<uint8_t *>(buffer);
+    r.size = size;
+    r.head = 0;
+    r.tail = 0;
+    r.dropped = 0;
+    r.ticks = 0;
+
+    memcpy(r.data, kReplayMagic, sizeof(kReplayMagic));
+    r.data[sizeof(kReplayMagic)] = REPLAY_VERSION;
+    r.head.store(sizeof(kReplayMagic) + 1, std::memory_order_release);
+}
+
+int lua_replayplay(lua_State *L, const void *log, size_t size) {
+    const uint8_t *data = static_cast<const uint8_t *>(log);
+
+    if (size < sizeof(kReplayMagic) + 1 || memcmp(data, kReplayMagic, sizeof(kReplayMagic)) != 0 ||
+        data[sizeof(kReplayMagic)] != REPLAY_VERSION)
+        return 0;
+
+    ReplayState &r = L->global->replay;
+
+    r.mode = LUA_REPLAYPLAY;
+    r.data = const_cast<uint8_t *>(data) + sizeof(kReplayMagic) + 1;
+    r.size = size - sizeof(kReplayMagic) - 1;
+    r.head = 0;
+    r.tail = 0;
+    r.dropped = 0;
+    r.ticks = 0;
+    return 1;
+}
+
+void lua_replaystop(lua_State *L) {
+    L->global->replay.mode = LUA_REPLAYOFF;
+}
+
+int lua_replaymode(lua_State *L) {
+    return L->global->replay.mode;
+}
+
+size_t lua_replaydrain(lua_State *L, void (*write)(void *context, const void *data, size_t size), void *context) {
+    ReplayState &r = L->global->replay;
+
+    if (r.mode != LUA_REPLAYRECORD)
+        return 0;
+
+    size_t tail = r.tail.load(std::memory_order_relaxed);
+    size_t head = r.head.load(std::memory_order_acquire);
+    size_t mask = r.size - 1;
+
+    if (head == tail)
+        return 0;
+
+    // the pending range may wrap around the end of the ring buffer
+    size_t start = tail & mask;
+    size_t count = head - tail;
+    size_t first = count < r.size - start ? count : r.size - start;
+
+    write(context, r.data + start, first);
+    if (first < count)
+        write(context, r.data, count - first);
+
+    r.tail.store(head, std::memory_order_release);
+    return count;
+}
+
+size_t lua_replaydropped(lua_State *L) {
+    return L->global->replay.dropped;
+}
+
+double lua_replaynumber(lua_State *L, double value) {
+    global_State *g = L->global;
+
+    if (LUAU_LIKELY(g->replay.mode == LUA_REPLAYOFF))
+        return value;
+
+    if (g->replay.mode == LUA_REPLAYRECORD) {
+        // -0.0 compares equal to 0 but would be replayed as +0.0 from the integer encodings, so it's stored as a float
+        bool integer = value != 0 || !signbit(value);
+
+        if (integer && value >= -128 && value <= 127 && double(int8_t(value)) == value) {
+            int8_t v = int8_t(value);
+            writerecord(g, RTAG_INT8, &v, sizeof(v));
+        } else if (integer && value >= -32768 && value <= 32767 && double(int16_t(value)) == value) {
+            int16_t v = int16_t(value);
+            writerecord(g, RTAG_INT16, &v, sizeof(v));
+        } else if (integer && value >= -2147483648.0 && value <= 2147483647.0 && double(int32_t(value)) == value) {
+            int32_t v = int32_t(value);
+            writerecord(g, RTAG_INT32, &v, sizeof(v));
+        } else if (double(float(value)) == value) {
+            float v = float(value);
+            writerecord(g, RTAG_FLOAT, &v, sizeof(v));
+        } else {
+            writerecord(g, RTAG_DOUBLE, &value, sizeof(value));
+        }
+
+        return value;
+    }
+
+    const uint8_t *rec = readrecord(L, RTAG_INT8, RTAG_DOUBLE);
+
+    switch (rec[0]) {
+        case RTAG_INT8:
+            return double(int8_t(rec[1]));
+        case RTAG_INT16: {
+            int16_t v;
+            memcpy(&v, rec + 1, sizeof(v));
+            return double(v);
+        }
+        case RTAG_INT32: {
+            int32_t v;
+            memcpy(&v, rec + 1, sizeof(v));
+            return double(v);
+        }
+        case RTAG_FLOAT: {
+            float v;
+            memcpy(&v, rec + 1, sizeof(v));
+            return double(v);
+        }
+        default: {
+            double v;
+            memcpy(&v, rec + 1, sizeof(v));
+            return v;
+        }
+    }
+}
+
+int lua_replayboolean(lua_State *L, int value) {
+    global_State *g = L->global;
+
+    if (LUAU_LIKELY(g->replay.mode == LUA_REPLAYOFF))
+        return value;
+
+    if (g->replay.mode == LUA_REPLAYRECORD) {
+        writerecord(g, value ? RTAG_TRUE : RTAG_FALSE, NULL, 0);
+        return value;
+    }
+
+    return readrecord(L, RTAG_FALSE, RTAG_TRUE)[0] == RTAG_TRUE;
+}
+
+unsigned lua_replaytick(lua_State *L) {
+    global_State *g = L->global;
+
+    if (g->replay.mode == LUA_REPLAYRECORD)
+        writerecord(g, RTAG_TICK, NULL, 0);
+    else if (g->replay.mode == LUA_REPLAYPLAY)
+        readrecord(L, RTAG_TICK, RTAG_TICK);
+
+    return g->replay.ticks++;
+}
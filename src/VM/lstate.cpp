@@ -18,17 +18,11 @@ typedef struct LG {
     global_State g;
 } LG;
 
-static void stack_init(lua_State *L1, lua_State *L) {
-    /* initialize CallInfo array */
-    L1->base_ci = luaM_newarray(L, BASIC_CI_SIZE, CallInfo, L1->memcat);
+static void stack_clear(lua_State *L1) {
     L1->ci = L1->base_ci;
-    L1->size_ci = BASIC_CI_SIZE;
     L1->end_ci = L1->base_ci + L1->size_ci - 1;
-    /* initialize stack array */
-    L1->stack = luaM_newarray(L, BASIC_STACK_SIZE + EXTRA_STACK, TValue, L1->memcat);
-    L1->stacksize = BASIC_STACK_SIZE + EXTRA_STACK;
     TValue *stack = L1->stack;
-    for (int i = 0; i < BASIC_STACK_SIZE + EXTRA_STACK; i++)
+    for (int i = 0; i < L1->stacksize; i++)
         setnilvalue(stack + i); /* erase new stack */
     L1->top = stack;
     L1->stack_last = stack + (L1->stacksize - EXTRA_STACK);
@@ -39,11 +33,79 @@ static void stack_init(lua_State *L1, lua_State *L) {
     L1->ci->top = L1->top + LUA_MINSTACK;
 }
 
+static void stack_init(lua_State *L1, lua_State *L) {
+    /* initialize CallInfo array */
+    L1->base_ci = luaM_newarray(L, BASIC_CI_SIZE, CallInfo, L1->memcat);
+    L1->size_ci = BASIC_CI_SIZE;
+    /* initialize stack array */
+    L1->stack = luaM_newarray(L, BASIC_STACK_SIZE + EXTRA_STACK, TValue, L1->memcat);
+    L1->stacksize = BASIC_STACK_SIZE + EXTRA_STACK;
+    stack_clear(L1);
+}
+
 static void freestack(lua_State *L, lua_State *L1) {
     luaM_freearray(L, L1->base_ci, L1->size_ci, CallInfo, L1->memcat);
     luaM_freearray(L, L1->stack, L1->stacksize, TValue, L1->memcat);
 }
 
+/*
+** Thread pool: stacks of collected threads are kept for new threads, see lua_setthreadpool
+*/
+static bool stack_keep(ThreadPool &pool, lua_State *L1) {
+    /* the CallInfo array is allowed to grow as much as the stack */
+    return pool.size > 0 && L1->stacksize <= pool.stacksize + EXTRA_STACK &&
+           L1->size_ci <= BASIC_CI_SIZE * pool.stacksize / BASIC_STACK_SIZE;
+}
+
+static bool stack_pool(lua_State *L, lua_State *L1) {
+    ThreadPool &pool = L->global->threadpool;
+    if (L1->stack == NULL) /* stack allocation of the thread failed */
+        return false;
+    if (pool.count >= pool.size || !stack_keep(pool, L1)) {
+        if (pool.size > 0)
+            pool.stats.dropped++;
+        return false;
+    }
+    ThreadStack &ts = pool.stacks[pool.count++];
+    ts.stack = L1->stack;
+    ts.ci = L1->base_ci;
+    ts.stacksize = L1->stacksize;
+    ts.size_ci = L1->size_ci;
+    ts.memcat = L1->memcat;
+    return true;
+}
+
+static bool stack_reuse(lua_State *L1, lua_State *L) {
+    ThreadPool &pool = L->global->threadpool;
+    if (pool.count == 0)
+        return false;
+    /* the most recently collected stack is the most likely to be in the cache */
+    ThreadStack &ts = pool.stacks[pool.count - 1];
+    luaM_movememcat(L, ts.stacksize * sizeof(TValue) + ts.size_ci * sizeof(CallInfo), ts.memcat, L1->memcat);
+    pool.count--;
+    L1->stack = ts.stack;
+    L1->stacksize = ts.stacksize;
+    L1->base_ci = ts.ci;
+    L1->size_ci = ts.size_ci;
+    stack_clear(L1);
+    return true;
+}
+
+static void stack_trim(lua_State *L, int size, int stacksize) {
+    ThreadPool &pool = L->global->threadpool;
+    int count = 0;
+    for (int i = 0; i < pool.count; i++) {
+        ThreadStack &ts = pool.stacks[i];
+        if (count < size && ts.stacksize <= stacksize + EXTRA_STACK && ts.size_ci <= BASIC_CI_SIZE * stacksize / BASIC_STACK_SIZE) {
+            pool.stacks[count++] = ts;
+        } else {
+            luaM_freearray(L, ts.ci, ts.size_ci, CallInfo, ts.memcat);
+            luaM_freearray(L, ts.stack, ts.stacksize, TValue, ts.memcat);
+        }
+    }
+    pool.count = count;
+}
+
 /*
 ** open parts that may cause memory-allocation errors
 */
@@ -81,9 +143,15 @@ static void close_state(lua_State *L) {
     global_State *g = L->global;
     luaF_close(L, L->stack); /* close all upvalues for this thread */
     luaC_freeall(L);         /* collect all objects */
+    stack_trim(L, 0, 0);     /* free the stacks of collected threads */
+    for (PatternCacheEntry &e : g->patterncache.entries) /* free the compiled patterns */
+        if (e.data)
+            luaM_free_(L, e.data, e.size, 0);
     LUAU_ASSERT(g->strbufgc == NULL);
     LUAU_ASSERT(g->strt.nuse == 0);
     luaM_freearray(L, L->global->strt.hash, L->global->strt.size, TString*, 0);
+    luaM_freearray(L, g->young, g->sizeyoung, GCYoung, 0);
+    luaM_freearray(L, g->memcatinfo, g->memcatinfo ? LUA_MEMORY_CATEGORIES : 0, MemCatInfo, 0);
     freestack(L, L);
     for (int i = 0; i < LUA_SIZECLASSES; i++) {
         LUAU_ASSERT(g->freepages[i] == NULL);
@@ -98,24 +166,46 @@ static void close_state(lua_State *L) {
 }
 
 lua_State *luaE_newthread(lua_State *L) {
-    lua_State *L1 = luaM_newgco(L, lua_State, sizeof(lua_State), L->activememcat);
+    lua_State *L1 = luaM_newgco(L, lua_State, sizeof(lua_State), luaE_memcat(L));
     luaC_init(L, L1, LUA_TTHREAD);
     preinit_state(L1, L->global);
     L1->activememcat = L->activememcat; // inherit the active memory category
-    stack_init(L1, L);                  /* init stack */
+    if (stack_reuse(L1, L))             /* init stack */
+        L->global->threadpool.stats.reused++;
+    else {
+        stack_init(L1, L);
+        L->global->threadpool.stats.created++;
+    }
     L1->gt = L->gt;                     /* share table of globals */
     L1->singlestep = L->singlestep;
     LUAU_ASSERT(iswhite(obj2gco(L1)));
     return L1;
 }
 
+/*
+** memory category of new GC objects: the active category of the thread, unless it's 0 and the running function (or the
+** nearest function below a library function) belongs to a module with a category, see # Memory categories in Bytecode.h
+*/
+uint8_t luaE_memcat(lua_State *L) {
+    // module categories are only assigned after luaM_trackmemcats
+    if (L->activememcat != 0 || !L->global->memcatinfo)
+        return L->activememcat;
+
+    for (CallInfo *ci = L->ci; ci > L->base_ci; ci--)
+        if (isLua(ci))
+            return ci_func(ci)->l.p->modulememcat;
+
+    return 0;
+}
+
 void luaE_freethread(lua_State *L, lua_State *L1, lua_Page *page) {
     luaF_close(L1, L1->stack); /* close all upvalues for this thread */
     LUAU_ASSERT(L1->openupval == NULL);
     global_State *g = L->global;
     if (g->cb.userthread)
         g->cb.userthread(NULL, L1);
-    freestack(L, L1);
+    if (!stack_pool(L, L1))
+        freestack(L, L1);
     luaM_freegco(L, L1, sizeof(lua_State), L1->memcat, page);
 }
 
@@ -129,7 +219,9 @@ void lua_resetthread(lua_State *L) {
     ci->top = ci->base + LUA_MINSTACK;
     setnilvalue(ci->func);
     L->ci = ci;
-    if (L->size_ci != BASIC_CI_SIZE)
+    /* a grown stack is kept for the next run of the thread if the thread pool would keep it */
+    bool keep = stack_keep(L->global->threadpool, L);
+    if (L->size_ci != BASIC_CI_SIZE && !keep)
         luaD_reallocCI(L, BASIC_CI_SIZE);
     /* clear thread state */
     L->status = LUA_OK;
@@ -137,7 +229,7 @@ void lua_resetthread(lua_State *L) {
     L->top = L->ci->base;
     L->nCcalls = L->baseCcalls = 0;
     /* clear thread stack */
-    if (L->stacksize != BASIC_STACK_SIZE + EXTRA_STACK)
+    if (L->stacksize != BASIC_STACK_SIZE + EXTRA_STACK && !keep)
         luaD_reallocstack(L, BASIC_STACK_SIZE);
     for (int i = 0; i < L->stacksize; i++)
         setnilvalue(L->stack + i);
@@ -147,6 +239,24 @@ int lua_isthreadreset(lua_State *L) {
     return L->ci == L->base_ci && L->base == L->top && L->status == LUA_OK;
 }
 
+void lua_setthreadpool(lua_State *L, int size, int stacksize) {
+    ThreadPool &pool = L->global->threadpool;
+    size = size < 0 ? 0 : size > LUAI_MAXTHREADPOOL ? LUAI_MAXTHREADPOOL : size;
+    stacksize = stacksize < BASIC_STACK_SIZE ? BASIC_STACK_SIZE : stacksize;
+    stack_trim(L, size, stacksize);
+    pool.size = size;
+    pool.stacksize = stacksize;
+}
+
+void lua_getthreadpoolstats(lua_State *L, lua_ThreadPoolStats *stats) {
+    const ThreadPool &pool = L->global->threadpool;
+    *stats = pool.stats;
+    stats->pooled = pool.count;
+    stats->bytes = 0;
+    for (int i = 0; i < pool.count; i++)
+        stats->bytes += pool.stacks[i].stacksize * sizeof(TValue) + pool.stacks[i].size_ci * sizeof(CallInfo);
+}
+
 lua_State *lua_newstate(lua_Alloc f, void *ud) {
     int i;
     lua_State *L;
@@ -179,14 +289,21 @@ lua_State *lua_newstate(lua_Alloc f, void *ud) {
     setnilvalue(&g->pseudotemp);
     setnilvalue(registry(L));
     g->gcstate = GCSpause;
+    g->gckind = KGC_INC;
     g->gray = NULL;
     g->grayagain = NULL;
     g->weak = NULL;
     g->strbufgc = NULL;
+    g->young = NULL;
+    g->nyoung = 0;
+    g->sizeyoung = 0;
     g->totalbytes = sizeof(LG);
     g->gcgoal = LUAI_GCGOAL;
     g->gcstepmul = LUAI_GCSTEPMUL;
     g->gcstepsize = LUAI_GCSTEPSIZE << 10;
+    g->gcgenminormul = LUAI_GCGENMINORMUL;
+    g->scratchdepth = 0;
+    g->scratchthreshold = 0;
     for (i = 0; i < LUA_SIZECLASSES; i++) {
         g->freepages[i] = NULL;
         g->freegcopages[i] = NULL;
@@ -201,9 +318,36 @@ lua_State *lua_newstate(lua_Alloc f, void *ud) {
         g->memcatbytes[i] = 0;
 
     g->memcatbytes[0] = sizeof(LG);
+    g->memcatinfo = NULL;
 
     g->cb = lua_Callbacks();
     g->gcstats = GCStats();
+    g->stepmetrics = GCStepMetrics();
+    g->gcpace = GCPaceState();
+    g->threadpool = ThreadPool();
+    g->patterncache = PatternCache();
+
+    g->replay.mode = LUA_REPLAYOFF;
+    g->replay.data = NULL;
+    g->replay.size = 0;
+    g->replay.head = 0;
+    g->replay.tail = 0;
+    g->replay.dropped = 0;
+    g->replay.ticks = 0;
+
+    g->watchdog.safepoints = 0;
+    g->watchdog.timeout = 0;
+    g->watchdog.chained = NULL;
+    g->watchdog.depth = 0;
+    g->watchdog.remaining = 0;
+    g->watchdog.starttime = 0;
+    g->watchdog.overrun = false;
+    g->watchdog.active = false;
+    g->watchdog.run = 0;
+    g->watchdog.deadline = 0;
+    g->watchdog.expired = 0;
+    g->watchdog.stats = lua_BudgetStats();
+    g->loadstats = lua_LoadStats();
 
 #ifdef LUAI_GCMETRICS
     g->gcmetrics = GCMetrics();
@@ -5,6 +5,8 @@
 #include "lobject.h"
 #include "ltm.h"
 
+#include <atomic>
+
 /* registry */
 #define registry(L) (&L->global->registry)
 
@@ -15,6 +17,10 @@
 
 #define BASIC_STACK_SIZE (2 * LUA_MINSTACK)
 
+/* default settings of the thread pool (settable via lua_setthreadpool) */
+#define LUAI_THREADPOOL 16                      /* stacks kept for new threads */
+#define LUAI_THREADPOOLSTACK (4 * LUA_MINSTACK) /* largest stack that is kept, which allows one doubling of the basic stack */
+
 // clang-format off
 typedef struct stringtable {
 
@@ -88,6 +94,123 @@ struct GCStats {
     double endtimestamp = 0;
 };
 
+// log-linear histogram with a precision of 25%: values below 8 have a bucket each, larger values 4 buckets per power of two
+#define GC_HISTOGRAM_BUCKETS 92
+
+struct GCHistogram {
+    uint32_t counts[GC_HISTOGRAM_BUCKETS] = {0};
+    uint32_t count = 0;
+    uint32_t max = 0;
+    uint64_t total = 0;
+};
+
+// unlike GCMetrics these are always collected, see lua_gcmetrics
+struct GCStepMetrics {
+    GCHistogram phases[LUA_GCPHASE_COUNT]; // step times in microseconds
+    GCHistogram assiststeps;
+    GCHistogram explicitsteps;
+    GCHistogram heapgoal; // heap size at the start of the atomic phase, in percent of the goal
+
+    uint64_t assistwork = 0;
+    uint64_t explicitwork = 0;
+    uint32_t cycles = 0;
+};
+
+// pacing of the collector to a fixed loop period, see lua_gcpace
+struct GCPaceState {
+    double period = 0; // 0 if pacing is off
+    double budget = 0;
+    double tickend = 0; // scheduled end of the current tick, 0 before the first lua_gctick
+
+    size_t threshold = 0; // GCthreshold that the collector asked for
+    size_t applied = 0;   // GCthreshold set by the last tick, which is raised to the limit of assists
+
+    size_t lastbytes = 0; // totalbytes at the end of the last tick
+    size_t tickbytes = 0; // decaying peak of the bytes allocated between two ticks
+
+    double estimate[LUA_GCPHASE_COUNT] = {0}; // decaying peak of the step times, to predict if the next step fits
+
+    lua_GCPaceStats stats = {};
+};
+
+// stack and CallInfo array of a collected thread, kept for a new thread
+struct ThreadStack {
+    TValue *stack;
+    CallInfo *ci;
+    int stacksize;
+    int size_ci;
+    uint8_t memcat; // the memory stays attributed to the category of the collected thread until it's reused
+};
+
+// see lua_setthreadpool
+struct ThreadPool {
+    ThreadStack stacks[LUAI_MAXTHREADPOOL];
+    int count = 0;
+    int size = LUAI_THREADPOOL;
+    int stacksize = LUAI_THREADPOOLSTACK;
+
+    lua_ThreadPoolStats stats = {};
+};
+
+// pattern compiled by string.find/match/gmatch/gsub, see getpattern in lstrlib.cpp
+struct PatternCacheEntry {
+    TString *key; // only compared, never dereferenced: the string may have been collected, so a hit is confirmed against the text kept in data
+    void *data;
+    size_t size;
+    uint32_t lastuse;
+};
+
+struct PatternCache {
+    PatternCacheEntry entries[LUAI_PATTERNCACHE];
+    uint32_t clock = 0;
+};
+
+// object allocated since the last minor collection, see youngcollection in lgc.cpp
+struct GCYoung {
+    GCObject *o;
+    struct lua_Page *page; // objects can only be freed with their page
+};
+
+// deterministic replay log, see lreplay.cpp
+struct ReplayState {
+    int mode; // see lua_ReplayMode
+
+    // record: ring buffer provided by the host (power of two size); play: log contents without the header
+    uint8_t *data;
+    size_t size;
+
+    // record: head is written by the VM and tail is written by lua_replaydrain, possibly from another task
+    // play: head is the read position in the log
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+
+    size_t dropped; // bytes of records that didn't fit into the ring buffer
+    unsigned ticks; // number of loop iterations marked via lua_replaytick
+};
+
+// execution budget enforced from the interrupt callback, see lwatchdog.cpp
+struct WatchdogState {
+    int safepoints; // budget per run, 0 if unlimited
+    double timeout; // budget per run in seconds, 0 if unlimited
+
+    void (*chained)(lua_State *L, int gc); // interrupt callback that was installed before the budget
+
+    int depth; // nesting of lua_pcall/lua_resume calls; a run starts and ends at depth 0
+    int remaining;
+    double starttime;
+    bool overrun;
+
+    // written by the VM when a run starts and ends, read by lua_watchdogtick from the timer task
+    std::atomic<bool> active;
+    std::atomic<unsigned> run; // incremented when a run starts
+    std::atomic<double> deadline;
+
+    // written by lua_watchdogtick, read by the interrupt callback; the run whose deadline has passed
+    std::atomic<unsigned> expired;
+
+    lua_BudgetStats stats;
+};
+
 #ifdef LUAI_GCMETRICS
 struct GCCycleMetrics
 {
@@ -143,6 +266,17 @@ struct GCMetrics
 };
 #endif
 
+/*
+** statistics and limits of a memory category, see lua_getmemcatstats
+*/
+typedef struct MemCatInfo {
+    TString *name;         /* name of the module the category was assigned to by luaM_getmemcat, fixed; NULL for other categories */
+    size_t peakbytes;      /* largest value of memcatbytes since the statistics are tracked */
+    size_t allocatedbytes; /* bytes allocated since the statistics are tracked; wraps around */
+    size_t softlimit;      /* only reported; 0 if not set */
+    size_t hardlimit;      /* allocations that would exceed it raise a memory error; 0 if not set */
+} MemCatInfo;
+
 /*
 ** `global state', shared by all threads of this state
 */
@@ -157,6 +291,7 @@ typedef struct global_State {
 
     uint8_t currentwhite;
     uint8_t gcstate; /* state of garbage collector */
+    uint8_t gckind;  /* kind of garbage collector, see KGC_INC */
 
 
     GCObject *gray;      /* list of gray objects */
@@ -165,12 +300,20 @@ typedef struct global_State {
 
     TString *strbufgc; // list of all string buffer objects
 
+    GCYoung *young; // objects allocated since the last minor collection (KGC_GEN only)
+    int nyoung;
+    int sizeyoung;
+
 
     size_t GCthreshold;                       // when totalbytes > GCthreshold; run GC step
     size_t totalbytes;                        // number of bytes currently allocated
     int gcgoal;                               // see LUAI_GCGOAL
     int gcstepmul;                            // see LUAI_GCSTEPMUL
     int gcstepsize;                          // see LUAI_GCSTEPSIZE
+    int gcgenminormul;                        // see LUAI_GCGENMINORMUL
+
+    int scratchdepth;        // number of open scratch scopes, see lua_beginscratch
+    size_t scratchthreshold; // GCthreshold when the outermost scratch scope was opened
 
     struct lua_Page *freepages[LUA_SIZECLASSES]; // free page linked list for each size class for non-collectable objects
     struct lua_Page *freegcopages[LUA_SIZECLASSES]; // free page linked list for each size class for collectable objects
@@ -178,6 +321,7 @@ typedef struct global_State {
     struct lua_Page *sweepgcopage; // position of the sweep in `allgcopages'
 
     size_t memcatbytes[LUA_MEMORY_CATEGORIES]; /* total amount of memory used by each memory category */
+    MemCatInfo *memcatinfo; /* statistics and limits of each memory category; NULL until luaM_trackmemcats is called */
 
 
     struct lua_State *mainthread;
@@ -202,6 +346,18 @@ typedef struct global_State {
     lua_Callbacks cb;
 
     GCStats gcstats;
+    GCStepMetrics stepmetrics;
+    GCPaceState gcpace;
+
+    ThreadPool threadpool;
+
+    PatternCache patterncache;
+
+    ReplayState replay;
+
+    WatchdogState watchdog;
+
+    lua_LoadStats loadstats; /* see luau_loadlazy */
 
 #ifdef LUAI_GCMETRICS
     GCMetrics gcmetrics;
@@ -217,7 +373,7 @@ struct lua_State {
     CommonHeader;
     uint8_t status;
 
-    uint8_t activememcat; /* memory category that is used for new GC object allocations */
+    uint8_t activememcat; /* memory category that is used for new GC object allocations; see luaE_memcat for 0 */
     uint8_t stackstate;
 
     bool singlestep; /* call debugstep hook after each instruction */
@@ -282,5 +438,6 @@ union GCObject {
 #define obj2gco(v) check_exp(iscollectable(v), cast_to(GCObject*, (v) + 0))
 
 LUAI_FUNC lua_State *luaE_newthread(lua_State *L);
+LUAI_FUNC uint8_t luaE_memcat(lua_State *L);
 
 LUAI_FUNC void luaE_freethread(lua_State *L, lua_State *L1, struct lua_Page *page);
@@ -70,12 +70,11 @@ static TString *newlstr(lua_State *L, const char *str, size_t l, unsigned int h)
     stringtable *tb;
     if (l > MAXSSIZE)
         luaM_toobig(L);
-    ts = luaM_newgco(L, TString, sizestring(l), L->activememcat);
+    ts = luaM_newgco(L, TString, sizestring(l), luaE_memcat(L));
     ts->len = unsigned(l);
     ts->hash = h;
     ts->marked = luaC_white(L->global);
     ts->tt = LUA_TSTRING;
-    ts->memcat = L->activememcat;
     memcpy(ts->data, str, l);
     ts->data[l] = '\0'; /* ending 0 */
     ts->atom = FFlag::LuauLazyAtoms ? ATOM_UNDEF : L->global->cb.useratom ? L->global->cb.useratom(ts->data, l) : -1;
@@ -118,10 +117,9 @@ TString *luaS_bufstart(lua_State *L, size_t size) {
     if (size > MAXSSIZE)
         luaM_toobig(L);
 
-    TString *ts = luaM_newgco(L, TString, sizestring(size), L->activememcat);
+    TString *ts = luaM_newgco(L, TString, sizestring(size), luaE_memcat(L));
 
     ts->tt = LUA_TSTRING;
-    ts->memcat = L->activememcat;
     linkstrbuf(L, ts);
 
     ts->len = unsigned(size);
@@ -3,6 +3,8 @@
 #include "../../include/lualib.h"
 
 #include "lstring.h"
+#include "lapi.h"
+#include "lmem.h"
 
 #include <ctype.h>
 #include <string.h>
@@ -162,11 +164,46 @@ static int str_char(lua_State *L) {
 #define CAP_UNFINISHED (-1)
 #define CAP_POSITION (-2)
 
+/*
+** A pattern is compiled once and kept in the global pattern cache (see getpattern), so that string.find/match/gmatch/gsub
+** don't parse it again on every call. The compiled form records, for every class item of the pattern, its end and the
+** set of characters it matches, which replaces classend and singlematch; and the literal prefix or the set of the first
+** character that every match starts with, so that the search skips to the positions where a match can start.
+*/
+
+#define MAXCOMPILED 255 /* longest pattern that is compiled, so that offsets fit in a byte */
+#define MAXSETS 32      /* most distinct character sets in a compiled pattern */
+
+#define PAT_PLAIN 1    /* no special characters, string.find does a plain search */
+#define PAT_ANCHOR 2   /* starts with '^' */
+#define PAT_STARTSET 4 /* every match starts with a character of set 'startset' */
+
+typedef uint8_t CharSet[32];
+
+typedef struct CompiledPattern {
+    uint16_t len; /* length of the pattern */
+    uint8_t flags;
+    uint8_t nsets;
+    uint8_t startset;
+    uint8_t prefixlen; /* length of the literal prefix of every match */
+    /* followed by: char text[len], uint8_t itemend[len], uint8_t itemset[len], char prefix[prefixlen], CharSet sets[nsets] */
+} CompiledPattern;
+
+#define cptext(cp) ((const char *) ((cp) + 1))
+#define cpitemend(cp) ((const uint8_t *) cptext(cp) + (cp)->len)
+#define cpitemset(cp) (cpitemend(cp) + (cp)->len)
+#define cpprefix(cp) ((const char *) cpitemset(cp) + (cp)->len)
+#define cpsets(cp) ((const CharSet *) (cpprefix(cp) + (cp)->prefixlen))
+
+#define inset(set, c) (((set)[(c) >> 3] >> ((c) & 7)) & 1)
+
 typedef struct MatchState {
     int matchdepth;       /* control for recursive depth (to avoid C stack overflow) */
     const char *src_init; /* init of source string */
     const char *src_end;  /* end ('\0') of source string */
     const char *p_end;    /* end ('\0') of pattern */
+    const char *p_init;   /* init of pattern (including a '^'), if it's compiled */
+    const CompiledPattern *cp;
     lua_State *L;
     int level; /* total number of captures (finished or unfinished) */
     struct {
@@ -197,6 +234,11 @@ static int capture_to_close(MatchState *ms) {
 }
 
 static const char *classend(MatchState *ms, const char *p) {
+    if (ms->cp) {
+        const uint8_t *itemend = cpitemend(ms->cp);
+        LUAU_ASSERT(itemend[p - ms->p_init] != 0);
+        return ms->p_init + itemend[p - ms->p_init];
+    }
     switch (*p++) {
         case L_ESC: {
             if (p == ms->p_end)
@@ -283,11 +325,20 @@ static int matchbracketclass(int c, const char *p, const char *ec) {
     return !sig;
 }
 
+/* match of a class item with the set of the compiled pattern */
+static int classmatch(MatchState *ms, int c, const char *p, const char *ep) {
+    const CompiledPattern *cp = ms->cp;
+    LUAU_ASSERT(cpitemend(cp)[p - ms->p_init] == ep - ms->p_init);
+    return inset(cpsets(cp)[cpitemset(cp)[p - ms->p_init]], c);
+}
+
 static int singlematch(MatchState *ms, const char *s, const char *p, const char *ep) {
     if (s >= ms->src_end)
         return 0;
     else {
         int c = uchar(*s);
+        if (ms->cp)
+            return classmatch(ms, c, p, ep);
         switch (*p) {
             case '.':
                 return 1; /* matches any char */
@@ -420,7 +471,8 @@ static const char *match(MatchState *ms, const char *s, const char *p) {
                             luaL_error(ms->L, "missing '[' after '%%f' in pattern");
                         ep = classend(ms, p); /* points to what is next */
                         previous = (s == ms->src_init) ? '\0' : *(s - 1);
-                        if (!matchbracketclass(uchar(previous), p, ep - 1) && matchbracketclass(uchar(*s), p, ep - 1)) {
+                        if (ms->cp ? !classmatch(ms, uchar(previous), p, ep) && classmatch(ms, uchar(*s), p, ep)
+                                   : !matchbracketclass(uchar(previous), p, ep - 1) && matchbracketclass(uchar(*s), p, ep - 1)) {
                             p = ep;
                             goto init; /* return match(ms, s, ep); */
                         }
@@ -554,12 +606,236 @@ static int nospecials(const char *p, size_t l) {
     return 1; /* no special chars found */
 }
 
-static void prepstate(MatchState *ms, lua_State *L, const char *s, size_t ls, const char *p, size_t lp) {
+/* end of the class item at p like classend, or NULL if the pattern is malformed */
+static const char *scanclass(const char *p, const char *p_end) {
+    switch (*p++) {
+        case L_ESC: {
+            return (p == p_end) ? NULL : p + 1;
+        }
+        case '[': {
+            if (*p == '^')
+                p++;
+            do {
+                if (p == p_end)
+                    return NULL;
+                if (*(p++) == L_ESC && p < p_end)
+                    p++;
+            } while (*p != ']');
+            return p + 1;
+        }
+        default: {
+            return p;
+        }
+    }
+}
+
+/* characters matched by the class item from p to ep, see singlematch */
+static void classset(CharSet set, const char *p, const char *ep) {
+    memset(set, 0, sizeof(CharSet));
+    for (int c = 0; c < 256; c++) {
+        int res;
+        switch (*p) {
+            case '.':
+                res = 1;
+                break;
+            case L_ESC:
+                res = match_class(c, uchar(*(p + 1)));
+                break;
+            case '[':
+                res = matchbracketclass(c, p, ep - 1);
+                break;
+            default:
+                res = (uchar(*p) == c);
+        }
+        if (res)
+            set[c >> 3] |= uint8_t(1 << (c & 7));
+    }
+}
+
+/* the only character of the set, or -1 if it has more or none */
+static int singlechar(const CharSet set) {
+    int res = -1;
+    for (int c = 0; c < 256; c++)
+        if (inset(set, c)) {
+            if (res >= 0)
+                return -1;
+            res = c;
+        }
+    return res;
+}
+
+/*
+** Compiles a pattern by walking it the way match does. Returns NULL for a malformed pattern, whose errors are raised
+** lazily by match when it gets to the malformed part, and for patterns with too many distinct classes.
+*/
+static CompiledPattern *compilepattern(lua_State *L, const char *pat, size_t len, size_t *size) {
+    uint8_t itemend[MAXCOMPILED] = {};
+    uint8_t itemset[MAXCOMPILED];
+    CharSet sets[MAXSETS];
+    int nsets = 0;
+    const char *p_end = pat + len;
+    const char *p;
+    int anchor = (len > 0 && *pat == '^');
+    /* a pattern that starts with '^' is parsed twice: gmatch doesn't anchor, so the '^' is an item with an optional suffix there */
+    for (const char *start = pat; start <= pat + anchor; start++) {
+        p = start;
+        while (p < p_end) {
+            const char *ep;
+            int suffix = 1;
+            switch (*p) {
+                case '(':
+                case ')': {
+                    p++;
+                    continue;
+                }
+                case '$': {
+                    if (p + 1 == p_end) {
+                        p++;
+                        continue;
+                    }
+                    break;
+                }
+                case L_ESC: {
+                    if (p + 1 == p_end)
+                        return NULL;
+                    if (*(p + 1) == 'b') {
+                        if (p + 4 > p_end)
+                            return NULL;
+                        p += 4;
+                        continue;
+                    }
+                    if (*(p + 1) == 'f') {
+                        p += 2;
+                        suffix = 0;
+                        if (p == p_end || *p != '[')
+                            return NULL;
+                    } else if (isdigit(uchar(*(p + 1)))) {
+                        p += 2;
+                        continue;
+                    }
+                    break;
+                }
+            }
+            /* class item with an optional suffix */
+            if ((ep = scanclass(p, p_end)) == NULL)
+                return NULL;
+            CharSet set;
+            classset(set, p, ep);
+            int i = 0;
+            while (i < nsets && memcmp(sets[i], set, sizeof(CharSet)) != 0)
+                i++;
+            if (i == nsets) {
+                if (nsets == MAXSETS)
+                    return NULL;
+                memcpy(sets[nsets++], set, sizeof(CharSet));
+            }
+            itemend[p - pat] = uint8_t(ep - pat);
+            itemset[p - pat] = uint8_t(i);
+            p = ep;
+            if (suffix && p < p_end && (*p == '*' || *p == '+' || *p == '?' || *p == '-'))
+                p++;
+        }
+    }
+
+    /* items that every match starts with: they follow only the start of captures */
+    char prefix[MAXCOMPILED];
+    int prefixlen = 0;
+    int startset = -1;
+    p = pat + anchor;
+    for (int captures = 0; p < p_end && *p == '(' && captures < LUA_MAXCAPTURES; captures++)
+        p += (*(p + 1) == ')') ? 2 : 1;
+    while (!anchor && p < p_end && itemend[p - pat] != 0) {
+        const char *ep = pat + itemend[p - pat];
+        if (ep < p_end && (*ep == '*' || *ep == '?' || *ep == '-'))
+            break; /* the item can match nothing */
+        const CharSet &set = sets[itemset[p - pat]];
+        if (startset < 0)
+            startset = itemset[p - pat];
+        int c = singlechar(set);
+        if (c < 0)
+            break;
+        prefix[prefixlen++] = char(c);
+        if (ep < p_end && *ep == '+')
+            break;
+        p = ep;
+    }
+
+    *size = sizeof(CompiledPattern) + 3 * len + prefixlen + nsets * sizeof(CharSet);
+    CompiledPattern *cp = static_cast<CompiledPattern *>(luaM_new_(L, *size, 0));
+    cp->len = uint16_t(len);
+    cp->flags = (nospecials(pat, len) ? PAT_PLAIN : 0) | (anchor ? PAT_ANCHOR : 0) | (startset >= 0 ? PAT_STARTSET : 0);
+    cp->nsets = uint8_t(nsets);
+    cp->startset = uint8_t(startset >= 0 ? startset : 0);
+    cp->prefixlen = uint8_t(prefixlen);
+    char *data = reinterpret_cast<char *>(cp + 1);
+    memcpy(data, pat, len);
+    memcpy(data + len, itemend, len);
+    memcpy(data + 2 * len, itemset, len);
+    memcpy(data + 3 * len, prefix, prefixlen);
+    memcpy(data + 3 * len + prefixlen, sets, nsets * sizeof(CharSet));
+    return cp;
+}
+
+/* compiled form of the pattern string at idx from the global cache, NULL if it can't be compiled */
+static const CompiledPattern *getpattern(lua_State *L, int idx) {
+    TString *ts = tsvalue(luaA_toobject(L, idx));
+    if (ts->len > MAXCOMPILED)
+        return NULL;
+    PatternCache &cache = L->global->patterncache;
+    uint32_t clock = ++cache.clock;
+    PatternCacheEntry *victim = &cache.entries[0];
+    for (PatternCacheEntry &e : cache.entries) {
+        if (e.key == ts) {
+            const CompiledPattern *cp = static_cast<const CompiledPattern *>(e.data);
+            if (cp->len == ts->len && memcmp(cptext(cp), getstr(ts), ts->len) == 0) {
+                e.lastuse = clock;
+                return cp;
+            }
+            victim = &e; /* the string was collected and another one has its address */
+            break;
+        }
+        if (e.lastuse < victim->lastuse)
+            victim = &e;
+    }
+    size_t size;
+    CompiledPattern *cp = compilepattern(L, getstr(ts), ts->len, &size);
+    if (!cp)
+        return NULL;
+    if (victim->data)
+        luaM_free_(L, victim->data, victim->size, 0);
+    victim->key = ts;
+    victim->data = cp;
+    victim->size = size;
+    victim->lastuse = clock;
+    return cp;
+}
+
+/* whether the search can skip to the positions where a match can start, see matchstart */
+static int canskip(const CompiledPattern *cp) {
+    return cp && !(cp->flags & PAT_ANCHOR) && (cp->prefixlen || (cp->flags & PAT_STARTSET));
+}
+
+/* first position from s where a match can start, or NULL if there is none */
+static const char *matchstart(MatchState *ms, const char *s) {
+    const CompiledPattern *cp = ms->cp;
+    if (cp->prefixlen)
+        return lmemfind(s, ms->src_end - s, cpprefix(cp), cp->prefixlen);
+    const uint8_t *set = cpsets(cp)[cp->startset];
+    for (; s < ms->src_end; s++)
+        if (inset(set, uchar(*s)))
+            return s;
+    return NULL;
+}
+
+static void prepstate(MatchState *ms, lua_State *L, const char *s, size_t ls, const char *p, size_t lp,
+                      const CompiledPattern *cp) {
     ms->L = L;
     ms->matchdepth = LUAI_MAXCCALLS;
     ms->src_init = s;
     ms->src_end = s + ls;
     ms->p_end = p + lp;
+    ms->p_init = cp ? ms->p_end - cp->len : NULL;
+    ms->cp = cp;
 }
 
 static void reprepstate(MatchState *ms) {
@@ -571,6 +847,7 @@ static int str_find_aux(lua_State *L, int find) {
     size_t ls, lp;
     const char *s = luaL_checklstring(L, 1, &ls);
     const char *p = luaL_checklstring(L, 2, &lp);
+    const CompiledPattern *cp = getpattern(L, 2);
     int init = posrelat(luaL_optinteger(L, 3, 1), ls);
     if (init < 1)
         init = 1;
@@ -579,7 +856,7 @@ static int str_find_aux(lua_State *L, int find) {
         return 1;
     }
     /* explicit request or no special characters? */
-    if (find && (lua_toboolean(L, 4) || nospecials(p, lp))) {
+    if (find && (lua_toboolean(L, 4) || (cp ? (cp->flags & PAT_PLAIN) : nospecials(p, lp)))) {
         /* do a plain search */
         const char *s2 = lmemfind(s + init - 1, ls - init + 1, p, lp);
         if (s2) {
@@ -591,13 +868,16 @@ static int str_find_aux(lua_State *L, int find) {
         MatchState ms;
         const char *s1 = s + init - 1;
         int anchor = (*p == '^');
+        int skip = canskip(cp);
         if (anchor) {
             p++;
             lp--; /* skip anchor character */
         }
-        prepstate(&ms, L, s, ls, p, lp);
+        prepstate(&ms, L, s, ls, p, lp, cp);
         do {
             const char *res;
+            if (skip && (s1 = matchstart(&ms, s1)) == NULL)
+                break;
             reprepstate(&ms);
             if ((res = match(&ms, s1, p)) != NULL) {
                 if (find) {
@@ -626,10 +906,14 @@ static int gmatch_aux(lua_State *L) {
     size_t ls, lp;
     const char *s = lua_tolstring(L, lua_upvalueindex(1), &ls);
     const char *p = lua_tolstring(L, lua_upvalueindex(2), &lp);
+    const CompiledPattern *cp = getpattern(L, lua_upvalueindex(2));
+    int skip = canskip(cp);
     const char *src;
-    prepstate(&ms, L, s, ls, p, lp);
+    prepstate(&ms, L, s, ls, p, lp, cp);
     for (src = s + (size_t) lua_tointeger(L, lua_upvalueindex(3)); src <= ms.src_end; src++) {
         const char *e;
+        if (skip && (src = matchstart(&ms, src)) == NULL)
+            break;
         reprepstate(&ms);
         if ((e = match(&ms, src, p)) != NULL) {
             int newstart = (int) (e - s);
@@ -709,9 +993,11 @@ static int str_gsub(lua_State *L) {
     size_t srcl, lp;
     const char *src = luaL_checklstring(L, 1, &srcl);
     const char *p = luaL_checklstring(L, 2, &lp);
+    const CompiledPattern *cp = getpattern(L, 2);
     int tr = lua_type(L, 3);
     int max_s = luaL_optinteger(L, 4, (int) srcl + 1);
     int anchor = (*p == '^');
+    int skip = canskip(cp);
     int n = 0;
     MatchState ms;
     luaL_Buffer b;
@@ -722,9 +1008,16 @@ static int str_gsub(lua_State *L) {
         p++;
         lp--; /* skip anchor character */
     }
-    prepstate(&ms, L, src, srcl, p, lp);
+    prepstate(&ms, L, src, srcl, p, lp, cp);
     while (n < max_s) {
         const char *e;
+        if (skip) {
+            const char *start = matchstart(&ms, src);
+            if (start == NULL)
+                break;
+            luaL_addlstring(&b, src, start - src); /* keep the text where no match can start */
+            src = start;
+        }
         reprepstate(&ms);
         e = match(&ms, src, p);
         if (e) {
@@ -429,7 +429,7 @@ static void rehash(lua_State *L, Table *t, const TValue *ek) {
 */
 
 Table *luaH_new(lua_State *L, int narray, int nhash) {
-    Table *t = luaM_newgco(L, Table, sizeof(Table), L->activememcat);
+    Table *t = luaM_newgco(L, Table, sizeof(Table), luaE_memcat(L));
     luaC_init(L, t, LUA_TTABLE);
     t->metatable = NULL;
     t->tmcache = cast_byte(~0);
@@ -688,7 +688,7 @@ int luaH_getn(Table *t) {
 }
 
 Table *luaH_clone(lua_State *L, Table *tt) {
-    Table *t = luaM_newgco(L, Table, sizeof(Table), L->activememcat);
+    Table *t = luaM_newgco(L, Table, sizeof(Table), luaE_memcat(L));
     luaC_init(L, t, LUA_TTABLE);
     t->metatable = tt->metatable;
     t->tmcache = tt->tmcache;
@@ -10,7 +10,7 @@
 Udata *luaU_newudata(lua_State *L, size_t s, int tag) {
     if (s > INT_MAX - sizeof(Udata))
         luaM_toobig(L);
-    Udata *u = luaM_newgco(L, Udata, sizeudata(s), L->activememcat);
+    Udata *u = luaM_newgco(L, Udata, sizeudata(s), luaE_memcat(L));
     luaC_init(L, u, LUA_TUSERDATA);
     u->len = int(s);
     u->metatable = NULL;
@@ -10,6 +10,9 @@
 /* special tag value is used for newproxy-created user data (all other user data objects are host-exposed) */
 #define UTAG_PROXY (LUA_UTAG_LIMIT + 1)
 
+/* special tag value is used for buffer objects, see lbuflib.cpp; the data of the user data are the bytes of the buffer */
+#define UTAG_BUFFER (LUA_UTAG_LIMIT + 2)
+
 #define sizeudata(len) (offsetof(Udata, data) + len)
 
 LUAI_FUNC Udata *luaU_newudata(lua_State *L, size_t s, int tag);
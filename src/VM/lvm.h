@@ -37,6 +37,10 @@ LUAI_FUNC void luaV_concat(lua_State *L, int total, int last);
 
 LUAI_FUNC void luaV_getimport(lua_State *L, Table *env, TValue *k, uint32_t id, bool propagatenil);
 
+LUAI_FUNC void luau_loadproto(lua_State *L, Proto *p);
+
+LUAI_FUNC void luau_unloadproto(lua_State *L, Proto *p);
+
 LUAI_FUNC void luau_execute(lua_State *L);
 
 LUAI_FUNC int luau_precall(lua_State *L, struct lua_TValue *func, int nresults);
@@ -65,7 +65,9 @@ LUAU_FASTFLAGVARIABLE(LuauLenTM, false)
 #define VM_KV(i) (LUAU_ASSERT(unsigned(i) < unsigned(cl->l.p->sizek)), &k[i])
 #define VM_UV(i) (LUAU_ASSERT(unsigned(i) < unsigned(cl->nupvalues)), &cl->l.uprefs[i])
 
-#define VM_PATCH_C(pc, slot) *const_cast<Instruction*>(pc) = ((uint8_t(slot) << 24) | (0x00ffffffu & *(pc)))
+// inline cache of an instruction that looks up a constant key; code may be read-only, so C is an index into the cache array of the proto
+#define VM_CACHE(insn) (cl->l.p->cache[LUAU_INSN_C(insn)])
+
 #define VM_PATCH_E(pc, slot) *const_cast<Instruction*>(pc) = ((uint32_t(slot) << 8) | (0x000000ffu & *(pc)))
 
 // NOTE: If debugging the Luau code, disable this macro to prevent timeouts from
@@ -110,7 +112,12 @@ LUAU_FASTFLAGVARIABLE(LuauLenTM, false)
         VM_DISPATCH_OP(LOP_FORGLOOP_NEXT), VM_DISPATCH_OP(LOP_GETVARARGS), VM_DISPATCH_OP(LOP_DUPCLOSURE), VM_DISPATCH_OP(LOP_PREPVARARGS), \
         VM_DISPATCH_OP(LOP_LOADKX), VM_DISPATCH_OP(LOP_JUMPX), VM_DISPATCH_OP(LOP_FASTCALL), VM_DISPATCH_OP(LOP_COVERAGE), \
         VM_DISPATCH_OP(LOP_CAPTURE), VM_DISPATCH_OP(LOP_JUMPIFEQK), VM_DISPATCH_OP(LOP_JUMPIFNOTEQK), VM_DISPATCH_OP(LOP_FASTCALL1), \
-        VM_DISPATCH_OP(LOP_FASTCALL2), VM_DISPATCH_OP(LOP_FASTCALL2K), VM_DISPATCH_OP(LOP_FORGPREP),
+        VM_DISPATCH_OP(LOP_FASTCALL2), VM_DISPATCH_OP(LOP_FASTCALL2K), VM_DISPATCH_OP(LOP_FORGPREP), \
+        VM_DISPATCH_OP(LOP_ADDN), VM_DISPATCH_OP(LOP_SUBN), VM_DISPATCH_OP(LOP_MULN), VM_DISPATCH_OP(LOP_DIVN), \
+        VM_DISPATCH_OP(LOP_JUMPIFLEN), VM_DISPATCH_OP(LOP_JUMPIFLTN), VM_DISPATCH_OP(LOP_JUMPIFNOTLEN), VM_DISPATCH_OP(LOP_JUMPIFNOTLTN), \
+        VM_DISPATCH_OP(LOP_LOADN_JUMPIFLT), VM_DISPATCH_OP(LOP_LOADN_JUMPIFLE), VM_DISPATCH_OP(LOP_LOADN_JUMPIFNOTLT), \
+        VM_DISPATCH_OP(LOP_LOADN_JUMPIFNOTLE), VM_DISPATCH_OP(LOP_LOADN_NAMECALL), VM_DISPATCH_OP(LOP_GETTABLEKS_NAMECALL), \
+        VM_DISPATCH_OP(LOP_GETIMPORT_CALL), VM_DISPATCH_OP(LOP_JUMPTABLE),
 
 #if defined(__GNUC__) || defined(__clang__)
 #define VM_USE_CGOTO 1
@@ -125,17 +132,24 @@ LUAU_FASTFLAGVARIABLE(LuauLenTM, false)
  * VM_NEXT() fetch a byte and dispatch or jump to the beginning of the switch statement
  * VM_CONTINUE() Use an opcode override to dispatch with computed goto or
  * switch statement to skip a LOP_BREAK instruction.
+ * VM_FUSED_NEXT(op) continue into the second instruction of a superinstruction;
+ * with a constant opcode this compiles to a direct jump to the handler.
  */
 #if VM_USE_CGOTO
 #define VM_CASE(op) CASE_##op:
 #define VM_NEXT() goto*(SingleStep ? &&dispatch : kDispatchTable[LUAU_INSN_OP(*pc)])
 #define VM_CONTINUE(op) goto* kDispatchTable[uint8_t(op)]
+#define VM_FUSED_NEXT(op) goto*(SingleStep ? &&dispatch : kDispatchTable[uint8_t(op)])
 #else
 #define VM_CASE(op) case op:
 #define VM_NEXT() goto dispatch
 #define VM_CONTINUE(op) \
     dispatchOp = uint8_t(op); \
     goto dispatchContinue
+#define VM_FUSED_NEXT(op) \
+    if (SingleStep) \
+        goto dispatch; \
+    VM_CONTINUE(op)
 #endif
 
 LUAU_NOINLINE static void luau_prepareFORN(lua_State *L, StkId plimit, StkId pstep, StkId pinit) {
@@ -234,6 +248,23 @@ LUAU_NOINLINE static void luau_tryfuncTM(lua_State *L, StkId func) {
     setobj2s(L, func, tm); /* tag method is the new function to be called */
 }
 
+// replaces a number-specialized instruction with its generic version once the operands turn out to be of a different type
+// note: breakpoints keep the original opcode in debuginsn, so that's where the replacement goes if the instruction has one
+// note: code that is executed in place can't be patched, so such instructions keep falling back to the generic version
+LUAU_NOINLINE static void luau_deopt(Closure *cl, const Instruction *pc, LuauOpcode op) {
+    Proto *p = cl->l.p;
+    Instruction *code = const_cast<Instruction *>(pc);
+
+    if (p->codeinplace)
+        return;
+
+    if (p->debuginsn)
+        p->debuginsn[pc - p->code] = uint8_t(op);
+
+    if (LUAU_INSN_OP(*code) != LOP_BREAK)
+        *code = (*code & ~0xffu) | uint8_t(op);
+}
+
 LUAU_NOINLINE void luau_callhook(lua_State *L, lua_Hook hook, void *userdata) {
     ptrdiff_t base = savestack(L, L->base);
     ptrdiff_t top = savestack(L, L->top);
@@ -405,7 +436,7 @@ static void luau_execute(lua_State *L) {
 
                 // fast-path: value is in expected slot
                 Table *h = cl->env;
-                int slot = LUAU_INSN_C(insn) & h->nodemask8;
+                int slot = VM_CACHE(insn) & h->nodemask8;
                 LuaNode *n = &h->node[slot];
 
                 if (LUAU_LIKELY(ttisstring(gkey(n)) && tsvalue(gkey(n)) == tsvalue(kv)) && !ttisnil(gval(n))) {
@@ -417,8 +448,8 @@ static void luau_execute(lua_State *L) {
                     sethvalue(L, &g, h);
                     L->cachedslot = slot;
                     VM_PROTECT(luaV_gettable(L, &g, kv, ra));
-                    // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                    VM_PATCH_C(pc - 2, L->cachedslot);
+                    // save cachedslot to accelerate future lookups
+                    VM_CACHE(insn) = uint8_t(L->cachedslot);
                     VM_NEXT();
                 }
             }
@@ -433,7 +464,7 @@ static void luau_execute(lua_State *L) {
 
                 // fast-path: value is in expected slot
                 Table *h = cl->env;
-                int slot = LUAU_INSN_C(insn) & h->nodemask8;
+                int slot = VM_CACHE(insn) & h->nodemask8;
                 LuaNode *n = &h->node[slot];
 
                 if (LUAU_LIKELY(
@@ -447,8 +478,8 @@ static void luau_execute(lua_State *L) {
                     sethvalue(L, &g, h);
                     L->cachedslot = slot;
                     VM_PROTECT(luaV_settable(L, &g, kv, ra));
-                    // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                    VM_PATCH_C(pc - 2, L->cachedslot);
+                    // save cachedslot to accelerate future lookups
+                    VM_CACHE(insn) = uint8_t(L->cachedslot);
                     VM_NEXT();
                 }
             }
@@ -523,7 +554,7 @@ static void luau_execute(lua_State *L) {
                 if (ttistable(rb)) {
                     Table *h = hvalue(rb);
 
-                    int slot = LUAU_INSN_C(insn) & h->nodemask8;
+                    int slot = VM_CACHE(insn) & h->nodemask8;
                     LuaNode *n = &h->node[slot];
 
                     // fast-path: value is in expected slot
@@ -536,8 +567,8 @@ static void luau_execute(lua_State *L) {
 
                         if (res != luaO_nilobject) {
                             int cachedslot = gval2slot(h, res);
-                            // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                            VM_PATCH_C(pc - 2, cachedslot);
+                            // save cachedslot to accelerate future lookups
+                            VM_CACHE(insn) = uint8_t(cachedslot);
                         }
 
                         setobj2s(L, ra, res);
@@ -546,8 +577,8 @@ static void luau_execute(lua_State *L) {
                         // slow-path, may invoke Lua calls via __index metamethod
                         L->cachedslot = slot;
                         VM_PROTECT(luaV_gettable(L, rb, kv, ra));
-                        // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                        VM_PATCH_C(pc - 2, L->cachedslot);
+                        // save cachedslot to accelerate future lookups
+                        VM_CACHE(insn) = uint8_t(L->cachedslot);
                         VM_NEXT();
                     }
                 } else {
@@ -563,10 +594,10 @@ static void luau_execute(lua_State *L) {
                         setobj2s(L, top + 2, kv);
                         L->top = top + 3;
 
-                        L->cachedslot = LUAU_INSN_C(insn);
+                        L->cachedslot = VM_CACHE(insn);
                         VM_PROTECT(luau_callTM(L, 2, LUAU_INSN_A(insn)));
-                        // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                        VM_PATCH_C(pc - 2, L->cachedslot);
+                        // save cachedslot to accelerate future lookups
+                        VM_CACHE(insn) = uint8_t(L->cachedslot);
                         VM_NEXT();
                     } else if (ttisvector(rb)) {
                         // fast-path: quick case-insensitive comparison with "X"/"Y"/"Z"
@@ -596,10 +627,10 @@ static void luau_execute(lua_State *L) {
                             setobj2s(L, top + 2, kv);
                             L->top = top + 3;
 
-                            L->cachedslot = LUAU_INSN_C(insn);
+                            L->cachedslot = VM_CACHE(insn);
                             VM_PROTECT(luau_callTM(L, 2, LUAU_INSN_A(insn)));
-                            // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                            VM_PATCH_C(pc - 2, L->cachedslot);
+                            // save cachedslot to accelerate future lookups
+                            VM_CACHE(insn) = uint8_t(L->cachedslot);
                             VM_NEXT();
                         }
 
@@ -627,7 +658,7 @@ static void luau_execute(lua_State *L) {
                 if (ttistable(rb)) {
                     Table *h = hvalue(rb);
 
-                    int slot = LUAU_INSN_C(insn) & h->nodemask8;
+                    int slot = VM_CACHE(insn) & h->nodemask8;
                     LuaNode *n = &h->node[slot];
 
                     // fast-path: value is in expected slot
@@ -641,8 +672,8 @@ static void luau_execute(lua_State *L) {
 
                         TValue *res = luaH_setstr(L, h, tsvalue(kv));
                         int cachedslot = gval2slot(h, res);
-                        // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                        VM_PATCH_C(pc - 2, cachedslot);
+                        // save cachedslot to accelerate future lookups
+                        VM_CACHE(insn) = uint8_t(cachedslot);
                         setobj(L, res, ra);
                         luaC_barriert(L, h, ra);
                         VM_NEXT();
@@ -650,8 +681,8 @@ static void luau_execute(lua_State *L) {
                         // slow-path, may invoke Lua calls via __newindex metamethod
                         L->cachedslot = slot;
                         VM_PROTECT(luaV_settable(L, rb, kv, ra));
-                        // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                        VM_PATCH_C(pc - 2, L->cachedslot);
+                        // save cachedslot to accelerate future lookups
+                        VM_CACHE(insn) = uint8_t(L->cachedslot);
                         VM_NEXT();
                     }
                 } else {
@@ -668,10 +699,10 @@ static void luau_execute(lua_State *L) {
                         setobj2s(L, top + 3, ra);
                         L->top = top + 4;
 
-                        L->cachedslot = LUAU_INSN_C(insn);
+                        L->cachedslot = VM_CACHE(insn);
                         VM_PROTECT(luau_callTM(L, 3, -1));
-                        // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                        VM_PATCH_C(pc - 2, L->cachedslot);
+                        // save cachedslot to accelerate future lookups
+                        VM_CACHE(insn) = uint8_t(L->cachedslot);
                         VM_NEXT();
                     } else {
                         // slow-path, may invoke Lua calls via __newindex metamethod
@@ -854,7 +885,7 @@ static void luau_execute(lua_State *L) {
                     }
                         // fast-path: key is absent from the base, table has an __index table, and it has the result in the expected slot
                     else if (gnext(n) == 0 && (mt = fasttm(L, hvalue(rb)->metatable, TM_INDEX)) && ttistable(mt) &&
-                             (mtn = &hvalue(mt)->node[LUAU_INSN_C(insn) & hvalue(mt)->nodemask8]) &&
+                             (mtn = &hvalue(mt)->node[VM_CACHE(insn) & hvalue(mt)->nodemask8]) &&
                              ttisstring(gkey(mtn)) &&
                              tsvalue(gkey(mtn)) == tsvalue(kv) && !ttisnil(gval(mtn))) {
                         // note: order of copies allows rb to alias ra+1 or ra
@@ -863,10 +894,10 @@ static void luau_execute(lua_State *L) {
                     } else {
                         // slow-path: handles full table lookup
                         setobj2s(L, ra + 1, rb);
-                        L->cachedslot = LUAU_INSN_C(insn);
+                        L->cachedslot = VM_CACHE(insn);
                         VM_PROTECT(luaV_gettable(L, rb, kv, ra));
-                        // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                        VM_PATCH_C(pc - 2, L->cachedslot);
+                        // save cachedslot to accelerate future lookups
+                        VM_CACHE(insn) = uint8_t(L->cachedslot);
                     }
                 } else {
                     Table *mt = ttisuserdata(rb) ? uvalue(rb)->metatable : L->global->mt[ttype(rb)];
@@ -881,7 +912,7 @@ static void luau_execute(lua_State *L) {
                         L->namecall = tsvalue(kv);
                     } else if ((tmi = fasttm(L, mt, TM_INDEX)) && ttistable(tmi)) {
                         Table *h = hvalue(tmi);
-                        int slot = LUAU_INSN_C(insn) & h->nodemask8;
+                        int slot = VM_CACHE(insn) & h->nodemask8;
                         LuaNode *n = &h->node[slot];
 
                         // fast-path: metatable with __index that has method in expected slot
@@ -894,8 +925,8 @@ static void luau_execute(lua_State *L) {
                             setobj2s(L, ra + 1, rb);
                             L->cachedslot = slot;
                             VM_PROTECT(luaV_gettable(L, rb, kv, ra));
-                            // save cachedslot to accelerate future lookups; patches currently executing instruction since pc-2 rolls back two pc++
-                            VM_PATCH_C(pc - 2, L->cachedslot);
+                            // save cachedslot to accelerate future lookups
+                            VM_CACHE(insn) = uint8_t(L->cachedslot);
                         }
                     } else {
                         // slow-path: handles non-table __index
@@ -929,6 +960,11 @@ static void luau_execute(lua_State *L) {
                 Closure *ccl = clvalue(ra);
                 L->ci->savedpc = pc;
 
+                // slow-path: the function was loaded lazily and hasn't been decoded yet; this may fail with a memory error but doesn't touch
+                // the stack
+                if (LUAU_UNLIKELY(!ccl->isC && ccl->l.p->lazy))
+                    luau_loadproto(L, ccl->l.p);
+
                 CallInfo *ci = incr_ci(L);
                 ci->func = ra;
                 ci->base = ra + 1;
@@ -2471,9 +2507,10 @@ static void luau_execute(lua_State *L) {
                 Instruction insn = *pc++;
                 int hits = LUAU_INSN_E(insn);
 
-                // update hits with saturated add and patch the instruction in place
+                // update hits with saturated add and patch the instruction in place; code that is executed in place is read-only
                 hits = (hits < (1 << 23) - 1) ? hits + 1 : hits;
-                VM_PATCH_E(pc - 1, hits);
+                if (!cl->l.p->codeinplace)
+                    VM_PATCH_E(pc - 1, hits);
 
                 VM_NEXT();
             }
@@ -2690,6 +2727,275 @@ static void luau_execute(lua_State *L) {
                 }
             }
 
+            VM_CASE(LOP_ADDN)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(LUAU_INSN_B(insn));
+                StkId rc = VM_REG(LUAU_INSN_C(insn));
+
+                if (LUAU_LIKELY(ttisnumber(rb) && ttisnumber(rc))) {
+                    setnvalue(ra, nvalue(rb) + nvalue(rc));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_ADD);
+                    pc--;
+                    VM_CONTINUE(LOP_ADD);
+                }
+            }
+
+            VM_CASE(LOP_SUBN)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(LUAU_INSN_B(insn));
+                StkId rc = VM_REG(LUAU_INSN_C(insn));
+
+                if (LUAU_LIKELY(ttisnumber(rb) && ttisnumber(rc))) {
+                    setnvalue(ra, nvalue(rb) - nvalue(rc));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_SUB);
+                    pc--;
+                    VM_CONTINUE(LOP_SUB);
+                }
+            }
+
+            VM_CASE(LOP_MULN)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(LUAU_INSN_B(insn));
+                StkId rc = VM_REG(LUAU_INSN_C(insn));
+
+                if (LUAU_LIKELY(ttisnumber(rb) && ttisnumber(rc))) {
+                    setnvalue(ra, nvalue(rb) * nvalue(rc));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_MUL);
+                    pc--;
+                    VM_CONTINUE(LOP_MUL);
+                }
+            }
+
+            VM_CASE(LOP_DIVN)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(LUAU_INSN_B(insn));
+                StkId rc = VM_REG(LUAU_INSN_C(insn));
+
+                if (LUAU_LIKELY(ttisnumber(rb) && ttisnumber(rc))) {
+                    setnvalue(ra, nvalue(rb) / nvalue(rc));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_DIV);
+                    pc--;
+                    VM_CONTINUE(LOP_DIV);
+                }
+            }
+
+            VM_CASE(LOP_JUMPIFLEN)
+            {
+                Instruction insn = *pc++;
+                uint32_t aux = *pc;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(aux);
+
+                // Note that the jump below jumps by 1 in the "false" case to skip over aux
+                if (LUAU_LIKELY(ttisnumber(ra) && ttisnumber(rb))) {
+                    pc += nvalue(ra) <= nvalue(rb) ? LUAU_INSN_D(insn) : 1;
+                    LUAU_ASSERT(unsigned(pc -cl->l.p->code) < unsigned(cl->l.p->sizecode));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_JUMPIFLE);
+                    pc--;
+                    VM_CONTINUE(LOP_JUMPIFLE);
+                }
+            }
+
+            VM_CASE(LOP_JUMPIFLTN)
+            {
+                Instruction insn = *pc++;
+                uint32_t aux = *pc;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(aux);
+
+                // Note that the jump below jumps by 1 in the "false" case to skip over aux
+                if (LUAU_LIKELY(ttisnumber(ra) && ttisnumber(rb))) {
+                    pc += nvalue(ra) < nvalue(rb) ? LUAU_INSN_D(insn) : 1;
+                    LUAU_ASSERT(unsigned(pc -cl->l.p->code) < unsigned(cl->l.p->sizecode));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_JUMPIFLT);
+                    pc--;
+                    VM_CONTINUE(LOP_JUMPIFLT);
+                }
+            }
+
+            VM_CASE(LOP_JUMPIFNOTLEN)
+            {
+                Instruction insn = *pc++;
+                uint32_t aux = *pc;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(aux);
+
+                // Note that the jump below jumps by 1 in the "true" case to skip over aux
+                if (LUAU_LIKELY(ttisnumber(ra) && ttisnumber(rb))) {
+                    pc += !(nvalue(ra) <= nvalue(rb)) ? LUAU_INSN_D(insn) : 1;
+                    LUAU_ASSERT(unsigned(pc -cl->l.p->code) < unsigned(cl->l.p->sizecode));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_JUMPIFNOTLE);
+                    pc--;
+                    VM_CONTINUE(LOP_JUMPIFNOTLE);
+                }
+            }
+
+            VM_CASE(LOP_JUMPIFNOTLTN)
+            {
+                Instruction insn = *pc++;
+                uint32_t aux = *pc;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(aux);
+
+                // Note that the jump below jumps by 1 in the "true" case to skip over aux
+                if (LUAU_LIKELY(ttisnumber(ra) && ttisnumber(rb))) {
+                    pc += !(nvalue(ra) < nvalue(rb)) ? LUAU_INSN_D(insn) : 1;
+                    LUAU_ASSERT(unsigned(pc -cl->l.p->code) < unsigned(cl->l.p->sizecode));
+                    VM_NEXT();
+                } else {
+                    luau_deopt(cl, pc - 1, LOP_JUMPIFNOTLT);
+                    pc--;
+                    VM_CONTINUE(LOP_JUMPIFNOTLT);
+                }
+            }
+
+            VM_CASE(LOP_LOADN_JUMPIFLT)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+
+                setnvalue(ra, LUAU_INSN_D(insn));
+                VM_FUSED_NEXT(LOP_JUMPIFLT);
+            }
+
+            VM_CASE(LOP_LOADN_JUMPIFLE)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+
+                setnvalue(ra, LUAU_INSN_D(insn));
+                VM_FUSED_NEXT(LOP_JUMPIFLE);
+            }
+
+            VM_CASE(LOP_LOADN_JUMPIFNOTLT)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+
+                setnvalue(ra, LUAU_INSN_D(insn));
+                VM_FUSED_NEXT(LOP_JUMPIFNOTLT);
+            }
+
+            VM_CASE(LOP_LOADN_JUMPIFNOTLE)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+
+                setnvalue(ra, LUAU_INSN_D(insn));
+                VM_FUSED_NEXT(LOP_JUMPIFNOTLE);
+            }
+
+            VM_CASE(LOP_LOADN_NAMECALL)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+
+                setnvalue(ra, LUAU_INSN_D(insn));
+                VM_FUSED_NEXT(LOP_NAMECALL);
+            }
+
+            VM_CASE(LOP_GETTABLEKS_NAMECALL)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                StkId rb = VM_REG(LUAU_INSN_B(insn));
+                uint32_t aux = *pc++;
+                TValue *kv = VM_KV(aux);
+                LUAU_ASSERT(ttisstring(kv));
+
+                // fast-path: built-in table with the value in expected slot
+                if (ttistable(rb)) {
+                    Table *h = hvalue(rb);
+                    LuaNode *n = &h->node[VM_CACHE(insn) & h->nodemask8];
+
+                    if (LUAU_LIKELY(ttisstring(gkey(n)) && tsvalue(gkey(n)) == tsvalue(kv) && !ttisnil(gval(n)))) {
+                        setobj2s(L, ra, gval(n));
+                        VM_FUSED_NEXT(LOP_NAMECALL);
+                    }
+                }
+
+                // slow-path: generic GETTABLEKS handler updates the cached slot and dispatches NAMECALL normally
+                pc -= 2;
+                VM_CONTINUE(LOP_GETTABLEKS);
+            }
+
+            VM_CASE(LOP_GETIMPORT_CALL)
+            {
+                Instruction insn = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                TValue *kv = VM_KV(LUAU_INSN_D(insn));
+
+                // fast-path: import resolution was successful and closure environment is "safe" for import
+                if (!ttisnil(kv) && cl->env->safeenv) {
+                    setobj2s(L, ra, kv);
+                    pc++; // skip over AUX
+                    VM_FUSED_NEXT(LOP_CALL);
+                } else {
+                    pc--;
+                    VM_CONTINUE(LOP_GETIMPORT);
+                }
+            }
+
+            VM_CASE(LOP_JUMPTABLE)
+            {
+                Instruction insn = *pc++;
+                uint32_t aux = *pc++;
+                StkId ra = VM_REG(LUAU_INSN_A(insn));
+                unsigned count = LUAU_INSN_B(insn);
+
+                // entries are JUMPIFEQK instructions; we only need to check the key of the one entry that can match
+                const Instruction *entry = NULL;
+
+                if (LUAU_INSN_C(insn) == 0) {
+                    if (ttisnumber(ra)) {
+                        double index = nvalue(ra) - double(int32_t(aux));
+
+                        if (index >= 0 && index < count)
+                            entry = pc + 2 * unsigned(index);
+                    }
+                } else if (ttisstring(ra) && count) {
+                    entry = pc + 2 * ((tsvalue(ra)->hash >> aux) & (count - 1));
+                }
+
+                if (entry) {
+                    LUAU_ASSERT(LUAU_INSN_OP(*entry) == LOP_JUMPIFEQK);
+                    TValue *kv = VM_KV(entry[1]);
+
+                    if (ttype(kv) == ttype(ra) && (ttisnumber(ra) ? nvalue(kv) == nvalue(ra) : gcvalue(kv) == gcvalue(ra))) {
+                        pc = entry + 1 + LUAU_INSN_D(*entry);
+                        LUAU_ASSERT(unsigned(pc -cl->l.p->code) < unsigned(cl->l.p->sizecode));
+                        VM_NEXT();
+                    }
+                }
+
+                // no match: continue after the table
+                pc += 2 * count;
+                LUAU_ASSERT(unsigned(pc -cl->l.p->code) < unsigned(cl->l.p->sizecode));
+                VM_NEXT();
+            }
+
             VM_CASE(LOP_BREAK)
             {
                 LUAU_ASSERT(cl->l.p->debuginsn);
@@ -2734,6 +3040,9 @@ int luau_precall(lua_State *L, StkId func, int nresults) {
 
     Closure *ccl = clvalue(func);
 
+    if (!ccl->isC && ccl->l.p->lazy)
+        luau_loadproto(L, ccl->l.p);
+
     CallInfo *ci = incr_ci(L);
     ci->func = func;
     ci->base = func + 1;
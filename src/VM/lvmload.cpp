@@ -5,11 +5,13 @@
 #include "lstate.h"
 #include "ltable.h"
 #include "lfunc.h"
+#include "ldo.h"
 #include "lstring.h"
 #include "lgc.h"
 #include "lmem.h"
 #include "lbytecode.h"
 #include "lapi.h"
+#include "lzio.h"
 
 #include <string.h>
 
@@ -59,23 +61,58 @@ void luaV_getimport(lua_State *L, Table *env, TValue *k, uint32_t id, bool propa
         luaV_gettable(L, L->top - 1, &k[id2], L->top - 1);
 }
 
+struct LoadState {
+    lua_State *L;
+
+    const char *data;
+    size_t size;
+
+    TString **strings;  // strings decoded by luau_load
+    Table *stringtable; // strings kept by luau_loadlazy, see LazyChunk
+
+    Proto **protos;
+    Table *env;
+
+    bool lazy;    // imports are resolved without invoking metamethods, since lazy decoding can't call Lua code
+    bool inplace; // code is executed from data instead of being copied, which needs data to be aligned
+
+    ZIO *stream; // compressed bytecode is decoded from the stream instead of data; offsets still refer to the decoded bytecode
+};
+
+static void readBytes(const LoadState &s, void *buf, size_t n, size_t &offset) {
+    // empty arrays are allocated as NULL, which memcpy doesn't accept even for 0 bytes
+    if (n == 0)
+        return;
+
+    if (s.stream) {
+        size_t count = luaZ_read(s.stream, buf, n);
+
+        // malformed streams end early; the rest of the bytecode reads as zeroes
+        if (count < n)
+            memset(static_cast<char *>(buf) + count, 0, n - count);
+    } else {
+        memcpy(buf, s.data + offset, n);
+    }
+
+    offset += n;
+}
+
 template<typename T>
-static T read(const char *data, size_t size, size_t &offset) {
+static T read(const LoadState &s, size_t &offset) {
     T result;
-    memcpy(&result, data + offset, sizeof(T));
-    offset += sizeof(T);
+    readBytes(s, &result, sizeof(T), offset);
 
     return result;
 }
 
-static unsigned int readVarInt(const char *data, size_t size, size_t &offset) {
+static unsigned int readVarInt(const LoadState &s, size_t &offset) {
     unsigned int result = 0;
     unsigned int shift = 0;
 
     uint8_t byte;
 
     do {
-        byte = read<uint8_t>(data, size, offset);
+        byte = read<uint8_t>(s, offset);
         result |= (byte & 127) << shift;
         shift += 7;
     } while (byte & 128);
@@ -83,10 +120,13 @@ static unsigned int readVarInt(const char *data, size_t size, size_t &offset) {
     return result;
 }
 
-static TString *readString(TempBuffer<TString *> &strings, const char *data, size_t size, size_t &offset) {
-    unsigned int id = readVarInt(data, size, offset);
+static TString *readString(const LoadState &s, size_t &offset) {
+    unsigned int id = readVarInt(s, offset);
 
-    return id == 0 ? NULL : strings[id - 1];
+    if (id == 0)
+        return NULL;
+
+    return s.strings ? s.strings[id - 1] : tsvalue(&s.stringtable->array[id - 1]);
 }
 
 static void resolveImportSafe(lua_State *L, Table *env, TValue *k, uint32_t id) {
@@ -121,16 +161,465 @@ static void resolveImportSafe(lua_State *L, Table *env, TValue *k, uint32_t id)
     }
 }
 
-int luau_load(lua_State *L, const char *chunkname, const char *data, size_t size, int env) {
+// resolves an import chain with raw table lookups; the result is nil if the chain can't be resolved this way, in which case GETIMPORT
+// resolves it when the function runs
+static void resolveImportRaw(lua_State *L, Table *env, TValue *k, uint32_t id, TValue *result) {
+    int count = id >> 30;
+    int ids[3] = {int(id >> 20) & 1023, int(id >> 10) & 1023, int(id) & 1023};
+
+    setnilvalue(result);
+
+    if (!env->safeenv)
+        return;
+
+    Table *t = env;
+    const TValue *v = NULL;
+
+    for (int i = 0; i < count; ++i) {
+        if (!t)
+            return;
+
+        LUAU_ASSERT(ttisstring(&k[ids[i]]));
+        v = luaH_getstr(t, tsvalue(&k[ids[i]]));
+        t = ttistable(v) ? hvalue(v) : NULL;
+    }
+
+    if (v)
+        setobj(L, result, v);
+}
+
+// instructions are aligned to 4 bytes relative to the start of the bytecode
+static void alignCode(const LoadState &s, size_t &offset) {
+    if (s.stream) {
+        while (offset & 3)
+            read<uint8_t>(s, offset);
+    } else {
+        offset = (offset + 3) & ~size_t(3);
+    }
+}
+
+// the load* functions set the size of each array after allocating it, so that a memory error leaves a proto that luaF_freeproto and
+// discardProto can free
+static void loadCode(const LoadState &s, Proto *p, size_t &offset) {
+    lua_State *L = s.L;
+
+    int sizecode = readVarInt(s, offset);
+    alignCode(s, offset);
+
+    if (s.inplace) {
+        p->code = reinterpret_cast<Instruction *>(const_cast<char *>(s.data + offset));
+        p->codeinplace = 1;
+        offset += sizecode * sizeof(uint32_t);
+    } else {
+        p->code = luaM_newarray(L, sizecode, Instruction, p->memcat);
+        readBytes(s, p->code, sizecode * sizeof(Instruction), offset);
+    }
+
+    p->sizecode = sizecode;
+
+    int sizecache = readVarInt(s, offset);
+    p->cache = luaM_newarray(L, sizecache, uint8_t, p->memcat);
+    p->sizecache = sizecache;
+    readBytes(s, p->cache, p->sizecache, offset);
+}
+
+static void loadConstants(const LoadState &s, Proto *p, size_t &offset) {
+    lua_State *L = s.L;
+
+    int sizek = readVarInt(s, offset);
+    p->k = luaM_newarray(L, sizek, TValue, p->memcat);
+
+    // resolveImportSafe can trigger GC checks under HARDMEMTESTS, and lazily decoded protos are reachable while their constants are
+    // created; because p->k isn't fully formed at this point, we pre-fill it with nil to make subsequent setup safe
+    for (int j = 0; j < sizek; ++j)
+        setnilvalue(&p->k[j]);
+
+    p->sizek = sizek;
+
+    for (int j = 0; j < p->sizek; ++j) {
+        switch (read<uint8_t>(s, offset)) {
+            case LBC_CONSTANT_NIL:
+                setnilvalue(&p->k[j]);
+                break;
+
+            case LBC_CONSTANT_BOOLEAN: {
+                uint8_t v = read<uint8_t>(s, offset);
+                setbvalue(&p->k[j], v);
+                break;
+            }
+
+            case LBC_CONSTANT_NUMBER: {
+                double v = read<double>(s, offset);
+                setnvalue(&p->k[j], v);
+                break;
+            }
+
+            case LBC_CONSTANT_STRING: {
+                TString *v = readString(s, offset);
+                setsvalue2n(L, &p->k[j], v);
+                break;
+            }
+
+            case LBC_CONSTANT_IMPORT: {
+                uint32_t iid = read<uint32_t>(s, offset);
+                if (s.lazy) {
+                    resolveImportRaw(L, s.env, p->k, iid, &p->k[j]);
+                } else {
+                    resolveImportSafe(L, s.env, p->k, iid);
+                    setobj(L, &p->k[j], L->top - 1);
+                    L->top--;
+                }
+                break;
+            }
+
+            case LBC_CONSTANT_TABLE: {
+                int keys = readVarInt(s, offset);
+                Table *h = luaH_new(L, 0, keys);
+                for (int i = 0; i < keys; ++i) {
+                    int key = readVarInt(s, offset);
+                    TValue *val = luaH_set(L, h, &p->k[key]);
+                    setnvalue(val, 0.0);
+                }
+                sethvalue(L, &p->k[j], h);
+                break;
+            }
+
+            case LBC_CONSTANT_CLOSURE: {
+                uint32_t fid = readVarInt(s, offset);
+                Closure *cl = luaF_newLclosure(L, s.protos[fid]->nups, s.env, s.protos[fid]);
+                cl->preload = (cl->nupvalues > 0);
+                setclvalue(L, &p->k[j], cl);
+                break;
+            }
+
+            default:
+                LUAU_ASSERT(!"Unexpected constant kind");
+        }
+    }
+}
+
+static void loadChildren(const LoadState &s, Proto *p, size_t &offset) {
+    int sizep = readVarInt(s, offset);
+    p->p = luaM_newarray(s.L, sizep, Proto*, p->memcat);
+    p->sizep = sizep;
+    for (int j = 0; j < p->sizep; ++j) {
+        uint32_t fid = readVarInt(s, offset);
+        p->p[j] = s.protos[fid];
+    }
+}
+
+static void loadLineInfo(const LoadState &s, Proto *p, size_t &offset) {
+    uint8_t lineinfo = read<uint8_t>(s, offset);
+
+    if (lineinfo) {
+        p->linegaplog2 = read<uint8_t>(s, offset);
+
+        int intervals = ((p->sizecode - 1) >> p->linegaplog2) + 1;
+        int absoffset = (p->sizecode + 3) & ~3;
+
+        int sizelineinfo = absoffset + intervals * sizeof(int);
+        p->lineinfo = luaM_newarray(s.L, sizelineinfo, uint8_t, p->memcat);
+        p->sizelineinfo = sizelineinfo;
+        p->abslineinfo = (int *) (p->lineinfo + absoffset);
+
+        uint8_t lastoffset = 0;
+        for (int j = 0; j < p->sizecode; ++j) {
+            lastoffset += read<uint8_t>(s, offset);
+            p->lineinfo[j] = lastoffset;
+        }
+
+        int lastline = 0;
+        for (int j = 0; j < intervals; ++j) {
+            lastline += read<int32_t>(s, offset);
+            p->abslineinfo[j] = lastline;
+        }
+    }
+}
+
+static void loadDebugInfo(const LoadState &s, Proto *p, size_t &offset) {
+    uint8_t debuginfo = read<uint8_t>(s, offset);
+
+    if (debuginfo) {
+        int sizelocvars = readVarInt(s, offset);
+        p->locvars = luaM_newarray(s.L, sizelocvars, LocVar, p->memcat);
+        p->sizelocvars = sizelocvars;
+
+        for (int j = 0; j < p->sizelocvars; ++j) {
+            p->locvars[j].varname = readString(s, offset);
+            p->locvars[j].startpc = readVarInt(s, offset);
+            p->locvars[j].endpc = readVarInt(s, offset);
+            p->locvars[j].reg = read<uint8_t>(s, offset);
+        }
+
+        int sizeupvalues = readVarInt(s, offset);
+        p->upvalues = luaM_newarray(s.L, sizeupvalues, TString*, p->memcat);
+        p->sizeupvalues = sizeupvalues;
+
+        for (int j = 0; j < p->sizeupvalues; ++j) {
+            p->upvalues[j] = readString(s, offset);
+        }
+    }
+}
+
+// the skip* functions step over the parts of a proto that luau_loadlazy defers and return the number of bytes decoding them allocates
+static size_t skipCode(const LoadState &s, size_t &offset, int &sizecode) {
+    LUAU_ASSERT(!s.stream);
+
+    sizecode = readVarInt(s, offset);
+    alignCode(s, offset);
+    offset += sizecode * sizeof(uint32_t);
+
+    int sizecache = readVarInt(s, offset);
+    offset += sizecache;
+
+    return (s.inplace ? 0 : sizecode * sizeof(Instruction)) + sizecache;
+}
+
+static size_t skipConstants(const LoadState &s, size_t &offset) {
+    int sizek = readVarInt(s, offset);
+
+    for (int j = 0; j < sizek; ++j) {
+        switch (read<uint8_t>(s, offset)) {
+            case LBC_CONSTANT_NIL:
+                break;
+
+            case LBC_CONSTANT_BOOLEAN:
+                offset += sizeof(uint8_t);
+                break;
+
+            case LBC_CONSTANT_NUMBER:
+                offset += sizeof(double);
+                break;
+
+            case LBC_CONSTANT_STRING:
+            case LBC_CONSTANT_CLOSURE:
+                readVarInt(s, offset);
+                break;
+
+            case LBC_CONSTANT_IMPORT:
+                offset += sizeof(uint32_t);
+                break;
+
+            case LBC_CONSTANT_TABLE: {
+                int keys = readVarInt(s, offset);
+                for (int i = 0; i < keys; ++i)
+                    readVarInt(s, offset);
+                break;
+            }
+
+            default:
+                LUAU_ASSERT(!"Unexpected constant kind");
+        }
+    }
+
+    return sizek * sizeof(TValue);
+}
+
+static size_t skipLineInfo(const LoadState &s, int sizecode, size_t &offset) {
+    uint8_t lineinfo = read<uint8_t>(s, offset);
+
+    if (!lineinfo)
+        return 0;
+
+    int linegaplog2 = read<uint8_t>(s, offset);
+
+    int intervals = ((sizecode - 1) >> linegaplog2) + 1;
+    int absoffset = (sizecode + 3) & ~3;
+
+    offset += sizecode * sizeof(uint8_t) + intervals * sizeof(int32_t);
+
+    return absoffset + intervals * sizeof(int);
+}
+
+static size_t skipDebugInfo(const LoadState &s, size_t &offset) {
+    uint8_t debuginfo = read<uint8_t>(s, offset);
+
+    if (!debuginfo)
+        return 0;
+
+    int sizelocvars = readVarInt(s, offset);
+
+    for (int j = 0; j < sizelocvars; ++j) {
+        readVarInt(s, offset);
+        readVarInt(s, offset);
+        readVarInt(s, offset);
+        offset += sizeof(uint8_t);
+    }
+
+    int sizeupvalues = readVarInt(s, offset);
+
+    for (int j = 0; j < sizeupvalues; ++j)
+        readVarInt(s, offset);
+
+    return sizelocvars * sizeof(LocVar) + sizeupvalues * sizeof(TString*);
+}
+
+// children, line defined and debug name are decoded by luau_loadlazy
+static void skipProtoInfo(const LoadState &s, size_t &offset) {
+    int sizep = readVarInt(s, offset);
+    for (int j = 0; j < sizep; ++j)
+        readVarInt(s, offset);
+
+    readVarInt(s, offset); // linedefined
+    readVarInt(s, offset); // debugname
+}
+
+// FNV-1a of the image as passed to luau_load, see BytecodeBuilder::getImageHash
+static uint32_t hashImage(const char *data, size_t size) {
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ uint8_t(data[i])) * 16777619u;
+
+    return hash;
+}
+
+// code of lazily loaded chunks is executed in place when the image is suitably aligned, since it has to stay valid anyway
+static bool canExecuteInPlace(const char *data) {
+    return (uintptr_t(data) & (sizeof(Instruction) - 1)) == 0;
+}
+
+static LoadState getLazyState(lua_State *L, LazyChunk *chunk) {
+    LoadState s = {L, chunk->data, chunk->size, NULL, chunk->strings, chunk->protos, chunk->env, /* lazy= */ true,
+                   canExecuteInPlace(chunk->data), NULL};
+    return s;
+}
+
+static void releaseChunk(lua_State *L, LazyChunk *chunk) {
+    LUAU_ASSERT(chunk->pending > 0);
+
+    if (--chunk->pending == 0) {
+        luaM_freearray(L, chunk->protos, chunk->protocount, Proto*, 0);
+        luaM_freearray(L, chunk, 1, LazyChunk, 0);
+    }
+}
+
+static void decodeProto(lua_State *L, void *ud) {
+    Proto *p = static_cast<Proto *>(ud);
+
+    LoadState s = getLazyState(L, p->lazy);
+    size_t offset = p->lazyoffset;
+
+    loadCode(s, p, offset);
+    loadConstants(s, p, offset);
+    skipProtoInfo(s, offset);
+    loadLineInfo(s, p, offset);
+    loadDebugInfo(s, p, offset);
+}
+
+// frees what a failed decodeProto allocated; the proto stays pending, so the next call decodes it from scratch
+static void discardProto(lua_State *L, Proto *p) {
+    if (!p->codeinplace)
+        luaM_freearray(L, p->code, p->sizecode, Instruction, p->memcat);
+    luaM_freearray(L, p->cache, p->sizecache, uint8_t, p->memcat);
+    luaM_freearray(L, p->k, p->sizek, TValue, p->memcat);
+    if (p->lineinfo)
+        luaM_freearray(L, p->lineinfo, p->sizelineinfo, uint8_t, p->memcat);
+    luaM_freearray(L, p->locvars, p->sizelocvars, struct LocVar, p->memcat);
+    luaM_freearray(L, p->upvalues, p->sizeupvalues, TString*, p->memcat);
+
+    p->code = NULL;
+    p->sizecode = 0;
+    p->codeinplace = 0;
+    p->cache = NULL;
+    p->sizecache = 0;
+    p->k = NULL;
+    p->sizek = 0;
+    p->lineinfo = NULL;
+    p->abslineinfo = NULL;
+    p->sizelineinfo = 0;
+    p->linegaplog2 = 0;
+    p->locvars = NULL;
+    p->sizelocvars = 0;
+    p->upvalues = NULL;
+    p->sizeupvalues = 0;
+}
+
+void luau_loadproto(lua_State *L, Proto *p) {
+    LazyChunk *chunk = p->lazy;
+    LUAU_ASSERT(chunk);
+
+    // constants created so far aren't covered by write barriers yet, so they can't stay reachable from the proto after an error
+    if (int status = luaD_rawrunprotected(L, decodeProto, p)) {
+        discardProto(L, p);
+        luaD_throw(L, status);
+    }
+
+    // the proto may have been traversed by the GC already; the chunk kept the strings alive so far, but the chunk reference is dropped below
+    for (int j = 0; j < p->sizek; ++j)
+        luaC_barrier(L, p, &p->k[j]);
+
+    for (int j = 0; j < p->sizelocvars; ++j)
+        if (p->locvars[j].varname)
+            luaC_objbarrier(L, p, p->locvars[j].varname);
+
+    for (int j = 0; j < p->sizeupvalues; ++j)
+        if (p->upvalues[j])
+            luaC_objbarrier(L, p, p->upvalues[j]);
+
+    lua_LoadStats &stats = L->global->loadstats;
+    stats.pendingprotos--;
+    stats.pendingbytes -= (p->codeinplace ? 0 : p->sizecode * sizeof(Instruction)) + p->sizecache + p->sizek * sizeof(TValue) +
+                          p->sizelineinfo + p->sizelocvars * sizeof(LocVar) + p->sizeupvalues * sizeof(TString*);
+
+    if (p->codeinplace)
+        stats.inplacebytes += p->sizecode * sizeof(Instruction);
+
+    p->lazy = NULL;
+    p->lazyoffset = 0;
+
+    releaseChunk(L, chunk);
+}
+
+void luau_unloadproto(lua_State *L, Proto *p) {
+    LazyChunk *chunk = p->lazy;
+    LUAU_ASSERT(chunk);
+
+    LoadState s = getLazyState(L, chunk);
+    size_t offset = p->lazyoffset;
+
+    int sizecode = 0;
+    size_t bytes = skipCode(s, offset, sizecode);
+    bytes += skipConstants(s, offset);
+    skipProtoInfo(s, offset);
+    bytes += skipLineInfo(s, sizecode, offset);
+    bytes += skipDebugInfo(s, offset);
+
+    lua_LoadStats &stats = L->global->loadstats;
+    stats.pendingprotos--;
+    stats.pendingbytes -= bytes;
+
+    p->lazy = NULL;
+
+    releaseChunk(L, chunk);
+}
+
+static int load(lua_State *L, const char *chunkname, const char *data, size_t size, int env, bool lazy) {
+    // compressed bytecode is decoded while loading it, so lazy decoding and executing code in place aren't possible
+    ZIO stream;
+    bool compressed = luaZ_init(&stream, data, size);
+
+    if (compressed)
+        lazy = false;
+
+    TempBuffer<uint8_t> window(L, compressed ? stream.windowsize : 0);
+    stream.window = window.data;
+
+    LoadState s = {L, data, size, NULL, NULL, NULL, NULL, /* lazy= */ false, lazy && canExecuteInPlace(data), compressed ? &stream : NULL};
+
     size_t offset = 0;
 
-    uint8_t version = read<uint8_t>(data, size, offset);
+    uint8_t version = read<uint8_t>(s, offset);
 
     // 0 means the rest of the bytecode is the error message
     if (version == 0) {
+        size_t length = (compressed ? stream.rawsize : size) - offset;
+        TempBuffer<char> message(L, length);
+        readBytes(s, message.data, length, offset);
+
         char chunkid[LUA_IDSIZE];
         luaO_chunkid(chunkid, chunkname, LUA_IDSIZE);
-        lua_pushfstring(L, "%s%.*s", chunkid, int(size -offset), data + offset);
+        lua_pushfstring(L, "%s%.*s", chunkid, int(length), message.data);
         return 1;
     }
 
@@ -153,166 +642,138 @@ int luau_load(lua_State *L, const char *chunkname, const char *data, size_t size
     TString *source = luaS_new(L, chunkname);
 
     // string table
-    unsigned int stringCount = readVarInt(data, size, offset);
+    unsigned int stringCount = readVarInt(s, offset);
     TempBuffer<TString *> strings(L, stringCount);
 
     for (unsigned int i = 0; i < stringCount; ++i) {
-        unsigned int length = readVarInt(data, size, offset);
+        unsigned int length = readVarInt(s, offset);
+
+        if (compressed) {
+            TempBuffer<char> buffer(L, length);
+            readBytes(s, buffer.data, length, offset);
 
-        strings[i] = luaS_newlstr(L, data + offset, length);
-        offset += length;
+            strings[i] = luaS_newlstr(L, length ? buffer.data : "", length);
+        } else {
+            strings[i] = luaS_newlstr(L, data + offset, length);
+            offset += length;
+        }
     }
 
+    s.strings = strings.data;
+
+    // memory categories of the modules, mapped to the categories of the state by name; see # Memory categories in Bytecode.h
+    unsigned int categoryCount = version >= 4 ? readVarInt(s, offset) : 0;
+    TempBuffer<uint8_t> categories(L, categoryCount + 1);
+
+    categories[0] = 0;
+
+    for (unsigned int i = 0; i < categoryCount; ++i)
+        categories[i + 1] = luaM_getmemcat(L, readString(s, offset));
+
     // proto table
-    unsigned int protoCount = readVarInt(data, size, offset);
+    unsigned int protoCount = readVarInt(s, offset);
     TempBuffer<Proto *> protos(L, protoCount);
 
-    for (unsigned int i = 0; i < protoCount; ++i) {
-        Proto *p = luaF_newproto(L);
-        p->source = source;
+    s.protos = protos.data;
+    s.env = envt;
 
-        p->maxstacksize = read<uint8_t>(data, size, offset);
-        p->numparams = read<uint8_t>(data, size, offset);
-        p->nups = read<uint8_t>(data, size, offset);
-        p->is_vararg = read<uint8_t>(data, size, offset);
-
-        p->sizecode = readVarInt(data, size, offset);
-        p->code = luaM_newarray(L, p->sizecode, Instruction, p->memcat);
-        for (int j = 0; j < p->sizecode; ++j)
-            p->code[j] = read<uint32_t>(data, size, offset);
-
-        p->sizek = readVarInt(data, size, offset);
-        p->k = luaM_newarray(L, p->sizek, TValue, p->memcat);
-
-#ifdef HARDMEMTESTS
-        // this is redundant during normal runs, but resolveImportSafe can trigger GC checks under HARDMEMTESTS
-        // because p->k isn't fully formed at this point, we pre-fill it with nil to make subsequent setup safe
-        for (int j = 0; j < p->sizek; ++j)
-        {
-            setnilvalue(&p->k[j]);
-        }
-#endif
-
-        for (int j = 0; j < p->sizek; ++j) {
-            switch (read<uint8_t>(data, size, offset)) {
-                case LBC_CONSTANT_NIL:
-                    setnilvalue(&p->k[j]);
-                    break;
-
-                case LBC_CONSTANT_BOOLEAN: {
-                    uint8_t v = read<uint8_t>(data, size, offset);
-                    setbvalue(&p->k[j], v);
-                    break;
-                }
+    // lazily decoded protos keep the strings and protos of the chunk until they are decoded
+    LazyChunk *chunk = NULL;
 
-                case LBC_CONSTANT_NUMBER: {
-                    double v = read<double>(data, size, offset);
-                    setnvalue(&p->k[j], v);
-                    break;
-                }
+    if (lazy) {
+        chunk = luaM_newarray(L, 1, LazyChunk, 0);
+        chunk->data = data;
+        chunk->size = size;
+        chunk->strings = luaH_new(L, stringCount, 0);
+        chunk->env = envt;
+        chunk->protos = luaM_newarray(L, protoCount, Proto*, 0);
+        chunk->protocount = protoCount;
+        chunk->pending = 0;
 
-                case LBC_CONSTANT_STRING: {
-                    TString *v = readString(strings, data, size, offset);
-                    setsvalue2n(L, &p->k[j], v);
-                    break;
-                }
+        for (unsigned int i = 0; i < stringCount; ++i)
+            setsvalue(L, &chunk->strings->array[i], strings[i]);
+    }
 
-                case LBC_CONSTANT_IMPORT: {
-                    uint32_t iid = read<uint32_t>(data, size, offset);
-                    resolveImportSafe(L, envt, p->k, iid);
-                    setobj(L, &p->k[j], L->top - 1);
-                    L->top--;
-                    break;
-                }
+    lua_LoadStats &stats = L->global->loadstats;
 
-                case LBC_CONSTANT_TABLE: {
-                    int keys = readVarInt(data, size, offset);
-                    Table *h = luaH_new(L, 0, keys);
-                    for (int i = 0; i < keys; ++i) {
-                        int key = readVarInt(data, size, offset);
-                        TValue *val = luaH_set(L, h, &p->k[key]);
-                        setnvalue(val, 0.0);
-                    }
-                    sethvalue(L, &p->k[j], h);
-                    break;
-                }
+    bool stripped = false; // some function has no line info
 
-                case LBC_CONSTANT_CLOSURE: {
-                    uint32_t fid = readVarInt(data, size, offset);
-                    Closure *cl = luaF_newLclosure(L, protos[fid]->nups, envt, protos[fid]);
-                    cl->preload = (cl->nupvalues > 0);
-                    setclvalue(L, &p->k[j], cl);
-                    break;
-                }
+    for (unsigned int i = 0; i < protoCount; ++i) {
+        Proto *p = luaF_newproto(L);
+        p->source = source;
+        p->bytecodeid = int(i);
 
-                default:
-                    LUAU_ASSERT(!"Unexpected constant kind");
-            }
-        }
+        p->maxstacksize = read<uint8_t>(s, offset);
+        p->numparams = read<uint8_t>(s, offset);
+        p->nups = read<uint8_t>(s, offset);
+        p->is_vararg = read<uint8_t>(s, offset);
 
-        p->sizep = readVarInt(data, size, offset);
-        p->p = luaM_newarray(L, p->sizep, Proto*, p->memcat);
-        for (int j = 0; j < p->sizep; ++j) {
-            uint32_t fid = readVarInt(data, size, offset);
-            p->p[j] = protos[fid];
-        }
+        if (version >= 4)
+            p->modulememcat = categories[read<uint8_t>(s, offset)];
 
-        p->linedefined = readVarInt(data, size, offset);
-        p->debugname = readString(strings, data, size, offset);
+        stats.protos++;
 
-        uint8_t lineinfo = read<uint8_t>(data, size, offset);
+        if (lazy) {
+            p->lazy = chunk;
+            p->lazyoffset = uint32_t(offset);
 
-        if (lineinfo) {
-            p->linegaplog2 = read<uint8_t>(data, size, offset);
+            int sizecode = 0;
+            size_t bytes = skipCode(s, offset, sizecode);
+            bytes += skipConstants(s, offset);
 
-            int intervals = ((p->sizecode - 1) >> p->linegaplog2) + 1;
-            int absoffset = (p->sizecode + 3) & ~3;
+            loadChildren(s, p, offset);
 
-            p->sizelineinfo = absoffset + intervals * sizeof(int);
-            p->lineinfo = luaM_newarray(L, p->sizelineinfo, uint8_t, p->memcat);
-            p->abslineinfo = (int *) (p->lineinfo + absoffset);
+            p->linedefined = readVarInt(s, offset);
+            p->debugname = readString(s, offset);
 
-            uint8_t lastoffset = 0;
-            for (int j = 0; j < p->sizecode; ++j) {
-                lastoffset += read<uint8_t>(data, size, offset);
-                p->lineinfo[j] = lastoffset;
-            }
+            size_t lineinfo = skipLineInfo(s, sizecode, offset);
+            bytes += lineinfo;
+            bytes += skipDebugInfo(s, offset);
 
-            int lastline = 0;
-            for (int j = 0; j < intervals; ++j) {
-                lastline += read<int32_t>(data, size, offset);
-                p->abslineinfo[j] = lastline;
-            }
-        }
+            stripped |= lineinfo == 0;
 
-        uint8_t debuginfo = read<uint8_t>(data, size, offset);
+            chunk->pending++;
+            chunk->protos[i] = p;
 
-        if (debuginfo) {
-            p->sizelocvars = readVarInt(data, size, offset);
-            p->locvars = luaM_newarray(L, p->sizelocvars, LocVar, p->memcat);
+            stats.lazyprotos++;
+            stats.pendingprotos++;
+            stats.pendingbytes += bytes;
+        } else {
+            loadCode(s, p, offset);
+            loadConstants(s, p, offset);
+            loadChildren(s, p, offset);
 
-            for (int j = 0; j < p->sizelocvars; ++j) {
-                p->locvars[j].varname = readString(strings, data, size, offset);
-                p->locvars[j].startpc = readVarInt(data, size, offset);
-                p->locvars[j].endpc = readVarInt(data, size, offset);
-                p->locvars[j].reg = read<uint8_t>(data, size, offset);
-            }
+            p->linedefined = readVarInt(s, offset);
+            p->debugname = readString(s, offset);
 
-            p->sizeupvalues = readVarInt(data, size, offset);
-            p->upvalues = luaM_newarray(L, p->sizeupvalues, TString*, p->memcat);
+            loadLineInfo(s, p, offset);
+            loadDebugInfo(s, p, offset);
 
-            for (int j = 0; j < p->sizeupvalues; ++j) {
-                p->upvalues[j] = readString(strings, data, size, offset);
-            }
+            stripped |= p->lineinfo == NULL;
         }
 
         protos[i] = p;
     }
 
+    // errors in functions without line info are reported relative to the image, see # Debug info sidecar in Bytecode.h; hashing
+    // the whole image is skipped when there are no such functions
+    if (stripped) {
+        uint32_t hash = hashImage(data, size);
+
+        for (unsigned int i = 0; i < protoCount; ++i)
+            protos[i]->bytecodehash = hash;
+    }
+
     // "main" proto is pushed to Lua stack
-    uint32_t mainid = readVarInt(data, size, offset);
+    uint32_t mainid = readVarInt(s, offset);
     Proto *main = protos[mainid];
 
+    // the chunk is only referenced by its protos; an empty chunk is never referenced
+    if (chunk && chunk->pending == 0) {
+        chunk->pending = 1;
+        releaseChunk(L, chunk);
+    }
+
     luaC_checkthreadsleep(L);
 
     Closure *cl = luaF_newLclosure(L, 0, envt, main);
@@ -323,3 +784,15 @@ int luau_load(lua_State *L, const char *chunkname, const char *data, size_t size
 
     return 0;
 }
+
+int luau_load(lua_State *L, const char *chunkname, const char *data, size_t size, int env) {
+    return load(L, chunkname, data, size, env, /* lazy= */ false);
+}
+
+int luau_loadlazy(lua_State *L, const char *chunkname, const char *data, size_t size, int env) {
+    return load(L, chunkname, data, size, env, /* lazy= */ true);
+}
+
+void lua_getloadstats(lua_State *L, lua_LoadStats *stats) {
+    *stats = L->global->loadstats;
+}
@@ -0,0 +1,136 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#include "lwatchdog.h"
+
+#include "ldebug.h"
+#include "ldo.h"
+
+/*
+ * Execution budgets
+ *
+ * A run is an outermost lua_pcall or lua_resume on the VM; nested resumes of coroutines from Lua count against the budget
+ * of the run they are part of. The safepoint quota is counted down in the interrupt callback, which the interpreter calls
+ * at every loop back edge and call. The deadline is never checked by the interpreter: lua_watchdogtick compares the clock
+ * against it from a timer task and sets the `expired' flag, so the only cost on the hot path is a flag load. The flag holds
+ * the number of the run that the tick saw, so a tick that races with the end of one run and the start of the next can't
+ * expire the next run with the deadline of the previous one.
+ *
+ * On overrun the thread yields if it's a coroutine that can yield; the run then ends and the next resume starts with a fresh
+ * budget. Otherwise an error is raised; since the budget stays exhausted until the run ends, the error can't be swallowed
+ * by a pcall inside the script.
+ */
+
+static double runusage(WatchdogState &w) {
+    double usage = 0;
+
+    if (w.safepoints > 0)
+        usage = double(w.safepoints - w.remaining) / double(w.safepoints);
+
+    if (w.timeout > 0) {
+        double elapsed = (lua_clock() - w.starttime) / w.timeout;
+        if (elapsed > usage)
+            usage = elapsed;
+    }
+
+    return usage;
+}
+
+static void budgetinterrupt(lua_State *L, int gc) {
+    WatchdogState &w = L->global->watchdog;
+
+    if (w.chained)
+        w.chained(L, gc);
+
+    // GC steps can't be preempted
+    if (gc >= 0 || w.depth == 0)
+        return;
+
+    bool exhausted = w.safepoints > 0 && --w.remaining < 0;
+
+    bool expired = w.expired.load(std::memory_order_relaxed) == w.run.load(std::memory_order_relaxed);
+
+    if (LUAU_LIKELY(!exhausted && !expired))
+        return;
+
+    if (!w.overrun) {
+        w.overrun = true;
+        w.stats.overruns++;
+    }
+
+    if (lua_isyieldable(L))
+        lua_yield(L, 0);
+    else
+        luaG_runerror(L, "script exceeded its execution budget");
+}
+
+void luaW_beginrun(lua_State *L) {
+    WatchdogState &w = L->global->watchdog;
+
+    if (w.depth++ != 0 || !luaW_enabled(L->global))
+        return;
+
+    w.remaining = w.safepoints;
+    w.starttime = lua_clock();
+    w.overrun = false;
+
+    // ticks that saw an earlier run can only store the number of that run into `expired'
+    unsigned run = w.run.load(std::memory_order_relaxed) + 1;
+
+    w.expired.store(run - 1, std::memory_order_relaxed);
+    w.deadline.store(w.starttime + w.timeout, std::memory_order_relaxed);
+    w.run.store(run, std::memory_order_release);
+    w.active.store(true, std::memory_order_release);
+}
+
+void luaW_endrun(lua_State *L) {
+    WatchdogState &w = L->global->watchdog;
+
+    if (--w.depth != 0 || !luaW_enabled(L->global))
+        return;
+
+    w.active.store(false, std::memory_order_relaxed);
+
+    double usage = runusage(w);
+
+    w.stats.runs++;
+    w.stats.lastusage = usage;
+    if (usage > w.stats.maxusage)
+        w.stats.maxusage = usage;
+}
+
+void lua_setbudget(lua_State *L, int safepoints, double timeout) {
+    global_State *g = L->global;
+    WatchdogState &w = g->watchdog;
+
+    api_check(L, w.depth == 0);
+
+    bool wasenabled = luaW_enabled(g);
+
+    w.safepoints = safepoints;
+    w.timeout = timeout;
+
+    if (luaW_enabled(g) && !wasenabled) {
+        w.chained = g->cb.interrupt;
+        g->cb.interrupt = budgetinterrupt;
+    } else if (!luaW_enabled(g) && wasenabled) {
+        g->cb.interrupt = w.chained;
+        w.chained = NULL;
+    }
+}
+
+void lua_watchdogtick(lua_State *L) {
+    WatchdogState &w = L->global->watchdog;
+
+    if (w.timeout <= 0 || !w.active.load(std::memory_order_acquire))
+        return;
+
+    // the deadline belongs to this run or a later one; in the latter case this run has already ended and expiring it has no effect
+    unsigned run = w.run.load(std::memory_order_acquire);
+
+    if (lua_clock() > w.deadline.load(std::memory_order_relaxed))
+        w.expired.store(run, std::memory_order_relaxed);
+}
+
+void lua_getbudgetstats(lua_State *L, lua_BudgetStats *stats) {
+    *stats = L->global->watchdog.stats;
+}
@@ -0,0 +1,11 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#pragma once
+
+#include "lstate.h"
+
+#define luaW_enabled(g) ((g)->watchdog.safepoints != 0 || (g)->watchdog.timeout != 0)
+
+LUAI_FUNC void luaW_beginrun(lua_State *L);
+
+LUAI_FUNC void luaW_endrun(lua_State *L);
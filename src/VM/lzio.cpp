@@ -0,0 +1,141 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#include "lzio.h"
+
+#include "lbytecode.h"
+
+/*
+ * Compressed bytecode
+ *
+ * The payload is a sequence of LZ4 sequences: a token with the literal count in the high nibble and the match length minus 4 in the
+ * low nibble, extra literal count bytes if the nibble is 15, the literals, a 16-bit little endian match offset and extra match length
+ * bytes if the nibble is 15. The last sequence has no match. Since the output is consumed by the loader as it's decoded, matches are
+ * copied a byte at a time through the window, which also handles matches that overlap their own output.
+ */
+
+static bool readbyte(ZIO *z, uint8_t &result) {
+    if (z->srcpos >= z->srcsize)
+        return false;
+
+    result = z->src[z->srcpos++];
+    return true;
+}
+
+static bool readlength(ZIO *z, size_t &length) {
+    if (length != 15)
+        return true;
+
+    uint8_t byte;
+
+    do {
+        if (!readbyte(z, byte))
+            return false;
+
+        length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+static bool nextsequence(ZIO *z) {
+    if (z->pendingmatch) {
+        uint8_t lo, hi;
+        if (!readbyte(z, lo) || !readbyte(z, hi))
+            return false;
+
+        size_t offset = lo | (hi << 8);
+
+        if (offset == 0 || offset > z->produced || offset > z->windowsize)
+            return false;
+
+        size_t length = z->token & 15;
+        if (!readlength(z, length))
+            return false;
+
+        z->pendingmatch = false;
+        z->match = length + 4;
+        z->matchoffset = offset;
+    } else {
+        if (!readbyte(z, z->token))
+            return false;
+
+        size_t length = z->token >> 4;
+        if (!readlength(z, length))
+            return false;
+
+        z->pendingmatch = true;
+        z->literals = length;
+    }
+
+    return true;
+}
+
+bool luaZ_init(ZIO *z, const char *data, size_t size) {
+    const uint8_t *src = reinterpret_cast<const uint8_t *>(data);
+
+    if (size < 3 || src[0] != LBC_COMPRESSED || src[1] < LBC_COMPRESSED_WINDOWLOG_MIN || src[1] > LBC_COMPRESSED_WINDOWLOG_MAX)
+        return false;
+
+    z->src = src;
+    z->srcsize = size;
+    z->srcpos = 2;
+
+    z->window = NULL;
+    z->windowsize = size_t(1) << src[1];
+
+    // varint, see BytecodeBuilder::writeVarInt
+    z->rawsize = 0;
+
+    uint8_t byte;
+    unsigned shift = 0;
+
+    do {
+        if (shift >= 32 || !readbyte(z, byte))
+            return false;
+
+        z->rawsize |= size_t(byte & 127) << shift;
+        shift += 7;
+    } while (byte & 128);
+
+    z->produced = 0;
+    z->token = 0;
+    z->pendingmatch = false;
+    z->literals = 0;
+    z->match = 0;
+    z->matchoffset = 0;
+
+    return true;
+}
+
+size_t luaZ_read(ZIO *z, void *buf, size_t n) {
+    LUAU_ASSERT(z->window);
+
+    uint8_t *out = static_cast<uint8_t *>(buf);
+    size_t mask = z->windowsize - 1;
+    size_t count = 0;
+
+    while (count < n && z->produced < z->rawsize) {
+        uint8_t byte;
+
+        if (z->literals > 0) {
+            if (!readbyte(z, byte))
+                break;
+
+            z->literals--;
+        } else if (z->match > 0) {
+            byte = z->window[(z->produced - z->matchoffset) & mask];
+            z->match--;
+        } else if (nextsequence(z)) {
+            continue;
+        } else {
+            break;
+        }
+
+        z->window[z->produced & mask] = byte;
+        z->produced++;
+
+        out[count++] = byte;
+    }
+
+    return count;
+}
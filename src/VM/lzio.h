@@ -0,0 +1,35 @@
+// This file is part of the Luau programming language and is licensed under MIT License; see LICENSE.txt for details
+// This code is based on Lua 5.x implementation licensed under MIT License; see lua_LICENSE.txt for details
+#pragma once
+
+#include "lcommon.h"
+
+#include <stddef.h>
+
+/*
+** Streaming decoder of compressed bytecode containers (see # Compressed bytecode in Bytecode.h)
+** Only the last windowsize bytes of the output are kept in window, which is allocated by the caller
+*/
+typedef struct ZIO {
+    const uint8_t *src;
+    size_t srcsize;
+    size_t srcpos;
+
+    uint8_t *window;
+    size_t windowsize; /* power of two */
+
+    size_t rawsize;  /* size of the decoded bytecode */
+    size_t produced; /* number of bytes decoded so far */
+
+    uint8_t token;      /* token of the current sequence */
+    bool pendingmatch;  /* the literals of the current sequence are followed by a match that hasn't been decoded yet */
+    size_t literals;    /* literal bytes left in the current sequence */
+    size_t match;       /* match bytes left in the current sequence */
+    size_t matchoffset; /* distance to the source of the match */
+} ZIO;
+
+/* parses the container header; returns false if data doesn't start with one */
+LUAI_FUNC bool luaZ_init(ZIO *z, const char *data, size_t size);
+
+/* decodes the next n bytes into buf; returns the number of bytes decoded, which is less than n at the end of malformed data */
+LUAI_FUNC size_t luaZ_read(ZIO *z, void *buf, size_t n);
@@ -4,8 +4,188 @@
 #include "luaconf.h"
 #include "serene_bytecode.h"
 
+/*
+
+    Subsystems
+
+    Every subsystem runs the script bundle in its own VM, on its own task and with its own memory cap,
+    so a garbage collection or a runaway loop in one subsystem can't stall the others.
+
+    The main chunk receives the subsystem name as its argument. Subsystems exchange plain values
+    through the `channels` global: channels.<name>:send(value) and channels.<name>:receive()
+    talk to the subsystem <name> over a pair of lock-free channels.
+
+    A subsystem can be given an execution budget per lua_pcall/lua_resume (see lua_setbudget),
+    so that an accidental busy loop yields or errors instead of freezing the robot. The watchdog
+    task only checks the deadlines; the interpreter reads a flag that the watchdog sets. The task
+    is only started when some subsystem has a time budget.
+
+*/
+
+struct Subsystem {
+    const char *name;
+    size_t memoryLimit; // in bytes, 0 if unlimited
+    uint32_t priority;
+
+    int safepointBudget; // 0 if unlimited
+    double timeBudget;   // in seconds, 0 if unlimited
+
+    // minor collections only visit what the control loop allocated since the last one, instead of the whole heap;
+    // opt-in per subsystem until generational mode has run on the robot
+    bool generationalGC;
+
+    // with a loop period the collector runs in memory.gctick() at the end of each iteration instead of in the allocations;
+    // only set this for subsystems whose scripts call memory.gctick(), scripts can also opt in with memory.gcpace(period, budget)
+    double loopPeriod; // in seconds, 0 if the collector isn't paced
+    double gcBudget;   // in seconds, per tick
+
+    size_t memoryUsed;
+    lua_State *L;
+};
+
+static Subsystem subsystems[] = {
+        // main runs the whole control loop from a single call, so it can't have a per-run budget
+        {"main", 0, TASK_PRIORITY_DEFAULT, 0, 0, false, 0, 0},
+};
+
+const size_t SUBSYSTEM_COUNT = sizeof(subsystems) / sizeof(subsystems[0]);
+const size_t CHANNEL_CAPACITY = 4 * 1024;
+
+static luaL_Channel *channels[SUBSYSTEM_COUNT][SUBSYSTEM_COUNT]; // channels[from][to]
+
+// main subsystem VM
 lua_State *L;
 
+static void *subsystemAlloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+    Subsystem *subsystem = static_cast<Subsystem *>(ud);
+
+    if (nsize == 0) {
+        free(ptr);
+        subsystem->memoryUsed -= osize;
+        return NULL;
+    }
+
+    // returning NULL makes the VM raise a memory error in the subsystem that went over its cap
+    if (subsystem->memoryLimit && nsize > osize && subsystem->memoryUsed + (nsize - osize) > subsystem->memoryLimit)
+        return NULL;
+
+    void *result = realloc(ptr, nsize);
+
+    if (result)
+        subsystem->memoryUsed = subsystem->memoryUsed - osize + nsize;
+
+    return result;
+}
+
+static void watchdog(void *) {
+    while (true) {
+        for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i)
+            lua_watchdogtick(subsystems[i].L);
+
+        pros::delay(1);
+    }
+}
+
+static void runSubsystem(void *param) {
+    Subsystem *subsystem = static_cast<Subsystem *>(param);
+    lua_State *T = subsystem->L;
+
+    // the bundle lives in flash, so functions are only decoded into the heap when the subsystem first calls them
+    // note: compressed bundles (build.compress in Serene.TOML) are decoded up front instead, trading heap for upload size
+    if (luau_loadlazy(T, subsystem->name, BYTECODE, BYTECODE_SIZE, 0) != 0) {
+        printf("Failed to load %s: %s\n", subsystem->name, lua_tostring(T, -1));
+        return;
+    }
+
+    lua_pushstring(T, subsystem->name);
+
+    if (lua_pcall(T, 1, 0, 0) != 0)
+        printf("Subsystem %s stopped: %s\n", subsystem->name, lua_tostring(T, -1));
+
+    lua_BudgetStats stats;
+    lua_getbudgetstats(T, &stats);
+
+    if (stats.runs)
+        printf("Subsystem %s budget: %u runs, %u overruns, peak usage %.0f%%\n", subsystem->name, stats.runs, stats.overruns,
+               stats.maxusage * 100);
+
+    lua_LoadStats load;
+    lua_getloadstats(T, &load);
+
+    printf("Subsystem %s never called %u of %u functions, saving %u bytes\n", subsystem->name, load.pendingprotos, load.protos,
+           unsigned(load.pendingbytes));
+    printf("Subsystem %s executes %u bytes of code in place\n", subsystem->name, unsigned(load.inplacebytes));
+
+    // the step times show whether LUA_GCSETSTEPSIZE/LUA_GCSETSTEPMUL keep the collector out of the loop timing; the heap
+    // size at the end of marking (in % of the goal) shows how well the trigger works for LUA_GCSETGOAL
+    lua_GCMetrics gc;
+    lua_gcmetrics(T, &gc);
+
+    const char *phases[LUA_GCPHASE_COUNT] = {"mark", "atomic", "sweep", "minor"};
+
+    for (int phase = 0; phase < LUA_GCPHASE_COUNT; ++phase)
+        if (gc.phases[phase].count)
+            printf("Subsystem %s GC %s: %u steps, p99 %.3f ms, max %.3f ms\n", subsystem->name, phases[phase],
+                   gc.phases[phase].count, gc.phases[phase].p99 * 1000, gc.phases[phase].max * 1000);
+
+    if (gc.heapgoal.count)
+        printf("Subsystem %s GC: %u cycles, heap at %.0f%% of the goal (p50), %.0f%% (max)\n", subsystem->name, gc.cycles,
+               gc.heapgoal.p50, gc.heapgoal.max);
+
+    lua_GCPaceStats pace;
+    lua_getgcpacestats(T, &pace);
+
+    if (pace.ticks)
+        printf("Subsystem %s GC pacing: %u ticks, %u deferred, %u overruns, %u steps in allocations, max %.3f ms\n", subsystem->name,
+               pace.ticks, pace.deferred, pace.overruns, pace.fallbacks, pace.maxtime * 1000);
+
+    // new coroutines get the stacks of collected ones; many dropped stacks mean that more coroutines die per collection than
+    // the pool keeps, see memory.threadpool()
+    lua_ThreadPoolStats threads;
+    lua_getthreadpoolstats(T, &threads);
+
+    if (threads.reused)
+        printf("Subsystem %s coroutines: %u new stacks, %u reused, %u dropped\n", subsystem->name, threads.created, threads.reused,
+               threads.dropped);
+
+    // modules get their own memory categories, so a module that keeps growing stands out; the memory library samples them during a run
+    // and memory.snapshot() prints heap snapshots to the terminal, which Serene.HeapDiff can compare to find what retains the growth
+    for (int category = 0; category < LUA_MEMORY_CATEGORIES; ++category) {
+        lua_MemCatStats memory;
+        lua_getmemcatstats(T, category, &memory);
+
+        if (memory.name)
+            printf("Subsystem %s module %s: %u bytes live, peak %u bytes\n", subsystem->name, memory.name, unsigned(memory.bytes),
+                   unsigned(memory.peakbytes));
+    }
+}
+
+/*
+
+    Replay recording
+
+    Native bindings pass sensor and clock reads through lua_replaynumber/lua_replayboolean;
+    when an SD card is present these are logged so that the run can be reproduced on the host
+    with Serene.Replay. The log is drained by a low priority task to keep SD writes out of the control loop.
+
+*/
+
+static uint8_t replayBuffer[16 * 1024];
+static FILE *replayFile = nullptr;
+
+static void writeReplay(void *context, const void *data, size_t size) {
+    fwrite(data, 1, size, static_cast<FILE *>(context));
+}
+
+static void replayWriter(void *) {
+    while (true) {
+        if (lua_replaydrain(L, writeReplay, replayFile))
+            fflush(replayFile);
+
+        pros::delay(100);
+    }
+}
+
 void initialize() {
 
     printf("Initializing...\n");
@@ -13,23 +193,66 @@ void initialize() {
 
     /*
     
-        Create our lua state and sandbox it.
+        Create a lua state per subsystem and connect them with channels.
     
     */
 
-    L = luaL_newstate();
-    luaL_openlibs(L);
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        subsystems[i].L = lua_newstate(subsystemAlloc, &subsystems[i]);
+        luaL_openlibs(subsystems[i].L);
+        lua_setbudget(subsystems[i].L, subsystems[i].safepointBudget, subsystems[i].timeBudget);
+
+        if (subsystems[i].generationalGC)
+            lua_gc(subsystems[i].L, LUA_GCGEN, 0);
+
+        if (subsystems[i].loopPeriod > 0)
+            lua_gcpace(subsystems[i].L, subsystems[i].loopPeriod, subsystems[i].gcBudget);
+    }
+
+    for (size_t from = 0; from < SUBSYSTEM_COUNT; ++from)
+        for (size_t to = 0; to < SUBSYSTEM_COUNT; ++to)
+            if (from != to)
+                channels[from][to] = luaL_newchannel(CHANNEL_CAPACITY);
+
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        lua_State *T = subsystems[i].L;
+
+        lua_newtable(T);
 
-    int result = luau_load(L, "MainFile", BYTECODE, BYTECODE_SIZE, 0);
+        for (size_t other = 0; other < SUBSYSTEM_COUNT; ++other) {
+            if (other == i)
+                continue;
 
-    if (result == 0) {
-        lua_call(L, 0, 0);
-        printf("Ran Lua Code...\n");
-    } else {
-        printf("Failed to load...\n");
+            luaL_pushchannel(T, channels[i][other], channels[other][i]);
+            lua_setfield(T, -2, subsystems[other].name);
+        }
+
+        lua_setglobal(T, "channels");
+    }
+
+    L = subsystems[0].L;
+
+    replayFile = fopen("/usd/serene.replay", "wb");
+
+    if (replayFile) {
+        lua_replayrecord(L, replayBuffer, sizeof(replayBuffer));
+        pros::Task(replayWriter, nullptr, TASK_PRIORITY_MIN, TASK_STACK_DEPTH_DEFAULT, "Replay");
     }
 
-    printf("Ran Initialization Code\n");
+    // safepoint quotas are counted by the interpreter; only time budgets need the watchdog to compare the clock to their deadlines
+    bool timeBudgets = false;
+
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i)
+        if (subsystems[i].timeBudget > 0)
+            timeBudgets = true;
+
+    if (timeBudgets)
+        pros::Task(watchdog, nullptr, TASK_PRIORITY_MAX - 1, TASK_STACK_DEPTH_MIN, "Watchdog");
+
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i)
+        pros::Task(runSubsystem, &subsystems[i], subsystems[i].priority, TASK_STACK_DEPTH_DEFAULT, subsystems[i].name);
+
+    printf("Started %d subsystems\n", int(SUBSYSTEM_COUNT));
 }
 
 /**
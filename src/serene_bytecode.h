@@ -4,13 +4,14 @@
 
 #include "main.h"
 
-const size_t BYTECODE_SIZE = 81;
-const char BYTECODE[] = {
+const size_t BYTECODE_SIZE = 84;
+// aligned so that the runtime can execute the code in place
+alignas(4) const char BYTECODE[] = {
 
-        0x02, 0x02, 0x05, 0x70, 0x72, 0x69, 0x6e, 0x74, 0x0f, 0x43, 0x6f, 0x6c, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x65,
-        0x20, 0x67, 0x72, 0x65, 0x61, 0x74, 0x01, 0x02, 0x00, 0x00, 0x01, 0x06, 0x41, 0x00, 0x00, 0x00, 0x0c, 0x00,
-        0x01, 0x00, 0x00, 0x00, 0x00, 0x40, 0x05, 0x01, 0x02, 0x00, 0x15, 0x00, 0x02, 0x01, 0x16, 0x00, 0x01, 0x00,
-        0x03, 0x03, 0x01, 0x04, 0x00, 0x00, 0x00, 0x40, 0x03, 0x02, 0x00, 0x01, 0x00, 0x01, 0x18, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x02, 0x05, 0x70, 0x72, 0x69, 0x6e, 0x74, 0x0f, 0x43, 0x6f, 0x6c, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x65,
+        0x20, 0x67, 0x72, 0x65, 0x61, 0x74, 0x01, 0x02, 0x00, 0x00, 0x01, 0x06, 0x00, 0x00, 0x41, 0x00, 0x00, 0x00,
+        0x0c, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x40, 0x05, 0x01, 0x02, 0x00, 0x15, 0x00, 0x02, 0x01, 0x16, 0x00,
+        0x01, 0x00, 0x00, 0x03, 0x03, 0x01, 0x04, 0x00, 0x00, 0x00, 0x40, 0x03, 0x02, 0x00, 0x01, 0x00, 0x01, 0x18,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
 };
 #endif
\ No newline at end of file